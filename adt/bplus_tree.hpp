@@ -0,0 +1,766 @@
+/**
+ * @file bplus_tree.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-04
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines the B+ tree and its two faces, BPlusTreeMap and
+ * BPlusTreeSet.
+ *
+ * Every node takes about NodeBytes bytes: 256 by default, four cache lines,
+ * or a page with NodeBytes = 4096. Inner nodes hold only separator keys and
+ * child pointers, so many keys fit in a node and the tree stays shallow.
+ * Elements live in the leaves, which are linked in key order: a range scan
+ * descends once and then walks the leaves.
+ *
+ * Within a node, integer keys under std::less are searched without
+ * branches. Unused key slots are padded with the largest key, so a search
+ * can always scan a whole fixed-size window. It halves the node down to 16
+ * keys with conditional moves, then counts the smaller keys in the window,
+ * a loop the compiler vectorizes. Other keys use std::lower_bound with
+ * Compare.
+ *
+ *   BPlusTreeMap<uint64_t, double> map;
+ *   map.insert(7, 0.5);
+ *   map.for_range(0, 100, [](const uint64_t& key, double& val) { ... });
+ *
+ * bulk_load() builds a tree from sorted, unique elements in O(n), with
+ * full leaves. Keys and values must be default-constructible and
+ * move-assignable. Nodes always hold at least half their capacity, except
+ * the root. Inserting or erasing may move elements between nodes, so
+ * pointers returned by find() are only valid until the next modification.
+ */
+
+#ifndef BPLUS_TREE_HPP_
+#define BPLUS_TREE_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "adt/linear_list.hpp"
+
+namespace BPlusTreeDetail {
+// the values of a leaf; a set has none
+template <class Value, size_t N>
+struct Values {
+  Value values_[N];
+};
+
+template <size_t N>
+struct Values<void, N> {};
+
+template <class Value>
+constexpr size_t value_size() {
+  if constexpr (std::is_void_v<Value>)
+    return 0;
+  else
+    return sizeof(Value);
+}
+
+// the most elements that fit a leaf of NodeBytes, at least 4
+template <class Key, class Value, size_t NodeBytes>
+constexpr size_t leaf_capacity() {
+  // count, leaf flag and the two sibling links
+  const size_t header = 8 + 2 * sizeof(void*);
+  const size_t per = sizeof(Key) + value_size<Value>();
+  return NodeBytes > header + 4 * per ? (NodeBytes - header) / per : 4;
+}
+
+// the most separators that fit an inner node of NodeBytes, at least 4
+template <class Key, size_t NodeBytes>
+constexpr size_t inner_capacity() {
+  const size_t header = 8 + sizeof(void*);
+  const size_t per = sizeof(Key) + sizeof(void*);
+  return NodeBytes > header + 4 * per ? (NodeBytes - header) / per : 4;
+}
+
+// keys searched by the branchless padded search
+template <class Key, class Compare>
+constexpr bool PADDED = std::is_integral_v<Key> &&
+                        (std::is_same_v<Compare, std::less<Key>> ||
+                         std::is_same_v<Compare, std::less<>>);
+
+// the window the padded search scans linearly
+const static size_t WINDOW = 16;
+};  // namespace BPlusTreeDetail
+
+template <class Key, class Value, class Compare = std::less<Key>,
+          size_t NodeBytes = 256>
+class BPlusTree {
+  // definitions
+ private:
+  static constexpr bool IS_SET = std::is_void_v<Value>;
+  static constexpr bool PADDED = BPlusTreeDetail::PADDED<Key, Compare>;
+  static constexpr size_t LEAF =
+      BPlusTreeDetail::leaf_capacity<Key, Value, NodeBytes>();
+  static constexpr size_t INNER =
+      BPlusTreeDetail::inner_capacity<Key, NodeBytes>();
+  static constexpr size_t MIN_LEAF = LEAF / 2;
+  // a split leaves INNER / 2 and (INNER - 1) / 2 separators
+  static constexpr size_t MIN_INNER = (INNER - 1) / 2;
+
+  struct Node {
+    uint32_t count_;
+    bool leaf_;
+  };
+
+  struct alignas(64) Leaf : Node, BPlusTreeDetail::Values<Value, LEAF> {
+    Leaf* prev_ = nullptr;
+    Leaf* next_ = nullptr;
+    Key keys_[LEAF];
+
+    Leaf() : Node{0, true} {
+      if constexpr (PADDED) std::fill(keys_, keys_ + LEAF, pad());
+    }
+  };
+
+  // count_ separators and count_ + 1 children; child i holds the keys in
+  // [keys_[i - 1], keys_[i])
+  struct alignas(64) Inner : Node {
+    Key keys_[INNER];
+    Node* children_[INNER + 1];
+
+    Inner() : Node{0, false} {
+      if constexpr (PADDED) std::fill(keys_, keys_ + INNER, pad());
+    }
+  };
+
+  // the right half of a node that split, and the first key under it
+  struct Split {
+    Node* node_ = nullptr;
+    Key key_;
+  };
+
+ public:
+  // what bulk_load() takes: keys, or (key, value) pairs
+  using element_type =
+      std::conditional_t<IS_SET, Key,
+                         std::pair<Key, std::conditional_t<IS_SET, int,
+                                                           Value>>>;
+
+  // constructors & destructor
+ public:
+  BPlusTree() = default;
+
+  explicit BPlusTree(Compare less) : less_(std::move(less)) {}
+
+  BPlusTree(const BPlusTree& oth) : less_(oth.less_) {
+    LinearList<element_type> elems;
+    elems.reserve(oth.size_);
+    if constexpr (IS_SET)
+      oth.for_each([&](const Key& key) { elems.push_back(key); });
+    else
+      oth.for_each([&](const Key& key, const Value& val) {
+        elems.push_back(element_type(key, val));
+      });
+    bulk_load(elems);
+  }
+
+  BPlusTree(BPlusTree&& old) noexcept { swap(old); }
+
+  ~BPlusTree() { clear(); }
+
+  BPlusTree& operator=(const BPlusTree& oth) {
+    if (this != &oth) {
+      BPlusTree tmp(oth);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  BPlusTree& operator=(BPlusTree&& old) noexcept {
+    if (this != &old) {
+      BPlusTree tmp(std::move(old));
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  // public method
+ public:
+  bool empty() const { return size_ == 0; }
+
+  size_t size() const { return size_; }
+
+  // the number of levels; 0 for an empty tree
+  size_t height() const { return height_; }
+
+  static constexpr size_t leaf_capacity() { return LEAF; }
+
+  static constexpr size_t inner_capacity() { return INNER; }
+
+  // insert key into a set; whether it was absent
+  bool insert(const Key& key)
+    requires IS_SET
+  {
+    return insert_impl(key, false);
+  }
+
+  // insert (key, val) into a map unless key is present
+  template <class V>
+  bool insert(const Key& key, V&& val)
+    requires(!IS_SET)
+  {
+    return insert_impl(key, false, std::forward<V>(val));
+  }
+
+  // map key to val, whether key was present or not
+  template <class V>
+  bool insert_or_assign(const Key& key, V&& val)
+    requires(!IS_SET)
+  {
+    return insert_impl(key, true, std::forward<V>(val));
+  }
+
+  // the value of key in a map, or nullptr
+  template <class V = Value>
+  V* find(const Key& key)
+    requires(!IS_SET)
+  {
+    auto [leaf, pos] = locate(key);
+    return leaf ? &leaf->values_[pos] : nullptr;
+  }
+
+  template <class V = Value>
+  const V* find(const Key& key) const
+    requires(!IS_SET)
+  {
+    auto [leaf, pos] = locate(key);
+    return leaf ? &leaf->values_[pos] : nullptr;
+  }
+
+  bool contains(const Key& key) const { return locate(key).first; }
+
+  // remove key; whether it was present
+  bool erase(const Key& key) {
+    if (root_ == nullptr) return false;
+    if (!erase_rec(root_, key)) return false;
+    --size_;
+    if (root_->count_ == 0) {
+      // the root lost its last separator (or element): drop a level
+      Node* old = root_;
+      root_ = old->leaf_ ? nullptr : as_inner(old)->children_[0];
+      if (old->leaf_) first_ = nullptr;
+      destroy(old);
+      --height_;
+    }
+    return true;
+  }
+
+  /**
+   * @brief
+   *
+   * call fn on every element in key order: fn(key) for a set, fn(key,
+   * value) for a map.
+   */
+  template <class F>
+  void for_each(F&& fn) const {
+    for (const Leaf* leaf = first_; leaf; leaf = leaf->next_)
+      for (size_t i = 0; i < leaf->count_; ++i) visit(leaf, i, fn);
+  }
+
+  template <class F>
+  void for_each(F&& fn) {
+    for (Leaf* leaf = first_; leaf; leaf = leaf->next_)
+      for (size_t i = 0; i < leaf->count_; ++i) visit(leaf, i, fn);
+  }
+
+  // call fn on every element with a key in [lo, hi), in key order
+  template <class F>
+  void for_range(const Key& lo, const Key& hi, F&& fn) const {
+    const_cast<BPlusTree*>(this)->range_impl(
+        lo, hi, [&](const Leaf* leaf, size_t i) { visit(leaf, i, fn); });
+  }
+
+  template <class F>
+  void for_range(const Key& lo, const Key& hi, F&& fn) {
+    range_impl(lo, hi, [&](Leaf* leaf, size_t i) { visit(leaf, i, fn); });
+  }
+
+  /**
+   * @brief
+   *
+   * replace the contents with elems, which must be sorted by key with no
+   * key repeated. Leaves are filled up, and the elements are spread evenly
+   * so that no node is less than half full.
+   */
+  void bulk_load(const LinearList<element_type>& elems) {
+    clear();
+    if (elems.empty()) return;
+    for (size_t i = 1; i < elems.size(); ++i)
+      assert(less_(key_of(elems[i - 1]), key_of(elems[i])) &&
+             "bulk load of unsorted or repeated keys");
+
+    // the nodes of the level being built, with the first key under each
+    LinearList<std::pair<Node*, Key>> level;
+    const size_t leaves = (elems.size() + LEAF - 1) / LEAF;
+    Leaf* prev = nullptr;
+    size_t next = 0;
+    for (size_t i = 0; i < leaves; ++i) {
+      const size_t count = share(elems.size(), leaves, i);
+      Leaf* leaf = new Leaf;
+      for (size_t j = 0; j < count; ++j, ++next) {
+        leaf->keys_[j] = key_of(elems[next]);
+        if constexpr (!IS_SET) leaf->values_[j] = elems[next].second;
+      }
+      leaf->count_ = (uint32_t)count;
+      leaf->prev_ = prev;
+      if (prev) prev->next_ = leaf;
+      prev = leaf;
+      if (i == 0) first_ = leaf;
+      level.push_back({leaf, leaf->keys_[0]});
+    }
+    size_ = elems.size();
+    height_ = 1;
+
+    while (level.size() > 1) {
+      LinearList<std::pair<Node*, Key>> upper;
+      const size_t nodes = (level.size() + INNER) / (INNER + 1);
+      size_t child = 0;
+      for (size_t i = 0; i < nodes; ++i) {
+        const size_t count = share(level.size(), nodes, i);
+        Inner* inner = new Inner;
+        for (size_t j = 0; j < count; ++j, ++child) {
+          inner->children_[j] = level[child].first;
+          if (j > 0) inner->keys_[j - 1] = level[child].second;
+        }
+        inner->count_ = (uint32_t)(count - 1);
+        upper.push_back({inner, level[child - count].second});
+      }
+      level.swap(upper);
+      ++height_;
+    }
+    root_ = level[0].first;
+  }
+
+  void clear() {
+    if (root_) destroy_rec(root_);
+    root_ = nullptr;
+    first_ = nullptr;
+    size_ = height_ = 0;
+  }
+
+  void swap(BPlusTree& oth) noexcept {
+    std::swap(root_, oth.root_);
+    std::swap(first_, oth.first_);
+    std::swap(size_, oth.size_);
+    std::swap(height_, oth.height_);
+    std::swap(less_, oth.less_);
+  }
+
+  // private method
+ private:
+  static Key pad() { return std::numeric_limits<Key>::max(); }
+
+  // what a key slot past the count holds
+  static Key vacant() {
+    if constexpr (PADDED)
+      return pad();
+    else
+      return Key();
+  }
+
+  static Leaf* as_leaf(Node* node) { return static_cast<Leaf*>(node); }
+
+  static Inner* as_inner(Node* node) { return static_cast<Inner*>(node); }
+
+  static const Key& key_of(const element_type& elem) {
+    if constexpr (IS_SET)
+      return elem;
+    else
+      return elem.first;
+  }
+
+  // the size of part i when total things are spread over parts
+  static size_t share(size_t total, size_t parts, size_t i) {
+    return total / parts + (i < total % parts);
+  }
+
+  template <class L, class F>
+  static void visit(L* leaf, size_t i, F& fn) {
+    if constexpr (IS_SET)
+      fn(static_cast<const Key&>(leaf->keys_[i]));
+    else
+      fn(static_cast<const Key&>(leaf->keys_[i]), leaf->values_[i]);
+  }
+
+  // the number of keys[0, count) less than key
+  template <size_t Capacity>
+  size_t lower(const Key (&keys)[Capacity], size_t count,
+               const Key& key) const {
+    if constexpr (PADDED) {
+      // the slots past count hold pad(), which is never less than key
+      const Key* base = keys;
+      size_t len = Capacity;
+      while (len > BPlusTreeDetail::WINDOW) {
+        const size_t half = len / 2;
+        base = base[half - 1] < key ? base + half : base;
+        len -= half;
+      }
+      size_t ret = base - keys;
+      for (size_t i = 0; i < len; ++i) ret += base[i] < key;
+      return ret;
+    } else {
+      return std::lower_bound(keys, keys + count, key, less_) - keys;
+    }
+  }
+
+  // the child of inner whose range holds key
+  size_t child_of(const Inner* inner, const Key& key) const {
+    size_t idx = lower(inner->keys_, inner->count_, key);
+    if (idx < inner->count_ && !less_(key, inner->keys_[idx])) ++idx;
+    return idx;
+  }
+
+  // the leaf and slot holding key, or a null leaf
+  std::pair<Leaf*, size_t> locate(const Key& key) const {
+    Node* node = root_;
+    if (node == nullptr) return {nullptr, 0};
+    while (!node->leaf_) {
+      const Inner* inner = as_inner(node);
+      node = inner->children_[child_of(inner, key)];
+    }
+    Leaf* leaf = as_leaf(node);
+    const size_t pos = lower(leaf->keys_, leaf->count_, key);
+    if (pos < leaf->count_ && !less_(key, leaf->keys_[pos]))
+      return {leaf, pos};
+    return {nullptr, 0};
+  }
+
+  template <class F>
+  void range_impl(const Key& lo, const Key& hi, F&& fn) {
+    Node* node = root_;
+    if (node == nullptr || !less_(lo, hi)) return;
+    while (!node->leaf_) node = as_inner(node)->children_[
+        child_of(as_inner(node), lo)];
+    Leaf* leaf = as_leaf(node);
+    size_t pos = lower(leaf->keys_, leaf->count_, lo);
+    for (; leaf; leaf = leaf->next_, pos = 0) {
+      for (; pos < leaf->count_; ++pos) {
+        if (!less_(leaf->keys_[pos], hi)) return;
+        fn(leaf, pos);
+      }
+    }
+  }
+
+  template <class... V>
+  bool insert_impl(const Key& key, bool assign, V&&... val) {
+    // the arguments may refer to elements of this tree, which a split or
+    // a shift on the way moves: take them over before descending
+    Key owned(key);
+    if constexpr (IS_SET) {
+      return insert_owned(owned, assign);
+    } else {
+      Value value(std::forward<V>(val)...);
+      return insert_owned(owned, assign, std::move(value));
+    }
+  }
+
+  template <class... V>
+  bool insert_owned(Key& key, bool assign, V&&... val) {
+    if (root_ == nullptr) {
+      Leaf* leaf = new Leaf;
+      root_ = first_ = leaf;
+      height_ = 1;
+    }
+    Split split;
+    const bool inserted =
+        insert_rec(root_, key, assign, split, std::forward<V>(val)...);
+    if (split.node_) {
+      // the root split: grow a level
+      Inner* root = new Inner;
+      root->keys_[0] = std::move(split.key_);
+      root->children_[0] = root_;
+      root->children_[1] = split.node_;
+      root->count_ = 1;
+      root_ = root;
+      ++height_;
+    }
+    size_ += inserted;
+    return inserted;
+  }
+
+  template <class... V>
+  bool insert_rec(Node* node, Key& key, bool assign, Split& split,
+                  V&&... val) {
+    if (node->leaf_) return leaf_insert(as_leaf(node), key, assign, split,
+                                        std::forward<V>(val)...);
+    Inner* inner = as_inner(node);
+    const size_t idx = child_of(inner, key);
+    Split below;
+    const bool inserted = insert_rec(inner->children_[idx], key, assign,
+                                     below, std::forward<V>(val)...);
+    if (below.node_) inner_insert(inner, idx, below, split);
+    return inserted;
+  }
+
+  template <class... V>
+  bool leaf_insert(Leaf* leaf, Key& key, bool assign, Split& split,
+                   V&&... val) {
+    size_t pos = lower(leaf->keys_, leaf->count_, key);
+    if (pos < leaf->count_ && !less_(key, leaf->keys_[pos])) {
+      if constexpr (!IS_SET) {
+        if (assign) leaf->values_[pos] = (std::forward<V>(val), ...);
+      }
+      return false;
+    }
+    if (leaf->count_ == LEAF) {
+      // move the upper half to a new right sibling
+      Leaf* right = new Leaf;
+      const size_t mid = LEAF / 2;
+      move_elems(leaf, mid, right, 0, LEAF - mid);
+      right->count_ = (uint32_t)(LEAF - mid);
+      leaf->count_ = (uint32_t)mid;
+      clear_tail(leaf, mid, LEAF);
+      right->next_ = leaf->next_;
+      right->prev_ = leaf;
+      if (right->next_) right->next_->prev_ = right;
+      leaf->next_ = right;
+      if (pos > mid) {
+        leaf = right;
+        pos -= mid;
+      }
+      split.node_ = right;
+      split.key_ = right->keys_[0];
+    }
+    // open a gap at pos
+    const size_t count = leaf->count_;
+    std::move_backward(leaf->keys_ + pos, leaf->keys_ + count,
+                       leaf->keys_ + count + 1);
+    leaf->keys_[pos] = std::move(key);
+    if constexpr (!IS_SET) {
+      std::move_backward(leaf->values_ + pos, leaf->values_ + count,
+                         leaf->values_ + count + 1);
+      leaf->values_[pos] = (std::forward<V>(val), ...);
+    }
+    leaf->count_++;
+    return true;
+  }
+
+  // put the separator and right node of a split child idx into inner
+  void inner_insert(Inner* inner, size_t idx, Split& below, Split& split) {
+    if (inner->count_ == INNER) {
+      // keys [0, mid) stay, key mid moves up, the rest go right
+      Inner* right = new Inner;
+      const size_t mid = INNER / 2;
+      const size_t moved = INNER - mid - 1;
+      std::move(inner->keys_ + mid + 1, inner->keys_ + INNER, right->keys_);
+      std::copy(inner->children_ + mid + 1, inner->children_ + INNER + 1,
+                right->children_);
+      right->count_ = (uint32_t)moved;
+      split.node_ = right;
+      split.key_ = std::move(inner->keys_[mid]);
+      inner->count_ = (uint32_t)mid;
+      std::fill(inner->keys_ + mid, inner->keys_ + INNER, vacant());
+      if (idx > mid) {
+        inner = right;
+        idx -= mid + 1;
+      }
+    }
+    const size_t count = inner->count_;
+    std::move_backward(inner->keys_ + idx, inner->keys_ + count,
+                       inner->keys_ + count + 1);
+    std::copy_backward(inner->children_ + idx + 1,
+                       inner->children_ + count + 1,
+                       inner->children_ + count + 2);
+    inner->keys_[idx] = std::move(below.key_);
+    inner->children_[idx + 1] = below.node_;
+    inner->count_++;
+  }
+
+  // erase key under node; the caller repairs node if it underflows
+  bool erase_rec(Node* node, const Key& key) {
+    if (node->leaf_) {
+      Leaf* leaf = as_leaf(node);
+      const size_t pos = lower(leaf->keys_, leaf->count_, key);
+      if (pos == leaf->count_ || less_(key, leaf->keys_[pos])) return false;
+      remove_elems(leaf, pos, 1);
+      return true;
+    }
+    Inner* inner = as_inner(node);
+    const size_t idx = child_of(inner, key);
+    if (!erase_rec(inner->children_[idx], key)) return false;
+    Node* child = inner->children_[idx];
+    if (child->count_ < (child->leaf_ ? MIN_LEAF : MIN_INNER))
+      rebalance(inner, idx);
+    return true;
+  }
+
+  // refill child idx of inner from a sibling, or merge it with one
+  void rebalance(Inner* inner, size_t idx) {
+    Node* child = inner->children_[idx];
+    Node* left = idx > 0 ? inner->children_[idx - 1] : nullptr;
+    Node* right = idx < inner->count_ ? inner->children_[idx + 1] : nullptr;
+    const size_t min = child->leaf_ ? MIN_LEAF : MIN_INNER;
+    if (child->leaf_) {
+      if (left && left->count_ > min) {
+        Leaf* from = as_leaf(left);
+        Leaf* to = as_leaf(child);
+        shift_right(to);
+        move_elems(from, from->count_ - 1, to, 0, 1);
+        remove_elems(from, from->count_ - 1, 1);
+        inner->keys_[idx - 1] = to->keys_[0];
+      } else if (right && right->count_ > min) {
+        Leaf* from = as_leaf(right);
+        Leaf* to = as_leaf(child);
+        move_elems(from, 0, to, to->count_, 1);
+        to->count_++;
+        remove_elems(from, 0, 1);
+        inner->keys_[idx] = from->keys_[0];
+      } else if (left) {
+        merge_leaves(inner, idx - 1);
+      } else {
+        merge_leaves(inner, idx);
+      }
+      return;
+    }
+    if (left && left->count_ > min) {
+      // rotate through the parent: its separator comes down, the last
+      // separator of left goes up
+      Inner* from = as_inner(left);
+      Inner* to = as_inner(child);
+      const size_t count = to->count_;
+      std::move_backward(to->keys_, to->keys_ + count,
+                         to->keys_ + count + 1);
+      std::copy_backward(to->children_, to->children_ + count + 1,
+                         to->children_ + count + 2);
+      to->keys_[0] = std::move(inner->keys_[idx - 1]);
+      to->children_[0] = from->children_[from->count_];
+      to->count_++;
+      inner->keys_[idx - 1] = std::move(from->keys_[from->count_ - 1]);
+      from->keys_[from->count_ - 1] = vacant();
+      from->count_--;
+    } else if (right && right->count_ > min) {
+      Inner* from = as_inner(right);
+      Inner* to = as_inner(child);
+      to->keys_[to->count_] = std::move(inner->keys_[idx]);
+      to->children_[to->count_ + 1] = from->children_[0];
+      to->count_++;
+      inner->keys_[idx] = std::move(from->keys_[0]);
+      remove_separator(from, 0, 0);
+    } else if (left) {
+      merge_inners(inner, idx - 1);
+    } else {
+      merge_inners(inner, idx);
+    }
+  }
+
+  // move the elements of leaf idx + 1 of inner into leaf idx
+  void merge_leaves(Inner* inner, size_t idx) {
+    Leaf* left = as_leaf(inner->children_[idx]);
+    Leaf* right = as_leaf(inner->children_[idx + 1]);
+    move_elems(right, 0, left, left->count_, right->count_);
+    left->count_ += right->count_;
+    left->next_ = right->next_;
+    if (left->next_) left->next_->prev_ = left;
+    remove_separator(inner, idx, idx + 1);
+    delete right;
+  }
+
+  // move the separator idx of inner and inner node idx + 1 into node idx
+  void merge_inners(Inner* inner, size_t idx) {
+    Inner* left = as_inner(inner->children_[idx]);
+    Inner* right = as_inner(inner->children_[idx + 1]);
+    const size_t count = left->count_;
+    left->keys_[count] = std::move(inner->keys_[idx]);
+    std::move(right->keys_, right->keys_ + right->count_,
+              left->keys_ + count + 1);
+    std::copy(right->children_, right->children_ + right->count_ + 1,
+              left->children_ + count + 1);
+    left->count_ += right->count_ + 1;
+    remove_separator(inner, idx, idx + 1);
+    delete right;
+  }
+
+  // drop separator sep and child child of inner
+  void remove_separator(Inner* inner, size_t sep, size_t child) {
+    const size_t count = inner->count_;
+    std::move(inner->keys_ + sep + 1, inner->keys_ + count,
+              inner->keys_ + sep);
+    std::copy(inner->children_ + child + 1, inner->children_ + count + 1,
+              inner->children_ + child);
+    inner->keys_[count - 1] = vacant();
+    inner->count_--;
+  }
+
+  // move n elements from slot from of src to slot to of dst
+  static void move_elems(Leaf* src, size_t from, Leaf* dst, size_t to,
+                         size_t n) {
+    std::move(src->keys_ + from, src->keys_ + from + n, dst->keys_ + to);
+    if constexpr (!IS_SET)
+      std::move(src->values_ + from, src->values_ + from + n,
+                dst->values_ + to);
+  }
+
+  // open slot 0 of leaf
+  static void shift_right(Leaf* leaf) {
+    const size_t count = leaf->count_;
+    std::move_backward(leaf->keys_, leaf->keys_ + count,
+                       leaf->keys_ + count + 1);
+    if constexpr (!IS_SET)
+      std::move_backward(leaf->values_, leaf->values_ + count,
+                         leaf->values_ + count + 1);
+    leaf->count_++;
+  }
+
+  // close the n slots of leaf from pos on
+  static void remove_elems(Leaf* leaf, size_t pos, size_t n) {
+    const size_t count = leaf->count_;
+    std::move(leaf->keys_ + pos + n, leaf->keys_ + count, leaf->keys_ + pos);
+    if constexpr (!IS_SET)
+      std::move(leaf->values_ + pos + n, leaf->values_ + count,
+                leaf->values_ + pos);
+    leaf->count_ = (uint32_t)(count - n);
+    clear_tail(leaf, count - n, count);
+  }
+
+  // reset the slots [from, to) of leaf past its count
+  static void clear_tail(Leaf* leaf, size_t from, size_t to) {
+    std::fill(leaf->keys_ + from, leaf->keys_ + to, vacant());
+    if constexpr (!IS_SET)
+      std::fill(leaf->values_ + from, leaf->values_ + to, Value());
+  }
+
+  static void destroy(Node* node) {
+    if (node->leaf_)
+      delete as_leaf(node);
+    else
+      delete as_inner(node);
+  }
+
+  static void destroy_rec(Node* node) {
+    if (!node->leaf_) {
+      Inner* inner = as_inner(node);
+      for (size_t i = 0; i <= inner->count_; ++i)
+        destroy_rec(inner->children_[i]);
+    }
+    destroy(node);
+  }
+
+  // members
+ private:
+  Node* root_ = nullptr;
+  // the leftmost leaf, where for_each starts
+  Leaf* first_ = nullptr;
+  size_t size_ = 0;
+  size_t height_ = 0;
+  [[no_unique_address]] Compare less_;
+};
+
+template <class Key, class Value, class Compare = std::less<Key>,
+          size_t NodeBytes = 256>
+using BPlusTreeMap = BPlusTree<Key, Value, Compare, NodeBytes>;
+
+template <class Key, class Compare = std::less<Key>, size_t NodeBytes = 256>
+using BPlusTreeSet = BPlusTree<Key, void, Compare, NodeBytes>;
+
+#endif
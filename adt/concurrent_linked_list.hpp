@@ -0,0 +1,372 @@
+/**
+ * @file concurrent_linked_list.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-26
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines lock-free variants of LinkedList.
+ *
+ * ConcurrentQueue is the Michael-Scott queue: a singly linked list with a
+ * dummy head node, where producers link new nodes at the tail and consumers
+ * advance the head, each with a single CAS.
+ *
+ * ConcurrentOrderedList is the Harris-Michael ordered list, a set of keys
+ * kept sorted by Compare. Erasure first marks the lowest bit of the victim's
+ * next pointer, which freezes it, and then unlinks it; any thread that finds
+ * a marked node on its way helps unlinking it.
+ *
+ * Unlinked nodes are handed to the Reclaimer (see hazard_pointer.hpp) and
+ * freed once no operation can still reach them. Alloc shall be safe to use
+ * from several threads at once, which std::allocator is and NodePool is not.
+ */
+
+#ifndef CONCURRENT_LINKED_LIST_HPP_
+#define CONCURRENT_LINKED_LIST_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "concurrency/cache_line.hpp"
+#include "concurrency/hazard_pointer.hpp"
+
+template <class Ty, class Reclaimer = HazardPointerDomain,
+          class Alloc = std::allocator<Ty>>
+class ConcurrentQueue {
+  // definitions
+ private:
+  struct Node {
+    std::atomic<Node*> next_{nullptr};
+    // constructed by push, and moved out and destroyed by pop
+    alignas(Ty) unsigned char storage_[sizeof(Ty)];
+
+    Ty* value() { return std::launder(reinterpret_cast<Ty*>(storage_)); }
+  };
+
+  using NodeAlloc = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<Node>;
+  using NodeTraits = std::allocator_traits<NodeAlloc>;
+  using Guard = typename Reclaimer::Guard;
+
+ public:
+  using allocator_type = Alloc;
+
+  // constructors & destructor
+ public:
+  ConcurrentQueue() : ConcurrentQueue(Alloc()) {}
+
+  explicit ConcurrentQueue(const Alloc& alloc) : alloc_(alloc) {
+    Node* dummy = alloc_node();
+    head_.value_.store(dummy, std::memory_order_relaxed);
+    tail_.value_.store(dummy, std::memory_order_relaxed);
+  }
+
+  ConcurrentQueue(const ConcurrentQueue&) = delete;
+
+  ~ConcurrentQueue() {
+    reclaimer_.drain();
+    Node* cur = head_.value_.load(std::memory_order_relaxed);
+    Node* next = cur->next_.load(std::memory_order_relaxed);
+    dealloc_node(cur);
+    for (cur = next; cur != nullptr; cur = next) {
+      next = cur->next_.load(std::memory_order_relaxed);
+      std::destroy_at(cur->value());
+      dealloc_node(cur);
+    }
+  }
+
+  // public method
+ public:
+  template <class... Args>
+  void emplace(Args&&... args) {
+    Node* node = alloc_node();
+    try {
+      ::new ((void*)node->storage_) Ty(std::forward<Args>(args)...);
+    } catch (...) {
+      dealloc_node(node);
+      throw;
+    }
+
+    Guard guard(reclaimer_);
+    while (1) {
+      Node* tail = guard.protect(0, tail_.value_);
+      Node* next = tail->next_.load(std::memory_order_acquire);
+      if (tail != tail_.value_.load(std::memory_order_acquire)) continue;
+      if (next != nullptr) {
+        // the tail lags behind: help the other producer swing it
+        tail_.value_.compare_exchange_weak(tail, next,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed);
+        continue;
+      }
+      if (tail->next_.compare_exchange_weak(next, node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        tail_.value_.compare_exchange_strong(tail, node,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed);
+        return;
+      }
+    }
+  }
+
+  void push(const Ty& val) { emplace(val); }
+
+  void push(Ty&& val) { emplace(std::move(val)); }
+
+  // take the oldest element, if any
+  std::optional<Ty> pop() {
+    Guard guard(reclaimer_);
+    while (1) {
+      Node* head = guard.protect(0, head_.value_);
+      Node* tail = tail_.value_.load(std::memory_order_acquire);
+      Node* next = guard.protect(1, head->next_);
+      if (head != head_.value_.load(std::memory_order_acquire)) continue;
+      if (next == nullptr) return std::nullopt;
+      if (head == tail) {
+        tail_.value_.compare_exchange_weak(tail, next,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed);
+        continue;
+      }
+      if (head_.value_.compare_exchange_weak(head, next,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_relaxed)) {
+        // next is the new dummy; its value belongs to this thread alone
+        std::optional<Ty> ret(std::move(*next->value()));
+        std::destroy_at(next->value());
+        guard.retire(head, &ConcurrentQueue::reclaim, this);
+        return ret;
+      }
+    }
+  }
+
+  // whether the queue was empty at some moment during the call
+  bool empty() {
+    Guard guard(reclaimer_);
+    Node* head = guard.protect(0, head_.value_);
+    return head->next_.load(std::memory_order_acquire) == nullptr;
+  }
+
+  Reclaimer& reclaimer() { return reclaimer_; }
+
+  // private method
+ private:
+  Node* alloc_node() {
+    Node* ret = NodeTraits::allocate(alloc_, 1);
+    NodeTraits::construct(alloc_, ret);
+    return ret;
+  }
+
+  void dealloc_node(Node* node) {
+    NodeTraits::destroy(alloc_, node);
+    NodeTraits::deallocate(alloc_, node, 1);
+  }
+
+  static void reclaim(void* node, void* self) {
+    static_cast<ConcurrentQueue*>(self)->dealloc_node(static_cast<Node*>(node));
+  }
+
+  // members
+ private:
+  CacheLinePadded<std::atomic<Node*>> head_;
+  CacheLinePadded<std::atomic<Node*>> tail_;
+  [[no_unique_address]] NodeAlloc alloc_;
+  Reclaimer reclaimer_;
+};
+
+template <class Key, class Compare = std::less<Key>,
+          class Reclaimer = HazardPointerDomain,
+          class Alloc = std::allocator<Key>>
+class ConcurrentOrderedList {
+  // definitions
+ private:
+  struct Node {
+    explicit Node(const Key& key) : next_(nullptr), key_(key) {}
+
+    std::atomic<Node*> next_;
+    const Key key_;
+  };
+
+  using NodeAlloc = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<Node>;
+  using NodeTraits = std::allocator_traits<NodeAlloc>;
+  using Guard = typename Reclaimer::Guard;
+
+  // where a key is, or would be inserted
+  struct Position {
+    std::atomic<Node*>* prev_;
+    Node* cur_;
+    Node* next_;
+  };
+
+ public:
+  using allocator_type = Alloc;
+
+  // constructors & destructor
+ public:
+  ConcurrentOrderedList() : ConcurrentOrderedList(Alloc()) {}
+
+  explicit ConcurrentOrderedList(const Alloc& alloc, Compare cmp = Compare())
+      : head_(nullptr), cmp_(std::move(cmp)), alloc_(alloc) {}
+
+  ConcurrentOrderedList(const ConcurrentOrderedList&) = delete;
+
+  ~ConcurrentOrderedList() {
+    reclaimer_.drain();
+    Node* cur = head_.load(std::memory_order_relaxed);
+    while (cur != nullptr) {
+      Node* next = unmark(cur->next_.load(std::memory_order_relaxed));
+      dealloc_node(cur);
+      cur = next;
+    }
+  }
+
+  // public method
+ public:
+  // insert key unless it is present; returns whether it was inserted
+  bool insert(const Key& key) {
+    Guard guard(reclaimer_);
+    Node* node = nullptr;
+    Position pos;
+    while (1) {
+      if (find(guard, key, pos)) {
+        // never published, so no reader can hold it
+        if (node != nullptr) dealloc_node(node);
+        return false;
+      }
+      if (node == nullptr) node = alloc_node(key);
+      node->next_.store(pos.cur_, std::memory_order_relaxed);
+      if (pos.prev_->compare_exchange_strong(pos.cur_, node,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed))
+        return true;
+    }
+  }
+
+  // erase key if it is present; returns whether this call erased it
+  bool erase(const Key& key) {
+    Guard guard(reclaimer_);
+    Position pos;
+    while (1) {
+      if (!find(guard, key, pos)) return false;
+      // logical deletion: mark the next pointer of the victim
+      if (!pos.cur_->next_.compare_exchange_strong(
+              pos.next_, mark(pos.next_), std::memory_order_acq_rel,
+              std::memory_order_relaxed))
+        continue;
+      // physical deletion, or leave it to the next traversal
+      Node* cur = pos.cur_;
+      if (pos.prev_->compare_exchange_strong(cur, pos.next_,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_relaxed))
+        guard.retire(pos.cur_, &ConcurrentOrderedList::reclaim, this);
+      else
+        find(guard, key, pos);
+      return true;
+    }
+  }
+
+  bool contains(const Key& key) {
+    Guard guard(reclaimer_);
+    Position pos;
+    return find(guard, key, pos);
+  }
+
+  Reclaimer& reclaimer() { return reclaimer_; }
+
+  // private method
+ private:
+  static bool marked(Node* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) & 1;
+  }
+
+  static Node* mark(Node* ptr) {
+    return reinterpret_cast<Node*>(reinterpret_cast<uintptr_t>(ptr) | 1);
+  }
+
+  static Node* unmark(Node* ptr) {
+    return reinterpret_cast<Node*>(reinterpret_cast<uintptr_t>(ptr) &
+                                   ~(uintptr_t)1);
+  }
+
+  /**
+   * @brief
+   *
+   * find the first node whose key is not less than key, unlinking marked
+   * nodes on the way. On return pos.cur_ is protected in slot 1 and
+   * pos.prev_ lies in a node protected in slot 2 (or is head_).
+   *
+   * @return bool whether pos.cur_ holds key
+   */
+  bool find(Guard& guard, const Key& key, Position& pos) {
+  try_again:
+    std::atomic<Node*>* prev = &head_;
+    Node* cur = guard.protect(1, *prev);
+    while (1) {
+      if (cur == nullptr) {
+        pos = Position{prev, nullptr, nullptr};
+        return false;
+      }
+      Node* next = guard.protect(0, cur->next_);
+      // cur must still follow prev, or the hazard came too late
+      if (prev->load(std::memory_order_acquire) != cur) goto try_again;
+
+      if (!marked(next)) {
+        if (!cmp_(cur->key_, key)) {
+          pos = Position{prev, cur, next};
+          return !cmp_(key, cur->key_);
+        }
+        prev = &cur->next_;
+        guard.set(2, cur);
+      } else {
+        // cur is being erased: help unlinking it
+        Node* expected = cur;
+        if (!prev->compare_exchange_strong(expected, unmark(next),
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_relaxed))
+          goto try_again;
+        guard.retire(cur, &ConcurrentOrderedList::reclaim, this);
+      }
+      cur = unmark(next);
+      guard.set(1, cur);
+    }
+  }
+
+  Node* alloc_node(const Key& key) {
+    Node* ret = NodeTraits::allocate(alloc_, 1);
+    try {
+      NodeTraits::construct(alloc_, ret, key);
+    } catch (...) {
+      NodeTraits::deallocate(alloc_, ret, 1);
+      throw;
+    }
+    return ret;
+  }
+
+  void dealloc_node(Node* node) {
+    NodeTraits::destroy(alloc_, node);
+    NodeTraits::deallocate(alloc_, node, 1);
+  }
+
+  static void reclaim(void* node, void* self) {
+    static_cast<ConcurrentOrderedList*>(self)->dealloc_node(
+        static_cast<Node*>(node));
+  }
+
+  // members
+ private:
+  std::atomic<Node*> head_;
+  [[no_unique_address]] Compare cmp_;
+  [[no_unique_address]] NodeAlloc alloc_;
+  Reclaimer reclaimer_;
+};
+
+#endif
@@ -0,0 +1,530 @@
+/**
+ * @file dary_heap.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines DaryHeap, a priority queue on a LinearList, and
+ * IndexedDaryHeap, which also hands out handles to change or remove queued
+ * elements.
+ *
+ * Every node has D children, 4 by default, stored next to each other: the
+ * tree is half as deep as a binary heap and the children compared at each
+ * level of a sift share one or two cache lines. A pop moves the hole left
+ * by the top down to a leaf along the best children and only then sifts the
+ * last element up from there, which saves the comparisons against it on the
+ * way down; it rarely climbs far.
+ *
+ * top() is the first element in Compare order, so the default std::less
+ * makes a min-heap, the opposite of std::priority_queue:
+ *
+ *   IndexedDaryHeap<uint64_t> queue;
+ *   auto handle = queue.push(100);
+ *   queue.decrease_key(handle, 10);  // now the top
+ *   queue.pop();
+ *
+ * A heap built from a list, and push_batch() of at least as many elements
+ * as are queued, use Floyd's bottom-up heapify: O(n) instead of
+ * O(n log n). pop_batch() hands out up to n elements in order.
+ *
+ * A handle stays valid while its element is queued; afterwards it is
+ * stale, and find(), update() and erase() reject it. Handle slots are
+ * recycled with a new generation, as in TimerWheel.
+ */
+
+#ifndef DARY_HEAP_HPP_
+#define DARY_HEAP_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "adt/linear_list.hpp"
+
+namespace DaryHeapDetail {
+const static uint32_t NIL = UINT32_MAX;
+
+template <size_t D>
+constexpr size_t parent(size_t pos) {
+  return (pos - 1) / D;
+}
+
+template <size_t D>
+constexpr size_t first_child(size_t pos) {
+  return pos * D + 1;
+}
+
+/**
+ * @brief
+ *
+ * the best of the count children starting at first. The winner is picked
+ * with a mask, not a branch: which child wins is a coin toss, and
+ * compilers readily turn a plain conditional back into one.
+ */
+template <size_t D, class Elem, class Less>
+size_t best_child(const Elem* heap, size_t first, size_t count,
+                  const Less& less) {
+  size_t best = first;
+  // a fixed trip count for a full node, unrolled by the compiler
+  const size_t n = count == D ? D : count;
+  for (size_t c = first + 1; c < first + n; ++c) {
+    const size_t wins = -(size_t)less(heap[c], heap[best]);
+    best ^= (best ^ c) & wins;
+  }
+  return best;
+}
+
+/**
+ * @brief
+ *
+ * move heap[pos] towards the root while it goes before its parent. placed(i)
+ * is called for every position i that receives an element.
+ *
+ * @return size_t the final position of the element
+ */
+template <size_t D, class Elem, class Less, class Placed>
+size_t sift_up(Elem* heap, size_t pos, const Less& less, Placed&& placed) {
+  Elem val = std::move(heap[pos]);
+  while (pos > 0) {
+    const size_t up = parent<D>(pos);
+    if (!less(val, heap[up])) break;
+    heap[pos] = std::move(heap[up]);
+    placed(pos);
+    pos = up;
+  }
+  heap[pos] = std::move(val);
+  placed(pos);
+  return pos;
+}
+
+// move heap[pos] towards the leaves while a child goes before it
+template <size_t D, class Elem, class Less, class Placed>
+size_t sift_down(Elem* heap, size_t size, size_t pos, const Less& less,
+                 Placed&& placed) {
+  Elem val = std::move(heap[pos]);
+  for (size_t first = first_child<D>(pos); first < size;
+       first = first_child<D>(pos)) {
+    const size_t best =
+        best_child<D>(heap, first, std::min(D, size - first), less);
+    if (!less(heap[best], val)) break;
+    heap[pos] = std::move(heap[best]);
+    placed(pos);
+    pos = best;
+  }
+  heap[pos] = std::move(val);
+  placed(pos);
+  return pos;
+}
+
+/**
+ * @brief
+ *
+ * fill the hole at pos with the element at size - 1, which then leaves the
+ * heap: the hole sinks to a leaf along the best children, and the element
+ * rises from there.
+ */
+template <size_t D, class Elem, class Less, class Placed>
+void fill_hole(Elem* heap, size_t size, size_t pos, const Less& less,
+               Placed&& placed) {
+  const size_t last = size - 1;
+  for (size_t first = first_child<D>(pos); first < last;
+       first = first_child<D>(pos)) {
+    const size_t best =
+        best_child<D>(heap, first, std::min(D, last - first), less);
+    heap[pos] = std::move(heap[best]);
+    placed(pos);
+    pos = best;
+  }
+  if (pos == last) return;
+  heap[pos] = std::move(heap[last]);
+  sift_up<D>(heap, pos, less, placed);
+}
+
+// Floyd's heapify of the first size elements
+template <size_t D, class Elem, class Less, class Placed>
+void heapify(Elem* heap, size_t size, const Less& less, Placed&& placed) {
+  if (size < 2) {
+    if (size == 1) placed(0);
+    return;
+  }
+  for (size_t pos = size; pos-- > 0;) {
+    if (first_child<D>(pos) < size)
+      sift_down<D>(heap, size, pos, less, placed);
+    else
+      placed(pos);
+  }
+}
+
+// a placed() callback for heaps without handles
+struct Unplaced {
+  void operator()(size_t) const {}
+};
+};  // namespace DaryHeapDetail
+
+/**
+ * @brief a D-ary heap whose top is the first element in Compare order.
+ *
+ * @tparam Ty element type
+ * @tparam D children per node, at least 2
+ * @tparam Compare strict weak order; the smallest element comes out first
+ */
+template <class Ty, size_t D = 4, class Compare = std::less<Ty>>
+class DaryHeap {
+  static_assert(D >= 2, "a heap node needs at least two children");
+
+  // constructors & destructor
+ public:
+  explicit DaryHeap(Compare less = Compare()) : less_(std::move(less)) {}
+
+  // a heap of the elements of elems, built in O(n)
+  explicit DaryHeap(LinearList<Ty> elems, Compare less = Compare())
+      : heap_(std::move(elems)), less_(std::move(less)) {
+    DaryHeapDetail::heapify<D>(heap_.first(), heap_.size(), less_,
+                               DaryHeapDetail::Unplaced());
+  }
+
+  // public method
+ public:
+  size_t size() const { return heap_.size(); }
+
+  bool empty() const { return heap_.empty(); }
+
+  // the first element in Compare order
+  const Ty& top() const {
+    assert(!empty() && "top of an empty heap");
+    return heap_.front();
+  }
+
+  void push(const Ty& val) { emplace(val); }
+
+  void push(Ty&& val) { emplace(std::move(val)); }
+
+  template <class... Args>
+  void emplace(Args&&... args) {
+    heap_.emplace_back(std::forward<Args>(args)...);
+    DaryHeapDetail::sift_up<D>(heap_.first(), heap_.size() - 1, less_,
+                               DaryHeapDetail::Unplaced());
+  }
+
+  /**
+   * @brief
+   *
+   * push n elements. A batch at least as large as the heap is appended and
+   * the heap rebuilt in O(size() + n); a smaller one is sifted in one by one.
+   */
+  void push_batch(const Ty* vals, size_t n) {
+    const size_t before = heap_.size();
+    heap_.reserve(before + n);
+    for (size_t i = 0; i < n; ++i) heap_.push_back(vals[i]);
+    if (n >= before) {
+      DaryHeapDetail::heapify<D>(heap_.first(), heap_.size(), less_,
+                                 DaryHeapDetail::Unplaced());
+      return;
+    }
+    for (size_t i = before; i < heap_.size(); ++i)
+      DaryHeapDetail::sift_up<D>(heap_.first(), i, less_,
+                                 DaryHeapDetail::Unplaced());
+  }
+
+  void pop() {
+    assert(!empty() && "pop from an empty heap");
+    DaryHeapDetail::fill_hole<D>(heap_.first(), heap_.size(), 0, less_,
+                                 DaryHeapDetail::Unplaced());
+    heap_.pop_back();
+  }
+
+  // move the top to out and pop it; false on an empty heap
+  bool try_pop(Ty& out) {
+    if (empty()) return false;
+    out = std::move(heap_.front());
+    pop();
+    return true;
+  }
+
+  /**
+   * @brief
+   *
+   * pop up to n elements into out, in Compare order.
+   *
+   * @return size_t the number of elements popped
+   */
+  size_t pop_batch(Ty* out, size_t n) {
+    n = std::min(n, heap_.size());
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = std::move(heap_.front());
+      pop();
+    }
+    return n;
+  }
+
+  void clear() { heap_.clear(); }
+
+  void reserve(size_t size) { heap_.reserve(size); }
+
+  void swap(DaryHeap& oth) noexcept {
+    heap_.swap(oth.heap_);
+    std::swap(less_, oth.less_);
+  }
+
+  // members
+ private:
+  LinearList<Ty> heap_;
+  Compare less_;
+};
+
+/**
+ * @brief a D-ary heap whose elements can be found, re-prioritized and
+ * erased through the handles push() returns.
+ */
+template <class Ty, size_t D = 4, class Compare = std::less<Ty>>
+class IndexedDaryHeap {
+  static_assert(D >= 2, "a heap node needs at least two children");
+
+  // definitions
+ public:
+  // identifies a queued element; stale once it was popped or erased
+  struct Handle {
+    uint32_t index_ = DaryHeapDetail::NIL;
+    uint32_t generation_ = 0;
+  };
+
+ private:
+  struct Entry {
+    Ty value_;
+    // the handle slot of the element
+    uint32_t slot_;
+  };
+
+  struct Slot {
+    // the heap position of the element, or NIL while the slot is free
+    uint32_t pos_;
+    uint32_t generation_;
+  };
+
+  // orders entries by their values
+  struct EntryLess {
+    const Compare& less_;
+    bool operator()(const Entry& lhs, const Entry& rhs) const {
+      return less_(lhs.value_, rhs.value_);
+    }
+  };
+
+  // keeps the slot of every moved entry pointing at its new position
+  struct Placed {
+    IndexedDaryHeap& heap_;
+    void operator()(size_t pos) const {
+      heap_.slots_[heap_.heap_[pos].slot_].pos_ = (uint32_t)pos;
+    }
+  };
+
+  // constructors & destructor
+ public:
+  explicit IndexedDaryHeap(Compare less = Compare())
+      : less_(std::move(less)) {}
+
+  // public method
+ public:
+  size_t size() const { return heap_.size(); }
+
+  bool empty() const { return heap_.empty(); }
+
+  const Ty& top() const {
+    assert(!empty() && "top of an empty heap");
+    return heap_.front().value_;
+  }
+
+  // the handle of the top
+  Handle top_handle() const {
+    assert(!empty() && "top of an empty heap");
+    const uint32_t slot = heap_.front().slot_;
+    return Handle{slot, slots_[slot].generation_};
+  }
+
+  Handle push(const Ty& val) { return emplace(val); }
+
+  Handle push(Ty&& val) { return emplace(std::move(val)); }
+
+  template <class... Args>
+  Handle emplace(Args&&... args) {
+    const uint32_t slot = acquire();
+    heap_.push_back(Entry{Ty(std::forward<Args>(args)...), slot});
+    sift_up(heap_.size() - 1);
+    return Handle{slot, slots_[slot].generation_};
+  }
+
+  /**
+   * @brief
+   *
+   * push n elements and store their handles in handles[0, n), unless
+   * handles is null. A batch at least as large as the heap is appended and
+   * the heap rebuilt in O(size() + n).
+   */
+  void push_batch(const Ty* vals, size_t n, Handle* handles = nullptr) {
+    const size_t before = heap_.size();
+    heap_.reserve(before + n);
+    for (size_t i = 0; i < n; ++i) {
+      const uint32_t slot = acquire();
+      heap_.push_back(Entry{vals[i], slot});
+      slots_[slot].pos_ = (uint32_t)(before + i);
+      if (handles) handles[i] = Handle{slot, slots_[slot].generation_};
+    }
+    if (n >= before) {
+      DaryHeapDetail::heapify<D>(heap_.first(), heap_.size(),
+                                 EntryLess{less_}, Placed{*this});
+      return;
+    }
+    for (size_t i = before; i < heap_.size(); ++i) sift_up(i);
+  }
+
+  void pop() {
+    assert(!empty() && "pop from an empty heap");
+    remove(0);
+  }
+
+  bool try_pop(Ty& out) {
+    if (empty()) return false;
+    out = std::move(heap_.front().value_);
+    remove(0);
+    return true;
+  }
+
+  // pop up to n elements into out, in Compare order
+  size_t pop_batch(Ty* out, size_t n) {
+    n = std::min(n, heap_.size());
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = std::move(heap_.front().value_);
+      remove(0);
+    }
+    return n;
+  }
+
+  // whether handle refers to a queued element
+  bool contains(Handle handle) const {
+    return handle.index_ < slots_.size() &&
+           slots_[handle.index_].generation_ == handle.generation_ &&
+           slots_[handle.index_].pos_ != DaryHeapDetail::NIL;
+  }
+
+  // the element of handle, or nullptr for a stale handle
+  const Ty* find(Handle handle) const {
+    if (!contains(handle)) return nullptr;
+    return &heap_[slots_[handle.index_].pos_].value_;
+  }
+
+  /**
+   * @brief
+   *
+   * replace the element of handle with val, which must not go after it in
+   * Compare order, and move it towards the top.
+   *
+   * @return false for a stale handle
+   */
+  bool decrease_key(Handle handle, Ty val) {
+    if (!contains(handle)) return false;
+    const size_t pos = slots_[handle.index_].pos_;
+    assert(!less_(heap_[pos].value_, val) && "decrease_key increases");
+    heap_[pos].value_ = std::move(val);
+    sift_up(pos);
+    return true;
+  }
+
+  // replace the element of handle with val, in either direction
+  bool update(Handle handle, Ty val) {
+    if (!contains(handle)) return false;
+    const size_t pos = slots_[handle.index_].pos_;
+    const bool up = less_(val, heap_[pos].value_);
+    heap_[pos].value_ = std::move(val);
+    if (up)
+      sift_up(pos);
+    else
+      DaryHeapDetail::sift_down<D>(heap_.first(), heap_.size(), pos,
+                                   EntryLess{less_}, Placed{*this});
+    return true;
+  }
+
+  // remove the element of handle; false for a stale handle
+  bool erase(Handle handle) {
+    if (!contains(handle)) return false;
+    remove(slots_[handle.index_].pos_);
+    return true;
+  }
+
+  // drop every element; all handles become stale
+  void clear() {
+    for (size_t i = 0; i < heap_.size(); ++i) release(heap_[i].slot_);
+    heap_.clear();
+  }
+
+  void reserve(size_t size) {
+    heap_.reserve(size);
+    slots_.reserve(size);
+  }
+
+  void swap(IndexedDaryHeap& oth) noexcept {
+    heap_.swap(oth.heap_);
+    slots_.swap(oth.slots_);
+    free_.swap(oth.free_);
+    std::swap(less_, oth.less_);
+  }
+
+  // private method
+ private:
+  uint32_t acquire() {
+    if (!free_.empty()) {
+      const uint32_t slot = free_.back();
+      free_.pop_back();
+      return slot;
+    }
+    assert((slots_.size() < DaryHeapDetail::NIL) && "too many elements");
+    slots_.push_back(Slot{DaryHeapDetail::NIL, 0});
+    return (uint32_t)(slots_.size() - 1);
+  }
+
+  // free a slot; its outstanding handles become stale
+  void release(uint32_t slot) {
+    slots_[slot].pos_ = DaryHeapDetail::NIL;
+    slots_[slot].generation_++;
+    free_.push_back(slot);
+  }
+
+  void sift_up(size_t pos) {
+    DaryHeapDetail::sift_up<D>(heap_.first(), pos, EntryLess{less_},
+                               Placed{*this});
+  }
+
+  // take the element at pos out of the heap
+  void remove(size_t pos) {
+    release(heap_[pos].slot_);
+    const size_t last = heap_.size() - 1;
+    if (pos == 0) {
+      DaryHeapDetail::fill_hole<D>(heap_.first(), heap_.size(), 0,
+                                   EntryLess{less_}, Placed{*this});
+    } else if (pos != last) {
+      // the last element may belong above or below pos
+      heap_[pos] = std::move(heap_[last]);
+      const size_t up = DaryHeapDetail::parent<D>(pos);
+      if (less_(heap_[pos].value_, heap_[up].value_))
+        sift_up(pos);
+      else
+        DaryHeapDetail::sift_down<D>(heap_.first(), last, pos,
+                                     EntryLess{less_}, Placed{*this});
+    }
+    heap_.pop_back();
+  }
+
+  // members
+ private:
+  LinearList<Entry> heap_;
+  // handle index -> heap position
+  LinearList<Slot> slots_;
+  LinearList<uint32_t> free_;
+  Compare less_;
+};
+
+#endif
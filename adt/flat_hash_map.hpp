@@ -0,0 +1,565 @@
+/**
+ * @file flat_hash_map.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines FlatHashMap, an open-addressing hash map.
+ *
+ * Keys and values live inline in one array of slots, next to an array of
+ * control bytes: EMPTY, or the low 7 bits of the hash of the key in the
+ * slot. A lookup loads a group of 16 control bytes (32 with AVX2) at the
+ * home slot of the key and compares them all at once with SSE2 or AVX2,
+ * so only slots whose 7 hash bits match have their key compared; without
+ * SIMD a portable byte loop does the same. The first GROUP control bytes
+ * are cloned after the last one, so a group may start at any slot.
+ *
+ * Probing is linear, one slot at a time, which lets erase() shift the
+ * following keys of the run back into the hole instead of leaving a
+ * tombstone: a long-lived map with many erasures probes no further than a
+ * fresh one. The table holds at most 7/8 of its capacity, a power of two.
+ *
+ * With a Hash and an Eq that both define is_transparent, lookups accept any
+ * key type they can hash and compare, e.g. a std::string_view for a map
+ * keyed by std::string:
+ *
+ *   FlatHashMap<std::string, int, FlatHashMapPolicy::StringHash,
+ *               std::equal_to<>> map;
+ *   map.find(std::string_view("key"));  // no std::string is built
+ *
+ * The arrays are allocated through LinearListStorage. Inserting may move
+ * every element, so pointers returned by find() are only valid until the
+ * next insertion or erasure. Compiling with HYPERION_FLAT_HASH_SIMD=0
+ * disables the SIMD group matching.
+ */
+
+#ifndef FLAT_HASH_MAP_HPP_
+#define FLAT_HASH_MAP_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "adt/linear_list.hpp"
+
+#ifndef HYPERION_FLAT_HASH_SIMD
+#define HYPERION_FLAT_HASH_SIMD 1
+#endif
+
+#if HYPERION_FLAT_HASH_SIMD && (defined(__AVX2__) || defined(__SSE2__))
+#include <immintrin.h>
+#endif
+
+// hashers for FlatHashMap
+namespace FlatHashMapPolicy {
+// a transparent hash of std::string, std::string_view and const char*
+struct StringHash {
+  using is_transparent = void;
+
+  size_t operator()(std::string_view str) const {
+    return std::hash<std::string_view>()(str);
+  }
+};
+};  // namespace FlatHashMapPolicy
+
+namespace FlatHashMapDetail {
+// the control byte of an empty slot; full slots hold 0 to 127
+const static int8_t EMPTY = -128;
+// the highest load is MAX_LOAD_NUM / MAX_LOAD_DEN of the capacity
+const static size_t MAX_LOAD_NUM = 7;
+const static size_t MAX_LOAD_DEN = 8;
+
+#if HYPERION_FLAT_HASH_SIMD && defined(__AVX2__)
+const static size_t GROUP = 32;
+
+// GROUP control bytes; bit i of a mask stands for byte i
+struct Group {
+  explicit Group(const int8_t* ctrl)
+      : ctrl_(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ctrl))) {}
+
+  uint32_t match(int8_t h2) const {
+    return (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(ctrl_, _mm256_set1_epi8(h2)));
+  }
+
+  // EMPTY is the only control byte with the sign bit set
+  uint32_t match_empty() const {
+    return (uint32_t)_mm256_movemask_epi8(ctrl_);
+  }
+
+  __m256i ctrl_;
+};
+#elif HYPERION_FLAT_HASH_SIMD && defined(__SSE2__)
+const static size_t GROUP = 16;
+
+struct Group {
+  explicit Group(const int8_t* ctrl)
+      : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+  uint32_t match(int8_t h2) const {
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2)));
+  }
+
+  uint32_t match_empty() const { return (uint32_t)_mm_movemask_epi8(ctrl_); }
+
+  __m128i ctrl_;
+};
+#else
+const static size_t GROUP = 16;
+
+struct Group {
+  explicit Group(const int8_t* ctrl) { memcpy(ctrl_, ctrl, GROUP); }
+
+  uint32_t match(int8_t h2) const {
+    uint32_t ret = 0;
+    for (size_t i = 0; i < GROUP; ++i) ret |= uint32_t(ctrl_[i] == h2) << i;
+    return ret;
+  }
+
+  uint32_t match_empty() const {
+    uint32_t ret = 0;
+    for (size_t i = 0; i < GROUP; ++i) ret |= uint32_t(ctrl_[i] < 0) << i;
+    return ret;
+  }
+
+  int8_t ctrl_[GROUP];
+};
+#endif
+
+// spread the bits of a hash: std::hash of an integer is the identity
+inline uint64_t mix(uint64_t hash) {
+  hash ^= hash >> 32;
+  hash *= 0x9e3779b97f4a7c15ull;
+  return hash ^ (hash >> 29);
+}
+
+template <class Hash, class Eq>
+constexpr bool TRANSPARENT = requires {
+  typename Hash::is_transparent;
+  typename Eq::is_transparent;
+};
+
+// the key type lookups take; an alias straight to K stays deducible
+template <bool Transparent>
+struct KeyArg {
+  template <class K, class Key>
+  using type = Key;
+};
+
+template <>
+struct KeyArg<true> {
+  template <class K, class Key>
+  using type = K;
+};
+};  // namespace FlatHashMapDetail
+
+template <class Key, class Value, class Hash = std::hash<Key>,
+          class Eq = std::equal_to<Key>>
+class FlatHashMap {
+  // definitions
+ private:
+  struct Slot {
+    Key key_;
+    Value value_;
+  };
+
+  // the type lookups take a key as: any K for a transparent Hash and Eq
+  template <class K>
+  using key_arg = typename FlatHashMapDetail::KeyArg<
+      FlatHashMapDetail::TRANSPARENT<Hash, Eq>>::template type<K, Key>;
+
+  static constexpr size_t NPOS = SIZE_MAX;
+
+  // constructors & destructor
+ public:
+  FlatHashMap() = default;
+
+  explicit FlatHashMap(size_t size) { reserve(size); }
+
+  FlatHashMap(const FlatHashMap& oth) : hash_(oth.hash_), eq_(oth.eq_) {
+    if (oth.size_ == 0) return;
+    // same capacity, same layout: copy slot by slot
+    allocate(oth.capacity_, ctrl_, slots_);
+    capacity_ = oth.capacity_;
+    size_t built = 0;
+    try {
+      for (; built < capacity_; ++built) {
+        if (oth.ctrl_[built] == FlatHashMapDetail::EMPTY) continue;
+        ::new ((void*)(slots_ + built)) Slot(oth.slots_[built]);
+        set_ctrl(built, oth.ctrl_[built]);
+        ++size_;
+      }
+    } catch (...) {
+      destroy_all();
+      deallocate();
+      throw;
+    }
+  }
+
+  FlatHashMap(FlatHashMap&& old) noexcept { swap(old); }
+
+  ~FlatHashMap() {
+    destroy_all();
+    deallocate();
+  }
+
+  FlatHashMap& operator=(const FlatHashMap& oth) {
+    if (this != &oth) {
+      FlatHashMap tmp(oth);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  FlatHashMap& operator=(FlatHashMap&& old) noexcept {
+    if (this != &old) {
+      FlatHashMap tmp(std::move(old));
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  // public method
+ public:
+  bool empty() const { return size_ == 0; }
+
+  size_t size() const { return size_; }
+
+  size_t capacity() const { return capacity_; }
+
+  /**
+   * @brief
+   *
+   * insert key with a value constructed from args, unless key is present.
+   *
+   * @return std::pair<Value*, bool> the value of key, and whether it was
+   * inserted
+   */
+  template <class K, class... Args>
+  std::pair<Value*, bool> try_emplace(K&& key, Args&&... args) {
+    const uint64_t hash = hash_of(key);
+    const size_t idx = find_index(key, hash);
+    if (idx != NPOS) return {&slots_[idx].value_, false};
+    return {emplace_new(hash, std::forward<K>(key),
+                        std::forward<Args>(args)...),
+            true};
+  }
+
+  // insert (key, val) unless key is present; whether it was inserted
+  bool insert(const Key& key, const Value& val) {
+    return try_emplace(key, val).second;
+  }
+
+  bool insert(Key&& key, Value&& val) {
+    return try_emplace(std::move(key), std::move(val)).second;
+  }
+
+  // map key to val, whether key was present or not
+  template <class K, class V>
+  bool insert_or_assign(K&& key, V&& val) {
+    const uint64_t hash = hash_of(key);
+    const size_t idx = find_index(key, hash);
+    if (idx != NPOS) {
+      slots_[idx].value_ = std::forward<V>(val);
+      return false;
+    }
+    emplace_new(hash, std::forward<K>(key), std::forward<V>(val));
+    return true;
+  }
+
+  // the value of key, default-constructed first if key is absent
+  template <class K = Key>
+  Value& operator[](K&& key) {
+    return *try_emplace(std::forward<K>(key)).first;
+  }
+
+  // the value of key, or nullptr if key is absent
+  template <class K = Key>
+  Value* find(const key_arg<K>& key) {
+    const size_t idx = find_index(key, hash_of(key));
+    return idx == NPOS ? nullptr : &slots_[idx].value_;
+  }
+
+  template <class K = Key>
+  const Value* find(const key_arg<K>& key) const {
+    const size_t idx = find_index(key, hash_of(key));
+    return idx == NPOS ? nullptr : &slots_[idx].value_;
+  }
+
+  template <class K = Key>
+  bool contains(const key_arg<K>& key) const {
+    return find_index(key, hash_of(key)) != NPOS;
+  }
+
+  template <class K = Key>
+  Value& at(const key_arg<K>& key) {
+    Value* ret = find<K>(key);
+    assert((ret != nullptr) && "key not found in flat-hash-map");
+    return *ret;
+  }
+
+  template <class K = Key>
+  const Value& at(const key_arg<K>& key) const {
+    const Value* ret = find<K>(key);
+    assert((ret != nullptr) && "key not found in flat-hash-map");
+    return *ret;
+  }
+
+  // remove key; whether it was present
+  template <class K = Key>
+  bool erase(const key_arg<K>& key) {
+    const size_t idx = find_index(key, hash_of(key));
+    if (idx == NPOS) return false;
+    erase_at(idx);
+    return true;
+  }
+
+  // call fn(key, value) for every element, in no particular order
+  template <class F>
+  void for_each(F&& fn) {
+    for (size_t i = 0; i < capacity_; ++i)
+      if (ctrl_[i] != FlatHashMapDetail::EMPTY)
+        fn(static_cast<const Key&>(slots_[i].key_), slots_[i].value_);
+  }
+
+  template <class F>
+  void for_each(F&& fn) const {
+    for (size_t i = 0; i < capacity_; ++i)
+      if (ctrl_[i] != FlatHashMapDetail::EMPTY)
+        fn(slots_[i].key_, slots_[i].value_);
+  }
+
+  // remove every element, keeping the capacity
+  void clear() {
+    destroy_all();
+    if (capacity_)
+      memset(ctrl_, FlatHashMapDetail::EMPTY,
+             capacity_ + FlatHashMapDetail::GROUP);
+  }
+
+  // make room for size elements without rehashing
+  void reserve(size_t size) {
+    if (size > max_load(capacity_)) grow(size);
+  }
+
+  void swap(FlatHashMap& oth) noexcept {
+    std::swap(ctrl_, oth.ctrl_);
+    std::swap(slots_, oth.slots_);
+    std::swap(capacity_, oth.capacity_);
+    std::swap(size_, oth.size_);
+    std::swap(hash_, oth.hash_);
+    std::swap(eq_, oth.eq_);
+  }
+
+  // private method
+ private:
+  static size_t max_load(size_t capacity) {
+    return capacity / FlatHashMapDetail::MAX_LOAD_DEN *
+           FlatHashMapDetail::MAX_LOAD_NUM;
+  }
+
+  template <class K>
+  uint64_t hash_of(const K& key) const {
+    return FlatHashMapDetail::mix(hash_(key));
+  }
+
+  static size_t h1(uint64_t hash) { return (size_t)(hash >> 7); }
+
+  static int8_t h2(uint64_t hash) { return (int8_t)(hash & 0x7f); }
+
+  size_t home(const Key& key) const {
+    return h1(hash_of(key)) & (capacity_ - 1);
+  }
+
+  // write a control byte and its clone past the end
+  static void set_ctrl(int8_t* ctrl, size_t capacity, size_t idx,
+                       int8_t byte) {
+    ctrl[idx] = byte;
+    if (idx < FlatHashMapDetail::GROUP) ctrl[capacity + idx] = byte;
+  }
+
+  void set_ctrl(size_t idx, int8_t byte) {
+    set_ctrl(ctrl_, capacity_, idx, byte);
+  }
+
+  // the slot holding key, or NPOS
+  template <class K>
+  size_t find_index(const K& key, uint64_t hash) const {
+    using namespace FlatHashMapDetail;
+    if (capacity_ == 0) return NPOS;
+    const size_t mask = capacity_ - 1;
+    size_t pos = h1(hash) & mask;
+    while (1) {
+      const Group group(ctrl_ + pos);
+      uint32_t match = group.match(h2(hash));
+      const uint32_t empty = group.match_empty();
+      // the run of key ends at the first empty slot
+      if (empty) match &= (empty & (0u - empty)) - 1;
+      while (match) {
+        const size_t idx = (pos + std::countr_zero(match)) & mask;
+        if (eq_(slots_[idx].key_, key)) return idx;
+        match &= match - 1;
+      }
+      if (empty) return NPOS;
+      pos = (pos + GROUP) & mask;
+    }
+  }
+
+  // the first empty slot from the home of hash on
+  static size_t find_empty(const int8_t* ctrl, size_t capacity,
+                           uint64_t hash) {
+    using namespace FlatHashMapDetail;
+    const size_t mask = capacity - 1;
+    size_t pos = h1(hash) & mask;
+    while (1) {
+      const uint32_t empty = Group(ctrl + pos).match_empty();
+      if (empty) return (pos + std::countr_zero(empty)) & mask;
+      pos = (pos + GROUP) & mask;
+    }
+  }
+
+  size_t find_empty(uint64_t hash) const {
+    return find_empty(ctrl_, capacity_, hash);
+  }
+
+  /**
+   * @brief
+   *
+   * erase the element at idx and close the hole: walk the rest of the run
+   * and move back every element whose home is not after the hole.
+   */
+  void erase_at(size_t idx) {
+    const size_t mask = capacity_ - 1;
+    std::destroy_at(slots_ + idx);
+    set_ctrl(idx, FlatHashMapDetail::EMPTY);
+    --size_;
+    size_t hole = idx;
+    for (size_t cur = (idx + 1) & mask;
+         ctrl_[cur] != FlatHashMapDetail::EMPTY; cur = (cur + 1) & mask) {
+      const size_t from = home(slots_[cur].key_);
+      // from lies cyclically in (hole, cur]: the element must stay
+      if (((cur - from) & mask) < ((cur - hole) & mask)) continue;
+      ::new ((void*)(slots_ + hole)) Slot(std::move(slots_[cur]));
+      std::destroy_at(slots_ + cur);
+      set_ctrl(hole, ctrl_[cur]);
+      set_ctrl(cur, FlatHashMapDetail::EMPTY);
+      hole = cur;
+    }
+  }
+
+  /**
+   * @brief
+   *
+   * insert a key known to be absent, with a value constructed from args.
+   * The key and the value are built before the table grows: either may
+   * refer to an element that grow() moves and frees.
+   *
+   * @return Value* the inserted value
+   */
+  template <class K, class... Args>
+  Value* emplace_new(uint64_t hash, K&& key, Args&&... args) {
+    size_t idx;
+    if (size_ + 1 > max_load(capacity_)) {
+      Slot slot{Key(std::forward<K>(key)),
+                Value(std::forward<Args>(args)...)};
+      grow(size_ + 1);
+      idx = find_empty(hash);
+      ::new ((void*)(slots_ + idx)) Slot(std::move(slot));
+    } else {
+      idx = find_empty(hash);
+      ::new ((void*)(slots_ + idx))
+          Slot{Key(std::forward<K>(key)), Value(std::forward<Args>(args)...)};
+    }
+    set_ctrl(idx, h2(hash));
+    ++size_;
+    return &slots_[idx].value_;
+  }
+
+  /**
+   * @brief
+   *
+   * rehash into the smallest capacity that holds size elements. The new
+   * arrays are filled before they replace the old ones, so a failed
+   * allocation leaves the map as it was.
+   */
+  void grow(size_t size) {
+    size_t capacity = std::max(capacity_ * 2, FlatHashMapDetail::GROUP);
+    while (max_load(capacity) < size) capacity *= 2;
+
+    int8_t* ctrl;
+    Slot* slots;
+    allocate(capacity, ctrl, slots);
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] == FlatHashMapDetail::EMPTY) continue;
+      const uint64_t hash = hash_of(slots_[i].key_);
+      const size_t idx = find_empty(ctrl, capacity, hash);
+      ::new ((void*)(slots + idx)) Slot(std::move(slots_[i]));
+      std::destroy_at(slots_ + i);
+      set_ctrl(ctrl, capacity, idx, h2(hash));
+    }
+    std::swap(ctrl_, ctrl);
+    std::swap(slots_, slots);
+    std::swap(capacity_, capacity);
+    if (capacity) {
+      LinearListStorage::deallocate(ctrl, capacity + FlatHashMapDetail::GROUP);
+      LinearListStorage::deallocate(slots, capacity);
+    }
+  }
+
+  // fresh, empty arrays of capacity slots; nothing is kept if either fails
+  static void allocate(size_t capacity, int8_t*& ctrl, Slot*& slots) {
+    int8_t* new_ctrl = LinearListStorage::allocate<int8_t>(
+        capacity + FlatHashMapDetail::GROUP);
+    try {
+      slots = LinearListStorage::allocate<Slot>(capacity);
+    } catch (...) {
+      LinearListStorage::deallocate(new_ctrl,
+                                    capacity + FlatHashMapDetail::GROUP);
+      throw;
+    }
+    memset(new_ctrl, FlatHashMapDetail::EMPTY,
+           capacity + FlatHashMapDetail::GROUP);
+    ctrl = new_ctrl;
+  }
+
+  void deallocate() {
+    if (capacity_ == 0) return;
+    LinearListStorage::deallocate(ctrl_, capacity_ + FlatHashMapDetail::GROUP);
+    LinearListStorage::deallocate(slots_, capacity_);
+    ctrl_ = nullptr, slots_ = nullptr, capacity_ = 0;
+  }
+
+  void destroy_all() {
+    for (size_t i = 0; i < capacity_ && size_ > 0; ++i) {
+      if (ctrl_[i] == FlatHashMapDetail::EMPTY) continue;
+      std::destroy_at(slots_ + i);
+      --size_;
+    }
+    size_ = 0;
+  }
+
+  // members
+ private:
+  int8_t* ctrl_ = nullptr;
+  Slot* slots_ = nullptr;
+  // a power of two not less than GROUP, or 0
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+  [[no_unique_address]] Hash hash_;
+  [[no_unique_address]] Eq eq_;
+};
+
+#endif
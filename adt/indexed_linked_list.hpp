@@ -0,0 +1,272 @@
+/**
+ * @file indexed_linked_list.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-14
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines the indexed linked list data structure.
+ *
+ * IndexedLinkedList is the indexed mode of LinkedList: the nodes form a
+ * doubly linked list as usual, and an implicit treap (a randomized binary
+ * search tree ordered by position, with subtree sizes) is layered over the
+ * same nodes. Positional access, insertion and erasure take O(log n)
+ * expected time, while walking prior_/next_ stays O(1) per step.
+ *
+ * Memory cost per node: four pointers (prior_, next_, left_, right_), a
+ * 32-bit subtree size and a 32-bit priority, i.e. exactly 40 bytes plus
+ * sizeof(Ty), rounded up to the alignment of the node (48 bytes for an int,
+ * against 24 bytes in LinkedList). The list holds at most 2^32 - 1 nodes.
+ */
+
+#ifndef INDEXED_LINKED_LIST_HPP_
+#define INDEXED_LINKED_LIST_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+template <class Ty, class Alloc = std::allocator<Ty>>
+class IndexedLinkedList {
+  // definitions
+ public:
+  struct ListNode {
+    ListNode *prior_, *next_;
+    ListNode *left_, *right_;
+    uint32_t count_, priority_;
+    Ty value_;
+  };
+
+  using allocator_type = Alloc;
+
+ private:
+  using NodeAlloc = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<ListNode>;
+  using NodeTraits = std::allocator_traits<NodeAlloc>;
+
+  // constructors & destructor
+ public:
+  IndexedLinkedList() : IndexedLinkedList(Alloc()) {}
+
+  explicit IndexedLinkedList(const Alloc& alloc)
+      : head_(nullptr), tail_(nullptr), root_(nullptr), alloc_(alloc) {}
+
+  IndexedLinkedList(const IndexedLinkedList& oth)
+      : head_(nullptr),
+        tail_(nullptr),
+        root_(nullptr),
+        alloc_(NodeTraits::select_on_container_copy_construction(
+            oth.alloc_)) {
+    for (ListNode* cur = oth.head_; cur != nullptr; cur = cur->next_)
+      push_back(cur->value_);
+  }
+
+  IndexedLinkedList(IndexedLinkedList&& oth)
+      : head_(oth.head_),
+        tail_(oth.tail_),
+        root_(oth.root_),
+        seed_(oth.seed_),
+        alloc_(std::move(oth.alloc_)) {
+    oth.head_ = oth.tail_ = oth.root_ = nullptr;
+  }
+
+  ~IndexedLinkedList() {
+    ListNode* cur = head_;
+    while (cur != nullptr) {
+      ListNode* next = cur->next_;
+      dealloc(cur);
+      cur = next;
+    }
+    head_ = tail_ = root_ = nullptr;
+  }
+
+  IndexedLinkedList& operator=(const IndexedLinkedList& oth) {
+    if (this != &oth) {
+      IndexedLinkedList tmp(oth);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  IndexedLinkedList& operator=(IndexedLinkedList&& oth) {
+    if (this != &oth) {
+      IndexedLinkedList tmp(std::move(oth));
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  // public method
+ public:
+  size_t size() const { return count(root_); }
+
+  bool empty() const { return (root_ == nullptr); }
+
+  ListNode* first() const { return head_; }
+
+  ListNode* last() const { return tail_; }
+
+  Ty front() const { return head_->value_; }
+
+  Ty back() const { return tail_->value_; }
+
+  void swap(IndexedLinkedList& oth) {
+    std::swap(head_, oth.head_);
+    std::swap(tail_, oth.tail_);
+    std::swap(root_, oth.root_);
+    std::swap(seed_, oth.seed_);
+    std::swap(alloc_, oth.alloc_);
+  }
+
+  // the node at position idx, in O(log n)
+  ListNode* at(size_t idx) const {
+    assert((idx < size()) && "index out of range");
+    ListNode* cur = root_;
+    while (1) {
+      size_t left = count(cur->left_);
+      if (idx == left) return cur;
+      if (idx < left) {
+        cur = cur->left_;
+      } else {
+        idx -= left + 1;
+        cur = cur->right_;
+      }
+    }
+  }
+
+  /**
+   * @brief
+   *
+   * insert val so that it ends up at position idx, in O(log n).
+   *
+   * @return ListNode* the new node
+   */
+  ListNode* insert_at(size_t idx, const Ty& val) {
+    assert((idx <= size()) && "index out of range");
+    ListNode* node = alloc(val);
+    ListNode *l, *r;
+    split(root_, idx, l, r);
+
+    ListNode* prior = rightmost(l);
+    ListNode* next = leftmost(r);
+    node->prior_ = prior, node->next_ = next;
+    (prior ? prior->next_ : head_) = node;
+    (next ? next->prior_ : tail_) = node;
+
+    root_ = merge(merge(l, node), r);
+    return node;
+  }
+
+  // erase the node at position idx, in O(log n)
+  void erase_at(size_t idx) {
+    assert((idx < size()) && "index out of range");
+    ListNode *l, *mid, *r;
+    split(root_, idx, l, mid);
+    split(mid, 1, mid, r);
+    root_ = merge(l, r);
+
+    (mid->prior_ ? mid->prior_->next_ : head_) = mid->next_;
+    (mid->next_ ? mid->next_->prior_ : tail_) = mid->prior_;
+    dealloc(mid);
+  }
+
+  void push_back(const Ty& val) { insert_at(size(), val); }
+
+  void push_front(const Ty& val) { insert_at(0, val); }
+
+  void pop_back() {
+    assert((tail_ != nullptr) && "pop_back on an empty list");
+    erase_at(size() - 1);
+  }
+
+  void pop_front() {
+    assert((head_ != nullptr) && "pop_front on an empty list");
+    erase_at(0);
+  }
+
+  // private method
+ private:
+  static size_t count(ListNode* node) { return node ? node->count_ : 0; }
+
+  static void update(ListNode* node) {
+    node->count_ = (uint32_t)(count(node->left_) + count(node->right_) + 1);
+  }
+
+  static ListNode* leftmost(ListNode* node) {
+    if (node) while (node->left_) node = node->left_;
+    return node;
+  }
+
+  static ListNode* rightmost(ListNode* node) {
+    if (node) while (node->right_) node = node->right_;
+    return node;
+  }
+
+  // split the tree t into its first k nodes l and the rest r
+  static void split(ListNode* t, size_t k, ListNode*& l, ListNode*& r) {
+    if (t == nullptr) {
+      l = r = nullptr;
+      return;
+    }
+    if (count(t->left_) < k) {
+      split(t->right_, k - count(t->left_) - 1, t->right_, r);
+      l = t;
+    } else {
+      split(t->left_, k, l, t->left_);
+      r = t;
+    }
+    update(t);
+  }
+
+  // concatenate the trees l and r, keeping the heap order of priorities
+  static ListNode* merge(ListNode* l, ListNode* r) {
+    if (l == nullptr) return r;
+    if (r == nullptr) return l;
+    if (l->priority_ > r->priority_) {
+      l->right_ = merge(l->right_, r);
+      update(l);
+      return l;
+    }
+    r->left_ = merge(l, r->left_);
+    update(r);
+    return r;
+  }
+
+  uint32_t next_priority() {
+    // xorshift32
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+  }
+
+  ListNode* alloc(const Ty& value) {
+    assert((size() < UINT32_MAX) && "indexed linked list is full");
+    ListNode* ret = NodeTraits::allocate(alloc_, 1);
+    try {
+      NodeTraits::construct(alloc_, ret, nullptr, nullptr, nullptr, nullptr,
+                            1u, next_priority(), value);
+    } catch (...) {
+      NodeTraits::deallocate(alloc_, ret, 1);
+      throw;
+    }
+    return ret;
+  }
+
+  void dealloc(ListNode* node) {
+    NodeTraits::destroy(alloc_, node);
+    NodeTraits::deallocate(alloc_, node, 1);
+  }
+
+  // members
+ private:
+  ListNode *head_, *tail_, *root_;
+  uint32_t seed_ = 2463534242u;
+  [[no_unique_address]] NodeAlloc alloc_;
+};
+
+#endif
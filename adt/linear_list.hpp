@@ -14,71 +14,334 @@
 #ifndef LINEAR_LIST_HPP_
 #define LINEAR_LIST_HPP_
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
 #include <cstddef>
+#include <cstdlib>
 #include <cstring>
+#include <memory>
 #include <new>
+#include <type_traits>
+#include <utility>
 
+#if defined(__linux__)
+#define LINEAR_LIST_MREMAP_ 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief
+ *
+ * growth policies of LinearList.
+ *
+ * A growth policy is a type with a static member function
+ *
+ *   size_t calc_new_size(size_t oldsize, size_t required);
+ *
+ * which returns the new capacity when a list of capacity oldsize needs room
+ * for at least required elements. The result shall not be less than
+ * required.
+ */
 namespace LinearListPolicy {
 const static size_t LIST_INIT_SIZE = 10;
-const static size_t LIST_INCREMENT_INTERCEPT = 0;
-const static double LIST_INCREMENT_COEFFICIENT = 1.5;
-
-static size_t calc_new_size(size_t oldsize) {
-  if (oldsize == 0) return LIST_INIT_SIZE;
-  return std::max(oldsize,
-                  (size_t)(oldsize * LIST_INCREMENT_COEFFICIENT + 0.5) +
-                      LIST_INCREMENT_INTERCEPT);
-}
+
+// x1.5 growth, the default; a fair balance between copies and slack
+struct OneAndHalf {
+  static size_t calc_new_size(size_t oldsize, size_t required) {
+    if (oldsize == 0) return std::max(LIST_INIT_SIZE, required);
+    return std::max(required, oldsize + (oldsize + 1) / 2);
+  }
+};
+
+// doubling to the next power of two; fewest reallocations for hot buffers
+struct PowerOfTwo {
+  static size_t calc_new_size(size_t oldsize, size_t required) {
+    return std::bit_ceil(std::max({required, oldsize + 1, LIST_INIT_SIZE}));
+  }
+};
+
+// x1.618 growth; between OneAndHalf and PowerOfTwo
+struct GoldenRatio {
+  static size_t calc_new_size(size_t oldsize, size_t required) {
+    if (oldsize == 0) return std::max(LIST_INIT_SIZE, required);
+    // oldsize * 633 / 1024 ~ oldsize * 0.618, without overflowing
+    const size_t inc = (oldsize >> 10) * 633 + ((oldsize & 1023) * 633 >> 10);
+    return std::max(required, oldsize + std::max<size_t>(inc, 1));
+  }
+};
+
+// linear growth by Chunk elements; bounded slack for long-lived lists
+template <size_t Chunk>
+struct FixedChunk {
+  static_assert(Chunk > 0, "chunk size shall be positive");
+
+  static size_t calc_new_size(size_t oldsize, size_t required) {
+    return std::max(required, oldsize + Chunk);
+  }
+};
+
+// no slack at all; for lists whose final size is known up front
+struct ReserveExact {
+  static size_t calc_new_size(size_t, size_t required) { return required; }
+};
 };  // namespace LinearListPolicy
 
+/**
+ * @brief
+ *
+ * Ty is trivially relocatable if moving an object to a new address and
+ * forgetting the old one is equivalent to a memcpy. Trivially copyable types
+ * are; specialize this trait for types like std::unique_ptr that are too.
+ */
 template <typename Ty>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<Ty> {};
+
+/**
+ * @brief
+ *
+ * raw storage management of LinearList.
+ *
+ * Blocks of trivially relocatable types come from malloc and are resized by
+ * realloc, which may grow them in place. Once such a block reaches
+ * MMAP_THRESHOLD bytes it is backed by anonymous pages instead and resized by
+ * mremap, which moves page table entries rather than data: growing a
+ * multi-GB list neither copies it nor doubles the peak memory. The backend
+ * of a block is a function of its byte size alone, so no extra state is kept.
+ *
+ * Every other type gets a fresh block from ::operator new and has its
+ * elements move-constructed into it (copied if the move constructor may
+ * throw), and the old ones destroyed.
+ */
+namespace LinearListStorage {
+const static size_t MMAP_THRESHOLD = size_t(2) << 20;
+
+template <typename Ty>
+constexpr bool USE_REALLOC =
+    IsTriviallyRelocatable<Ty>::value &&
+    alignof(Ty) <= alignof(std::max_align_t);
+
+namespace detail {
+#ifdef LINEAR_LIST_MREMAP_
+inline bool is_mapped(size_t bytes) { return bytes >= MMAP_THRESHOLD; }
+
+inline size_t page_round(size_t bytes) {
+  static const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  return (bytes + page - 1) / page * page;
+}
+
+inline void* map(size_t bytes) {
+  void* ret = mmap(nullptr, page_round(bytes), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ret == MAP_FAILED) throw std::bad_alloc();
+  return ret;
+}
+#else
+inline bool is_mapped(size_t) { return false; }
+inline void* map(size_t) { return nullptr; }
+#endif
+
+inline void* heap(size_t bytes) {
+  void* ret = std::malloc(bytes);
+  if (ret == nullptr) throw std::bad_alloc();
+  return ret;
+}
+
+inline void release(void* content, size_t bytes) {
+#ifdef LINEAR_LIST_MREMAP_
+  if (is_mapped(bytes)) {
+    munmap(content, page_round(bytes));
+    return;
+  }
+#endif
+  std::free(content);
+}
+
+// resize a block of oldbytes, of which the first used bytes are live
+inline void* resize(void* content, size_t used, size_t oldbytes,
+                    size_t newbytes) {
+  if (content == nullptr)
+    return is_mapped(newbytes) ? map(newbytes) : heap(newbytes);
+#ifdef LINEAR_LIST_MREMAP_
+  if (is_mapped(oldbytes) && is_mapped(newbytes)) {
+    void* ret = mremap(content, page_round(oldbytes), page_round(newbytes),
+                       MREMAP_MAYMOVE);
+    if (ret == MAP_FAILED) throw std::bad_alloc();
+    return ret;
+  }
+#endif
+  if (is_mapped(oldbytes) || is_mapped(newbytes)) {
+    // crossing the threshold: one last copy between the two backends
+    void* ret = is_mapped(newbytes) ? map(newbytes) : heap(newbytes);
+    memcpy(ret, content, std::min(used, newbytes));
+    release(content, oldbytes);
+    return ret;
+  }
+  void* ret = std::realloc(content, newbytes);
+  if (ret == nullptr) throw std::bad_alloc();
+  return ret;
+}
+};  // namespace detail
+
+template <typename Ty>
+Ty* allocate(size_t size) {
+  if constexpr (USE_REALLOC<Ty>) {
+    return static_cast<Ty*>(detail::resize(nullptr, 0, 0, sizeof(Ty) * size));
+  } else {
+    return static_cast<Ty*>(
+        ::operator new(sizeof(Ty) * size, std::align_val_t(alignof(Ty))));
+  }
+}
+
+template <typename Ty>
+void deallocate(Ty* content, size_t size) {
+  if (content == nullptr) return;
+  if constexpr (USE_REALLOC<Ty>)
+    detail::release(content, sizeof(Ty) * size);
+  else
+    ::operator delete(content, std::align_val_t(alignof(Ty)));
+}
+
+/**
+ * @brief
+ *
+ * move the first len elements of content into a block of newsize elements.
+ * The old block is released and must not be used afterwards.
+ *
+ * @param content the old block, or nullptr
+ * @param len the number of live elements, not greater than newsize
+ * @param oldsize the capacity of the old block
+ * @param newsize the capacity of the new block, greater than zero
+ * @return Ty* the new block
+ */
+template <typename Ty>
+Ty* reallocate(Ty* content, size_t len, size_t oldsize, size_t newsize) {
+  if constexpr (USE_REALLOC<Ty>) {
+    return static_cast<Ty*>(detail::resize(content, sizeof(Ty) * len,
+                                           sizeof(Ty) * oldsize,
+                                           sizeof(Ty) * newsize));
+  } else {
+    Ty* ret = allocate<Ty>(newsize);
+    try {
+      if constexpr (std::is_nothrow_move_constructible_v<Ty> ||
+                    !std::is_copy_constructible_v<Ty>)
+        std::uninitialized_move(content, content + len, ret);
+      else
+        std::uninitialized_copy(content, content + len, ret);
+    } catch (...) {
+      deallocate(ret, newsize);
+      throw;
+    }
+    std::destroy(content, content + len);
+    deallocate(content, oldsize);
+    return ret;
+  }
+}
+};  // namespace LinearListStorage
+
+template <typename Ty, typename Growth = LinearListPolicy::OneAndHalf>
 class LinearList {
  public:
   LinearList() : content_(nullptr), len_(0), size_(0) {}
 
-  LinearList(const Ty* oth, size_t len) {
-    if (!len)
-      content_ = nullptr, len_ = size_ = 0;
-    else {
+  LinearList(const Ty* oth, size_t len) : content_(nullptr), len_(0), size_(0) {
+    if (len) {
       content_ = alloc(len);
-      assert((content_ != nullptr) && "bad linear-list copy construction");
-      memcpy(content_, oth, sizeof(Ty) * (size_ = len_ = len));
+      if constexpr (std::is_trivially_copyable_v<Ty>)
+        memcpy(content_, oth, sizeof(Ty) * len);
+      else {
+        try {
+          std::uninitialized_copy(oth, oth + len, content_);
+        } catch (...) {
+          dealloc(content_, len);
+          throw;
+        }
+      }
+      size_ = len_ = len;
     }
   }
 
   LinearList(const LinearList& oth) : LinearList(oth.content_, oth.len_) {}
 
-  LinearList(LinearList&& old) {
+  LinearList(LinearList&& old) noexcept {
     content_ = old.content_, old.content_ = nullptr;
     len_ = old.len_, old.len_ = 0;
     size_ = old.size_, old.size_ = 0;
   }
 
   ~LinearList() {
-    dealloc(content_);
+    clear();
+    dealloc(content_, size_);
     content_ = nullptr;
     size_ = len_ = 0;
   }
 
+  LinearList& operator=(const LinearList& oth) {
+    if (this != &oth) {
+      LinearList tmp(oth);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  LinearList& operator=(LinearList&& old) noexcept {
+    if (this != &old) {
+      LinearList tmp(std::move(old));
+      swap(tmp);
+    }
+    return *this;
+  }
+
  public:
   bool empty() const { return (len_ == 0); }
 
   size_t size() const { return len_; }
 
-  void push_back(const Ty& val) {
-    *get_next() = val;
-    len_++;
+  size_t capacity() const { return size_; }
+
+  void push_back(const Ty& val) { emplace_back(val); }
+
+  void push_back(Ty&& val) { emplace_back(std::move(val)); }
+
+  /**
+   * @brief
+   *
+   * construct an element in place at the end of the list.
+   *
+   * The arguments may refer to elements of the list itself: when the list
+   * has to grow, the element is constructed aside first and moved in after
+   * the reallocation.
+   */
+  template <typename... Args>
+  Ty& emplace_back(Args&&... args) {
+    if (len_ < size_) {
+      ::new ((void*)(content_ + len_)) Ty(std::forward<Args>(args)...);
+    } else {
+      Ty tmp(std::forward<Args>(args)...);
+      expand();
+      ::new ((void*)(content_ + len_)) Ty(std::move(tmp));
+    }
+    return content_[len_++];
   }
 
   void pop_back() {
     assert((len_ > 0) && "pop back on an empty linear-list");
-    len_--;
+    std::destroy_at(content_ + --len_);
+  }
+
+  void clear() {
+    std::destroy(content_, content_ + len_);
+    len_ = 0;
   }
 
-  Ty front() const { return content_[0]; }
+  Ty& front() { return content_[0]; }
+
+  const Ty& front() const { return content_[0]; }
+
+  Ty& back() { return content_[len_ - 1]; }
 
-  Ty back() const { return content_[len_ - 1]; }
+  const Ty& back() const { return content_[len_ - 1]; }
 
   Ty* first() const { return content_; }
 
@@ -88,35 +351,54 @@ class LinearList {
 
   Ty& operator[](size_t idx) { return content_[idx]; }
 
+  const Ty& operator[](size_t idx) const { return content_[idx]; }
+
+  /**
+   * @brief
+   *
+   * set the capacity of the list to exactly idx elements. Elements beyond
+   * the new capacity are destroyed.
+   */
   void resize(size_t idx) { __resize(idx); }
 
- private:
-  Ty* alloc(size_t size) { return ::operator new(sizeof(Ty) * size); }
+  // make room for at least size elements without further reallocation
+  void reserve(size_t size) {
+    if (size > size_) __resize(size);
+  }
 
-  void dealloc(Ty* content) {
-    if (content) ::operator delete(content);
+  // release the unused capacity
+  void shrink_to_fit() {
+    if (len_ < size_) __resize(len_);
   }
 
-  Ty* get_next() {
-    if (len_ >= size_) expand();
-    return (content_ + len_);
+  void swap(LinearList& oth) noexcept {
+    std::swap(content_, oth.content_);
+    std::swap(len_, oth.len_);
+    std::swap(size_, oth.size_);
   }
 
-  void expand() { __resize(LinearListPolicy::calc_new_size(size_)); }
+ private:
+  Ty* alloc(size_t size) { return LinearListStorage::allocate<Ty>(size); }
+
+  void dealloc(Ty* content, size_t size) {
+    LinearListStorage::deallocate(content, size);
+  }
+
+  void expand() { __resize(Growth::calc_new_size(size_, size_ + 1)); }
 
   void __resize(size_t newsize) {
+    if (newsize < len_) {
+      std::destroy(content_ + newsize, content_ + len_);
+      len_ = newsize;
+    }
     if (!newsize) {
-      dealloc(content_);
+      dealloc(content_, size_);
       content_ = nullptr, size_ = 0u, len_ = 0u;
       return;
     }
-    Ty* new_content = alloc(size_ = newsize);
-    assert((new_content != nullptr) && "linear-list expansion failed");
-    if (content_)
-      memcpy(new_content, content_,
-             sizeof(Ty) * (len_ = std::min(len_, size_)));
-    dealloc(content_);
-    content_ = new_content;
+    content_ =
+        LinearListStorage::reallocate(content_, len_, size_, newsize);
+    size_ = newsize;
   }
 
  private:
@@ -124,4 +406,4 @@ class LinearList {
   size_t len_, size_;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -18,8 +18,22 @@
 #include <cassert>
 #include <cstddef>
 #include <deque>
+#include <memory>
+#include <utility>
 
-template <class Ty>
+/**
+ * @brief
+ *
+ * a doubly linked list.
+ *
+ * Nodes are obtained from Alloc rebound to ListNode, so a pool allocator
+ * such as NodePool (adt/node_pool.hpp) keeps them adjacent and takes the
+ * global allocator off the push/pop path.
+ *
+ * @tparam Ty the value type
+ * @tparam Alloc the allocator
+ */
+template <class Ty, class Alloc = std::allocator<Ty>>
 class LinkedList {
   // definitions
  public:
@@ -28,42 +42,83 @@ class LinkedList {
     Ty value_;
   };
 
+  using allocator_type = Alloc;
+
+ private:
+  using NodeAlloc = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<ListNode>;
+  using NodeTraits = std::allocator_traits<NodeAlloc>;
+
   // constructors & destructor
  public:
-  LinkedList() {
+  LinkedList() : LinkedList(Alloc()) {}
+
+  explicit LinkedList(const Alloc& alloc) : alloc_(alloc) {
     head_ = tail_ = nullptr;
     size_ = 0;
   }
 
-  LinkedList(const LinkedList& oth) {
-    copy_period(head_, tail_, oth.head_, oth.tail_);
-    size_ = oth.size_;
+  LinkedList(const LinkedList& oth)
+      : alloc_(NodeTraits::select_on_container_copy_construction(
+            oth.alloc_)) {
+    head_ = tail_ = nullptr;
+    size_ = 0;
+    if (oth.head_ != nullptr) {
+      copy_period(head_, tail_, oth.head_, oth.tail_);
+      size_ = oth.size_;
+    }
   }
 
-  LinkedList(LinkedList&& oth) {
+  LinkedList(LinkedList&& oth) : alloc_(std::move(oth.alloc_)) {
     head_ = oth.head_, oth.head_ = nullptr;
     tail_ = oth.tail_, oth.tail_ = nullptr;
     size_ = oth.size_, oth.size_ = 0;
   }
 
   ~LinkedList() {
-    release_period(head_, tail_);
+    if (head_ != nullptr) release_period(head_, tail_);
     head_ = tail_ = nullptr;
     size_ = 0;
   }
 
+  LinkedList& operator=(const LinkedList& oth) {
+    if (this != &oth) {
+      LinkedList tmp(oth);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  LinkedList& operator=(LinkedList&& oth) {
+    if (this != &oth) {
+      LinkedList tmp(std::move(oth));
+      swap(tmp);
+    }
+    return *this;
+  }
+
   // public method
  public:
   int size() const { return size_; }
 
   bool empty() const { return (size_ == 0u); }
 
-  ListNode* first() const { return first_; }
+  ListNode* first() const { return head_; }
+
+  ListNode* last() const { return tail_; }
 
-  ListNode* last() const { return last_; }
+  allocator_type get_allocator() const { return allocator_type(alloc_); }
+
+  void swap(LinkedList& oth) {
+    std::swap(head_, oth.head_);
+    std::swap(tail_, oth.tail_);
+    std::swap(size_, oth.size_);
+    std::swap(alloc_, oth.alloc_);
+  }
 
+  // the node at position idx, in O(idx); see IndexedLinkedList for O(log n)
   ListNode* at(size_t idx) const {
-    ListNode* ret = first_;
+    ListNode* ret = head_;
     while (idx--) ret = ret->next_;
     return ret;
   }
@@ -127,21 +182,121 @@ class LinkedList {
   Ty front() const { return head_->value_; }
   Ty back() const { return tail_->value_; }
 
+  /**
+   * @brief
+   *
+   * move all nodes of oth before pos (nullptr for the end) in O(1). oth is
+   * left empty. Both lists shall use equal allocators.
+   */
+  void splice(ListNode* pos, LinkedList& oth) {
+    if (&oth == this || oth.head_ == nullptr) return;
+    splice(pos, oth, oth.head_, oth.tail_, oth.size_);
+  }
+
+  /**
+   * @brief
+   *
+   * move the nodes [head, tail] of oth before pos (nullptr for the end) in
+   * O(1). pos shall not lie in the moved range.
+   *
+   * @param count the number of nodes in [head, tail]
+   */
+  void splice(ListNode* pos, LinkedList& oth, ListNode* head, ListNode* tail,
+              size_t count) {
+    assert((alloc_ == oth.alloc_) && "splice between unequal allocators");
+    oth.unlink_period(head, tail);
+    oth.size_ -= count;
+    link_period(pos, head, tail);
+    size_ += count;
+  }
+
+  // move the nodes [head, tail] of oth before pos, counting them in O(count)
+  void splice(ListNode* pos, LinkedList& oth, ListNode* head,
+              ListNode* tail) {
+    size_t count = 1;
+    for (ListNode* cur = head; cur != tail; cur = cur->next_) count++;
+    splice(pos, oth, head, tail, count);
+  }
+
+  /**
+   * @brief
+   *
+   * cut the list before node and return the nodes [node, last()] as a new
+   * list, in O(1).
+   *
+   * @param count the number of nodes in [node, last()]
+   */
+  LinkedList split_at(ListNode* node, size_t count) {
+    LinkedList ret(get_allocator());
+    if (node != nullptr) ret.splice(nullptr, *this, node, tail_, count);
+    return ret;
+  }
+
+  // split_at, counting the moved nodes in O(count)
+  LinkedList split_at(ListNode* node) {
+    size_t count = 0;
+    for (ListNode* cur = node; cur != nullptr; cur = cur->next_) count++;
+    return split_at(node, count);
+  }
+
+  /**
+   * @brief
+   *
+   * merge the sorted list oth into this sorted list by relinking, leaving
+   * oth empty. The merge is stable and takes linear time.
+   *
+   * @param cmp the strict weak order both lists are sorted by
+   */
+  template <class Compare>
+  void merge(LinkedList& oth, Compare cmp) {
+    if (&oth == this || oth.head_ == nullptr) return;
+    assert((alloc_ == oth.alloc_) && "merge between unequal allocators");
+
+    ListNode* cur = head_;
+    while (oth.head_ != nullptr) {
+      while (cur != nullptr && !cmp(oth.head_->value_, cur->value_))
+        cur = cur->next_;
+      if (cur == nullptr) {
+        splice(nullptr, oth);
+        break;
+      }
+      // take the run of oth that sorts before cur in one relink
+      ListNode *run = oth.head_, *run_tail = run;
+      size_t count = 1;
+      while (run_tail->next_ != nullptr &&
+             cmp(run_tail->next_->value_, cur->value_))
+        run_tail = run_tail->next_, count++;
+      splice(cur, oth, run, run_tail, count);
+    }
+  }
+
+  void merge(LinkedList& oth) {
+    merge(oth, [](const Ty& a, const Ty& b) { return a < b; });
+  }
+
   void foo() {
     std::deque<int> Q;
     
   }
+
   // private method
  private:
   ListNode* alloc(const Ty& value) {
-    ListNode* ret = new ListNode;
-    ret->value_ = value;
-    ret->prior_ = ret->next_ = nullptr;
+    ListNode* ret = NodeTraits::allocate(alloc_, 1);
+    try {
+      NodeTraits::construct(alloc_, ret, nullptr, nullptr, value);
+    } catch (...) {
+      NodeTraits::deallocate(alloc_, ret, 1);
+      throw;
+    }
     return ret;
   }
 
   void dealloc(ListNode* node) {
-    if (node) delete node;
+    if (node) {
+      NodeTraits::destroy(alloc_, node);
+      NodeTraits::deallocate(alloc_, node, 1);
+    }
   }
 
   /**
@@ -160,6 +315,7 @@ class LinkedList {
       assert(0 && "chead or ctail is nullptr");
 
     ListNode *ctemp = chead, *rtemp = alloc(chead->value_);
+    rhead = rtemp;
     while (1) {
       if (ctemp == ctail) break;
 
@@ -172,6 +328,23 @@ class LinkedList {
         assert(0 && "chead and ctail are not in the same linklist");
       }
     }
+    rtail = rtemp;
+  }
+
+  // detach the nodes [head, tail] and join the two broken ends
+  void unlink_period(ListNode* head, ListNode* tail) {
+    (head->prior_ ? head->prior_->next_ : head_) = tail->next_;
+    (tail->next_ ? tail->next_->prior_ : tail_) = head->prior_;
+    head->prior_ = tail->next_ = nullptr;
+  }
+
+  // link the detached nodes [head, tail] before pos (nullptr for the end)
+  void link_period(ListNode* pos, ListNode* head, ListNode* tail) {
+    ListNode* prior = pos ? pos->prior_ : tail_;
+    head->prior_ = prior;
+    tail->next_ = pos;
+    (prior ? prior->next_ : head_) = head;
+    (pos ? pos->prior_ : tail_) = tail;
   }
 
   /**
@@ -205,6 +378,7 @@ class LinkedList {
  private:
   ListNode *head_, *tail_;
   size_t size_;
+  [[no_unique_address]] NodeAlloc alloc_;
 };
 
 #endif
\ No newline at end of file
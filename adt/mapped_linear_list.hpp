@@ -0,0 +1,287 @@
+/**
+ * @file mapped_linear_list.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-29
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines MappedLinearList, a LinearList of trivially copyable
+ * elements kept in a memory-mapped file.
+ *
+ * The file starts with a HEADER_BYTES header recording a magic number, the
+ * format version, sizeof(Ty), the length and the capacity of the list; the
+ * elements follow. The header lives in the mapping like the elements, so
+ * every change to the list is a change to the file, written back by the
+ * page cache. Reopening a file is an mmap: nothing is read until it is
+ * touched, and lists larger than memory are paged in and out by the OS.
+ *
+ * Growth extends the file with ftruncate and the mapping with mremap, which
+ * moves no data; without mremap the file is mapped anew. The capacity
+ * follows the Growth policy as in LinearList.
+ *
+ * open() reports a file it cannot use by returning false; failing to extend
+ * or remap the file throws std::bad_alloc like LinearList does. The file is
+ * extended sparsely, so a full disk surfaces as SIGBUS on first write to the
+ * new pages. Only POSIX systems are supported.
+ */
+
+#ifndef MAPPED_LINEAR_LIST_HPP_
+#define MAPPED_LINEAR_LIST_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "adt/linear_list.hpp"
+
+namespace MappedLinearListDetail {
+
+// "HYPLIST\0" in little endian
+const static uint64_t MAGIC = 0x005453494c505948ull;
+const static uint32_t VERSION = 1;
+const static size_t HEADER_BYTES = 64;
+
+struct Header {
+  uint64_t magic_;
+  uint32_t version_;
+  uint32_t elem_size_;
+  uint64_t len_;
+  uint64_t capacity_;
+};
+static_assert(sizeof(Header) <= HEADER_BYTES);
+
+};  // namespace MappedLinearListDetail
+
+template <typename Ty, typename Growth = LinearListPolicy::OneAndHalf>
+class MappedLinearList {
+  static_assert(std::is_trivially_copyable_v<Ty>,
+                "a mapped list holds trivially copyable elements only");
+  static_assert(alignof(Ty) <= MappedLinearListDetail::HEADER_BYTES,
+                "elements shall fit the alignment of the header");
+
+  using Header = MappedLinearListDetail::Header;
+
+  // constructors & destructor
+ public:
+  MappedLinearList() = default;
+
+  MappedLinearList(const MappedLinearList&) = delete;
+
+  MappedLinearList(MappedLinearList&& old) noexcept { swap(old); }
+
+  ~MappedLinearList() { close(); }
+
+  MappedLinearList& operator=(const MappedLinearList&) = delete;
+
+  MappedLinearList& operator=(MappedLinearList&& old) noexcept {
+    if (this != &old) {
+      MappedLinearList tmp(std::move(old));
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  // public method
+ public:
+  /**
+   * @brief
+   *
+   * map the list stored at path, closing the current one first. A missing
+   * or empty file is initialized as an empty list if create is set.
+   *
+   * @return bool false if the file cannot be opened or mapped, or holds a
+   * list of another format version or element size
+   */
+  bool open(const char* path, bool create = true) {
+    using namespace MappedLinearListDetail;
+    close();
+    int fd = ::open(path, create ? O_RDWR | O_CREAT : O_RDWR, 0644);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) return fail(fd);
+    size_t bytes = (size_t)st.st_size;
+    if (bytes == 0) {
+      if (!create) return fail(fd);
+      unsigned char block[HEADER_BYTES] = {};
+      const Header header{MAGIC, VERSION, (uint32_t)sizeof(Ty), 0, 0};
+      memcpy(block, &header, sizeof(Header));
+      if (pwrite(fd, block, HEADER_BYTES, 0) != (ssize_t)HEADER_BYTES)
+        return fail(fd);
+      bytes = HEADER_BYTES;
+    }
+    if (bytes < HEADER_BYTES) return fail(fd);
+
+    void* map =
+        mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) return fail(fd);
+    Header* header = static_cast<Header*>(map);
+    if (header->magic_ != MAGIC || header->version_ != VERSION ||
+        header->elem_size_ != sizeof(Ty) ||
+        header->len_ > header->capacity_ ||
+        header->capacity_ > (SIZE_MAX - HEADER_BYTES) / sizeof(Ty) ||
+        bytes < file_bytes(header->capacity_)) {
+      munmap(map, bytes);
+      return fail(fd);
+    }
+    fd_ = fd, header_ = header, bytes_ = bytes;
+    return true;
+  }
+
+  // unmap the list and close its file; the data stays in the file
+  void close() {
+    if (!is_open()) return;
+    munmap(header_, bytes_);
+    ::close(fd_);
+    fd_ = -1, header_ = nullptr, bytes_ = 0;
+  }
+
+  bool is_open() const { return header_ != nullptr; }
+
+  // write the list back to the file and wait for it; false on I/O error
+  bool sync() {
+    assert(is_open() && "sync of a closed mapped list");
+    return msync(header_, bytes_, MS_SYNC) == 0;
+  }
+
+  bool empty() const { return (size() == 0); }
+
+  size_t size() const { return is_open() ? header_->len_ : 0; }
+
+  size_t capacity() const { return is_open() ? header_->capacity_ : 0; }
+
+  void push_back(const Ty& val) { emplace_back(val); }
+
+  // the arguments may refer to elements of the list itself
+  template <typename... Args>
+  Ty& emplace_back(Args&&... args) {
+    assert(is_open() && "push back on a closed mapped list");
+    Ty tmp(std::forward<Args>(args)...);
+    if (header_->len_ == header_->capacity_) expand();
+    Ty* slot = first() + header_->len_;
+    ::new ((void*)slot) Ty(tmp);
+    ++header_->len_;
+    return *slot;
+  }
+
+  void pop_back() {
+    assert((size() > 0) && "pop back on an empty linear-list");
+    --header_->len_;
+  }
+
+  void clear() {
+    if (is_open()) header_->len_ = 0;
+  }
+
+  Ty& front() { return first()[0]; }
+
+  const Ty& front() const { return first()[0]; }
+
+  Ty& back() { return first()[size() - 1]; }
+
+  const Ty& back() const { return first()[size() - 1]; }
+
+  Ty* first() const {
+    return reinterpret_cast<Ty*>(reinterpret_cast<unsigned char*>(header_) +
+                                 MappedLinearListDetail::HEADER_BYTES);
+  }
+
+  Ty* last() const { return first() + (size() - 1); }
+
+  const Ty& at(size_t idx) const { return first()[idx]; }
+
+  Ty& operator[](size_t idx) { return first()[idx]; }
+
+  const Ty& operator[](size_t idx) const { return first()[idx]; }
+
+  /**
+   * @brief
+   *
+   * set the capacity of the list, and the size of its file, to exactly idx
+   * elements. Elements beyond the new capacity are dropped.
+   */
+  void resize(size_t idx) { __resize(idx); }
+
+  // make room for at least size elements without further remapping
+  void reserve(size_t size) {
+    if (size > capacity()) __resize(size);
+  }
+
+  // release the unused capacity, truncating the file
+  void shrink_to_fit() {
+    if (size() < capacity()) __resize(size());
+  }
+
+  void swap(MappedLinearList& oth) noexcept {
+    std::swap(fd_, oth.fd_);
+    std::swap(header_, oth.header_);
+    std::swap(bytes_, oth.bytes_);
+  }
+
+  // private method
+ private:
+  static bool fail(int fd) {
+    ::close(fd);
+    return false;
+  }
+
+  static size_t file_bytes(size_t capacity) {
+    return MappedLinearListDetail::HEADER_BYTES + sizeof(Ty) * capacity;
+  }
+
+  void expand() {
+    __resize(Growth::calc_new_size(header_->capacity_,
+                                   header_->capacity_ + 1));
+  }
+
+  void __resize(size_t newsize) {
+    assert(is_open() && "resize of a closed mapped list");
+    if (newsize < header_->len_) header_->len_ = newsize;
+    const size_t bytes = file_bytes(newsize);
+    if (bytes < bytes_) {
+      // unmap the end of the file before cutting it off; a file that cannot
+      // be truncated just keeps an unused tail
+      remap(bytes);
+      header_->capacity_ = newsize;
+      (void)!ftruncate(fd_, (off_t)bytes);
+      return;
+    }
+    if (ftruncate(fd_, (off_t)bytes) != 0) throw std::bad_alloc();
+    remap(bytes);
+    header_->capacity_ = newsize;
+  }
+
+  void remap(size_t bytes) {
+#ifdef LINEAR_LIST_MREMAP_
+    void* map = mremap(header_, bytes_, bytes, MREMAP_MAYMOVE);
+    if (map == MAP_FAILED) throw std::bad_alloc();
+#else
+    void* map =
+        mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) throw std::bad_alloc();
+    munmap(header_, bytes_);
+#endif
+    header_ = static_cast<Header*>(map);
+    bytes_ = bytes;
+  }
+
+  // members
+ private:
+  int fd_ = -1;
+  // the start of the mapping, or nullptr while closed
+  Header* header_ = nullptr;
+  size_t bytes_ = 0;
+};
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * @file node_pool.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-08
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines a slab allocator for node-based containers.
+ *
+ * NodePool carves single-object allocations out of contiguous chunks and
+ * recycles released slots through an intrusive free list, so nodes allocated
+ * together sit next to each other and steady-state insert/erase never calls
+ * malloc. Chunks are returned to the system only when the last allocator
+ * sharing the pool is destroyed.
+ *
+ * The pool is not thread-safe.
+ */
+
+#ifndef NODE_POOL_HPP_
+#define NODE_POOL_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "adt/linear_list.hpp"
+
+namespace NodePoolDetail {
+/**
+ * @brief
+ *
+ * the untyped pool shared by all copies and rebinds of a NodePool. Its slot
+ * size is fixed by the first allocation; requests of other sizes bypass it.
+ */
+class Pool {
+ public:
+  explicit Pool(size_t chunk_slots) : chunk_slots_(chunk_slots) {}
+
+  Pool(const Pool&) = delete;
+
+  ~Pool() {
+    for (size_t i = 0; i < chunks_.size(); ++i)
+      ::operator delete(chunks_[i], std::align_val_t(SLOT_ALIGN));
+  }
+
+ public:
+  const static size_t SLOT_ALIGN = alignof(std::max_align_t);
+
+  // whether an object of this size and alignment is served by the pool
+  bool serves(size_t size, size_t align) {
+    if (align > SLOT_ALIGN) return false;
+    if (slot_size_ == 0) slot_size_ = round_up(std::max(size, sizeof(Slot)));
+    return size <= slot_size_;
+  }
+
+  void* allocate() {
+    if (free_ != nullptr) {
+      Slot* ret = free_;
+      free_ = free_->next_;
+      return ret;
+    }
+    if (bump_ == bump_end_) grow();
+    void* ret = bump_;
+    bump_ += slot_size_;
+    return ret;
+  }
+
+  void deallocate(void* ptr) {
+    Slot* slot = static_cast<Slot*>(ptr);
+    slot->next_ = free_;
+    free_ = slot;
+  }
+
+  size_t chunks() const { return chunks_.size(); }
+
+ private:
+  struct Slot {
+    Slot* next_;
+  };
+
+  static size_t round_up(size_t size) {
+    return (size + SLOT_ALIGN - 1) / SLOT_ALIGN * SLOT_ALIGN;
+  }
+
+  void grow() {
+    void* chunk = ::operator new(slot_size_ * chunk_slots_,
+                                 std::align_val_t(SLOT_ALIGN));
+    chunks_.push_back(chunk);
+    bump_ = static_cast<unsigned char*>(chunk);
+    bump_end_ = bump_ + slot_size_ * chunk_slots_;
+  }
+
+ private:
+  size_t chunk_slots_, slot_size_ = 0;
+  Slot* free_ = nullptr;
+  unsigned char *bump_ = nullptr, *bump_end_ = nullptr;
+  LinearList<void*> chunks_;
+};
+};  // namespace NodePoolDetail
+
+/**
+ * @brief
+ *
+ * an allocator backed by a shared NodePoolDetail::Pool.
+ *
+ * Copies and rebinds share the pool, so a LinkedList<Ty, NodePool<Ty>>
+ * rebinding it to its node type still draws from the pool handed in, and
+ * several lists may share one pool. Allocations of more than one object are
+ * forwarded to ::operator new.
+ *
+ * @tparam Ty the value type
+ * @tparam ChunkSlots the number of slots carved from each chunk
+ */
+template <class Ty, size_t ChunkSlots = 256>
+class NodePool {
+ public:
+  using value_type = Ty;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  template <class U>
+  struct rebind {
+    using other = NodePool<U, ChunkSlots>;
+  };
+
+  template <class U, size_t C>
+  friend class NodePool;
+
+ public:
+  NodePool() : pool_(std::make_shared<NodePoolDetail::Pool>(ChunkSlots)) {}
+
+  NodePool(const NodePool&) = default;
+
+  // a moved-from allocator still equals its original, so moving copies
+  NodePool(NodePool&& oth) : pool_(oth.pool_) {}
+
+  NodePool& operator=(const NodePool&) = default;
+
+  template <class U>
+  NodePool(const NodePool<U, ChunkSlots>& oth) : pool_(oth.pool_) {}
+
+ public:
+  Ty* allocate(size_t n) {
+    if (n == 1 && pool_->serves(sizeof(Ty), alignof(Ty)))
+      return static_cast<Ty*>(pool_->allocate());
+    return static_cast<Ty*>(
+        ::operator new(sizeof(Ty) * n, std::align_val_t(alignof(Ty))));
+  }
+
+  void deallocate(Ty* ptr, size_t n) {
+    if (n == 1 && pool_->serves(sizeof(Ty), alignof(Ty)))
+      pool_->deallocate(ptr);
+    else
+      ::operator delete(ptr, std::align_val_t(alignof(Ty)));
+  }
+
+  // the number of chunks the pool has carved so far
+  size_t chunks() const { return pool_->chunks(); }
+
+  template <class U>
+  bool operator==(const NodePool<U, ChunkSlots>& oth) const {
+    return pool_ == oth.pool_;
+  }
+
+ private:
+  std::shared_ptr<NodePoolDetail::Pool> pool_;
+};
+
+#endif
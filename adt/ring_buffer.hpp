@@ -0,0 +1,290 @@
+/**
+ * @file ring_buffer.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines bounded concurrent ring buffers.
+ *
+ * Both buffers keep their slots in a LinearList reserved once at
+ * construction, with the capacity rounded up to a power of two. The head and
+ * tail indices live on separate cache lines so that producers and consumers
+ * do not false-share.
+ *
+ * SpscRingBuffer is wait-free for one producer and one consumer thread.
+ * MpmcRingBuffer is lock-free for any number of both (Vyukov's bounded queue:
+ * each slot carries a sequence number telling whose turn it is).
+ *
+ * Ty shall be default constructible and move assignable; slots hold live
+ * objects which push assigns to and pop moves from.
+ */
+
+#ifndef RING_BUFFER_HPP_
+#define RING_BUFFER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "adt/linear_list.hpp"
+#include "concurrency/cache_line.hpp"
+
+template <class Ty>
+class SpscRingBuffer {
+ public:
+  explicit SpscRingBuffer(size_t capacity)
+      : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1) {
+    slots_.reserve(mask_ + 1);
+    for (size_t i = 0; i <= mask_; ++i) slots_.emplace_back();
+    head_.value_.store(0, std::memory_order_relaxed);
+    tail_.value_.store(0, std::memory_order_relaxed);
+  }
+
+  SpscRingBuffer(const SpscRingBuffer&) = delete;
+
+ public:
+  size_t capacity() const { return mask_ + 1; }
+
+  // the number of queued elements; exact only when both sides are idle
+  size_t size() const {
+    return tail_.value_.load(std::memory_order_acquire) -
+           head_.value_.load(std::memory_order_acquire);
+  }
+
+  // producer side
+
+  template <class Val>
+  bool try_push(Val&& val) {
+    const size_t tail = tail_.value_.load(std::memory_order_relaxed);
+    if (tail - cached_head_.value_ > mask_) {
+      cached_head_.value_ = head_.value_.load(std::memory_order_acquire);
+      if (tail - cached_head_.value_ > mask_) return false;
+    }
+    slots_[tail & mask_] = std::forward<Val>(val);
+    tail_.value_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief
+   *
+   * push up to n elements with a single publication.
+   *
+   * @return size_t the number of elements pushed
+   */
+  size_t push_batch(const Ty* vals, size_t n) {
+    const size_t tail = tail_.value_.load(std::memory_order_relaxed);
+    size_t room = capacity() - (tail - cached_head_.value_);
+    if (room < n) {
+      cached_head_.value_ = head_.value_.load(std::memory_order_acquire);
+      room = capacity() - (tail - cached_head_.value_);
+    }
+    n = std::min(n, room);
+    for (size_t i = 0; i < n; ++i) slots_[(tail + i) & mask_] = vals[i];
+    tail_.value_.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  // consumer side
+
+  bool try_pop(Ty& out) {
+    const size_t head = head_.value_.load(std::memory_order_relaxed);
+    if (head == cached_tail_.value_) {
+      cached_tail_.value_ = tail_.value_.load(std::memory_order_acquire);
+      if (head == cached_tail_.value_) return false;
+    }
+    out = std::move(slots_[head & mask_]);
+    head_.value_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief
+   *
+   * pop up to n elements with a single release of their slots.
+   *
+   * @return size_t the number of elements popped
+   */
+  size_t pop_batch(Ty* out, size_t n) {
+    const size_t head = head_.value_.load(std::memory_order_relaxed);
+    if (cached_tail_.value_ - head < n)
+      cached_tail_.value_ = tail_.value_.load(std::memory_order_acquire);
+    n = std::min(n, cached_tail_.value_ - head);
+    for (size_t i = 0; i < n; ++i)
+      out[i] = std::move(slots_[(head + i) & mask_]);
+    head_.value_.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+ private:
+  const size_t mask_;
+  LinearList<Ty> slots_;
+  // written by the consumer
+  CacheLinePadded<std::atomic<size_t>> head_;
+  // written by the producer
+  CacheLinePadded<std::atomic<size_t>> tail_;
+  // the producer's last view of head_, and the consumer's of tail_
+  CacheLinePadded<size_t> cached_head_{0}, cached_tail_{0};
+};
+
+template <class Ty>
+class MpmcRingBuffer {
+ private:
+  struct Cell {
+    std::atomic<size_t> seq_;
+    Ty value_;
+
+    Cell() = default;
+
+    // only needed to satisfy LinearList; cells never move after reserve()
+    Cell(Cell&& oth) noexcept
+        : seq_(oth.seq_.load(std::memory_order_relaxed)),
+          value_(std::move(oth.value_)) {}
+  };
+
+ public:
+  explicit MpmcRingBuffer(size_t capacity)
+      : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1) {
+    cells_.reserve(mask_ + 1);
+    for (size_t i = 0; i <= mask_; ++i)
+      cells_.emplace_back().seq_.store(i, std::memory_order_relaxed);
+    enqueue_pos_.value_.store(0, std::memory_order_relaxed);
+    dequeue_pos_.value_.store(0, std::memory_order_relaxed);
+  }
+
+  MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+
+ public:
+  size_t capacity() const { return mask_ + 1; }
+
+  template <class Val>
+  bool try_push(Val&& val) {
+    size_t pos = enqueue_pos_.value_.load(std::memory_order_relaxed);
+    while (1) {
+      Cell& cell = cells_[pos & mask_];
+      const size_t seq = cell.seq_.load(std::memory_order_acquire);
+      const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+      if (diff == 0) {
+        if (enqueue_pos_.value_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          cell.value_ = std::forward<Val>(val);
+          cell.seq_.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // the slot still holds the element of the previous lap: full
+        return false;
+      } else {
+        pos = enqueue_pos_.value_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * @brief
+   *
+   * push up to n elements, claiming the run of free slots found at the tail
+   * with a single CAS.
+   *
+   * @return size_t the number of elements pushed
+   */
+  size_t push_batch(const Ty* vals, size_t n) {
+    size_t pos = enqueue_pos_.value_.load(std::memory_order_relaxed);
+    size_t m;
+    while (1) {
+      m = 0;
+      while (m < n && cells_[(pos + m) & mask_].seq_.load(
+                          std::memory_order_acquire) == pos + m)
+        m++;
+      if (m == 0) {
+        // either full or another producer moved on; re-check once
+        const size_t cur =
+            enqueue_pos_.value_.load(std::memory_order_relaxed);
+        if (cur == pos) return 0;
+        pos = cur;
+        continue;
+      }
+      // slots found free stay free until enqueue_pos_ passes them
+      if (enqueue_pos_.value_.compare_exchange_weak(
+              pos, pos + m, std::memory_order_relaxed))
+        break;
+    }
+    for (size_t i = 0; i < m; ++i) {
+      Cell& cell = cells_[(pos + i) & mask_];
+      cell.value_ = vals[i];
+      cell.seq_.store(pos + i + 1, std::memory_order_release);
+    }
+    return m;
+  }
+
+  bool try_pop(Ty& out) {
+    size_t pos = dequeue_pos_.value_.load(std::memory_order_relaxed);
+    while (1) {
+      Cell& cell = cells_[pos & mask_];
+      const size_t seq = cell.seq_.load(std::memory_order_acquire);
+      const intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.value_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          out = std::move(cell.value_);
+          cell.seq_.store(pos + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // the slot has not been filled in this lap: empty
+        return false;
+      } else {
+        pos = dequeue_pos_.value_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * @brief
+   *
+   * pop up to n elements, claiming the run of filled slots found at the head
+   * with a single CAS.
+   *
+   * @return size_t the number of elements popped
+   */
+  size_t pop_batch(Ty* out, size_t n) {
+    size_t pos = dequeue_pos_.value_.load(std::memory_order_relaxed);
+    size_t m;
+    while (1) {
+      m = 0;
+      while (m < n && cells_[(pos + m) & mask_].seq_.load(
+                          std::memory_order_acquire) == pos + m + 1)
+        m++;
+      if (m == 0) {
+        const size_t cur =
+            dequeue_pos_.value_.load(std::memory_order_relaxed);
+        if (cur == pos) return 0;
+        pos = cur;
+        continue;
+      }
+      if (dequeue_pos_.value_.compare_exchange_weak(
+              pos, pos + m, std::memory_order_relaxed))
+        break;
+    }
+    for (size_t i = 0; i < m; ++i) {
+      Cell& cell = cells_[(pos + i) & mask_];
+      out[i] = std::move(cell.value_);
+      cell.seq_.store(pos + i + mask_ + 1, std::memory_order_release);
+    }
+    return m;
+  }
+
+ private:
+  const size_t mask_;
+  LinearList<Cell> cells_;
+  CacheLinePadded<std::atomic<size_t>> enqueue_pos_;
+  CacheLinePadded<std::atomic<size_t>> dequeue_pos_;
+};
+
+#endif
@@ -0,0 +1,270 @@
+/**
+ * @file small_linear_list.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-28
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines SmallLinearList, a LinearList with room for N elements
+ * inside the object itself.
+ *
+ * Up to N elements live in the inline buffer, so a short list costs no
+ * allocation and no pointer chase to a separate block. The first push beyond
+ * N moves the elements to a heap block of Growth::calc_new_size(N, N + 1)
+ * elements, managed by LinearListStorage exactly like a LinearList's; the
+ * capacity never drops below N, and shrinking to N or less moves the
+ * elements back inline.
+ *
+ * Moving a list whose elements are inline moves the elements one by one, so
+ * unlike LinearList, moves and swaps are O(N) and noexcept only if moving
+ * Ty is. Pointers to the elements are invalidated by moves as well.
+ */
+
+#ifndef SMALL_LINEAR_LIST_HPP_
+#define SMALL_LINEAR_LIST_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "adt/linear_list.hpp"
+
+template <typename Ty, size_t N,
+          typename Growth = LinearListPolicy::OneAndHalf>
+class SmallLinearList {
+  static_assert(N > 0, "inline capacity shall be positive");
+
+  static constexpr bool NOTHROW_RELOCATE =
+      IsTriviallyRelocatable<Ty>::value ||
+      std::is_nothrow_move_constructible_v<Ty>;
+
+ public:
+  static constexpr size_t INLINE_CAPACITY = N;
+
+  // constructors & destructor
+ public:
+  SmallLinearList() : content_(buffer()), len_(0), size_(N) {}
+
+  SmallLinearList(const Ty* oth, size_t len) : SmallLinearList() {
+    reserve(len);
+    if constexpr (std::is_trivially_copyable_v<Ty>) {
+      if (len) memcpy(content_, oth, sizeof(Ty) * len);
+    } else {
+      std::uninitialized_copy(oth, oth + len, content_);
+    }
+    len_ = len;
+  }
+
+  SmallLinearList(const SmallLinearList& oth)
+      : SmallLinearList(oth.content_, oth.len_) {}
+
+  SmallLinearList(SmallLinearList&& old) noexcept(NOTHROW_RELOCATE)
+      : SmallLinearList() {
+    steal(old);
+  }
+
+  ~SmallLinearList() {
+    clear();
+    if (!inlined()) dealloc(content_, size_);
+  }
+
+  SmallLinearList& operator=(const SmallLinearList& oth) {
+    if (this != &oth) {
+      SmallLinearList tmp(oth);
+      *this = std::move(tmp);
+    }
+    return *this;
+  }
+
+  SmallLinearList& operator=(SmallLinearList&& old) noexcept(
+      NOTHROW_RELOCATE) {
+    if (this != &old) {
+      clear();
+      if (!inlined()) {
+        dealloc(content_, size_);
+        content_ = buffer(), size_ = N;
+      }
+      steal(old);
+    }
+    return *this;
+  }
+
+  // public method
+ public:
+  bool empty() const { return (len_ == 0); }
+
+  size_t size() const { return len_; }
+
+  size_t capacity() const { return size_; }
+
+  // whether the elements live in the inline buffer
+  bool inlined() const { return content_ == buffer(); }
+
+  void push_back(const Ty& val) { emplace_back(val); }
+
+  void push_back(Ty&& val) { emplace_back(std::move(val)); }
+
+  /**
+   * @brief
+   *
+   * construct an element in place at the end of the list. As with
+   * LinearList, the arguments may refer to elements of the list itself.
+   */
+  template <typename... Args>
+  Ty& emplace_back(Args&&... args) {
+    if (len_ < size_) {
+      ::new ((void*)(content_ + len_)) Ty(std::forward<Args>(args)...);
+    } else {
+      Ty tmp(std::forward<Args>(args)...);
+      expand();
+      ::new ((void*)(content_ + len_)) Ty(std::move(tmp));
+    }
+    return content_[len_++];
+  }
+
+  void pop_back() {
+    assert((len_ > 0) && "pop back on an empty linear-list");
+    std::destroy_at(content_ + --len_);
+  }
+
+  void clear() {
+    std::destroy(content_, content_ + len_);
+    len_ = 0;
+  }
+
+  Ty& front() { return content_[0]; }
+
+  const Ty& front() const { return content_[0]; }
+
+  Ty& back() { return content_[len_ - 1]; }
+
+  const Ty& back() const { return content_[len_ - 1]; }
+
+  Ty* first() const { return content_; }
+
+  Ty* last() const { return content_ + (len_ - 1); }
+
+  const Ty& at(size_t idx) const { return content_[idx]; }
+
+  Ty& operator[](size_t idx) { return content_[idx]; }
+
+  const Ty& operator[](size_t idx) const { return content_[idx]; }
+
+  /**
+   * @brief
+   *
+   * set the capacity of the list to idx elements, or to N if idx is less.
+   * Elements beyond idx are destroyed.
+   */
+  void resize(size_t idx) { __resize(idx); }
+
+  // make room for at least size elements without further reallocation
+  void reserve(size_t size) {
+    if (size > size_) __resize(size);
+  }
+
+  // release the unused capacity, moving the elements inline if they fit
+  void shrink_to_fit() {
+    if (len_ < size_) __resize(len_);
+  }
+
+  void swap(SmallLinearList& oth) noexcept(NOTHROW_RELOCATE) {
+    if (!inlined() && !oth.inlined()) {
+      std::swap(content_, oth.content_);
+      std::swap(len_, oth.len_);
+      std::swap(size_, oth.size_);
+      return;
+    }
+    SmallLinearList tmp(std::move(oth));
+    oth = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  // private method
+ private:
+  Ty* buffer() const {
+    return reinterpret_cast<Ty*>(const_cast<unsigned char*>(inline_));
+  }
+
+  void dealloc(Ty* content, size_t size) {
+    LinearListStorage::deallocate(content, size);
+  }
+
+  /**
+   * @brief
+   *
+   * move len elements from src to the uninitialized dst and end the lifetime
+   * of the originals. If a copy throws, dst holds nothing and src is intact.
+   */
+  static void relocate(Ty* src, size_t len, Ty* dst) {
+    if constexpr (IsTriviallyRelocatable<Ty>::value) {
+      if (len) memcpy((void*)dst, (const void*)src, sizeof(Ty) * len);
+    } else {
+      if constexpr (std::is_nothrow_move_constructible_v<Ty> ||
+                    !std::is_copy_constructible_v<Ty>)
+        std::uninitialized_move(src, src + len, dst);
+      else
+        std::uninitialized_copy(src, src + len, dst);
+      std::destroy(src, src + len);
+    }
+  }
+
+  // take the elements of old, leaving it empty and inline; *this is so too
+  void steal(SmallLinearList& old) {
+    if (old.inlined()) {
+      relocate(old.content_, old.len_, content_);
+      len_ = old.len_, old.len_ = 0;
+      return;
+    }
+    content_ = old.content_, old.content_ = old.buffer();
+    len_ = old.len_, old.len_ = 0;
+    size_ = old.size_, old.size_ = N;
+  }
+
+  void expand() { __resize(Growth::calc_new_size(size_, size_ + 1)); }
+
+  void __resize(size_t newsize) {
+    if (newsize < len_) {
+      std::destroy(content_ + newsize, content_ + len_);
+      len_ = newsize;
+    }
+    newsize = std::max(newsize, N);
+    if (newsize == size_) return;
+
+    if (newsize == N) {
+      // back into the inline buffer
+      relocate(content_, len_, buffer());
+      dealloc(content_, size_);
+      content_ = buffer();
+    } else if (inlined()) {
+      // spill to the heap
+      Ty* block = LinearListStorage::allocate<Ty>(newsize);
+      try {
+        relocate(content_, len_, block);
+      } catch (...) {
+        dealloc(block, newsize);
+        throw;
+      }
+      content_ = block;
+    } else {
+      content_ =
+          LinearListStorage::reallocate(content_, len_, size_, newsize);
+    }
+    size_ = newsize;
+  }
+
+  // members
+ private:
+  Ty* content_;
+  size_t len_, size_;
+  alignas(Ty) unsigned char inline_[sizeof(Ty) * N];
+};
+
+#endif
@@ -0,0 +1,188 @@
+/**
+ * @file soa_list.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-30
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines SoaList, a structure-of-arrays companion to LinearList.
+ *
+ * SoaList<Fields...> stores a list of records, each made of one value per
+ * field type, as one LinearList column per field. A loop over one field
+ * then streams a dense array, which uses every byte of the cache lines it
+ * loads and vectorizes; column<I>() hands it out as a std::span:
+ *
+ *   SoaList<float, float, uint32_t> particles;   // x, y, id
+ *   for (float& x : particles.column<0>()) x += 1.0f;
+ *
+ * A record is accessed through a proxy, a std::tuple of references to its
+ * fields, which supports std::get, structured bindings and assignment from
+ * a tuple of values:
+ *
+ *   auto [x, y, id] = particles[i];     // references into the columns
+ *   particles[j] = particles.value(i);  // copy record i over record j
+ *
+ * All columns always have the same length. push_back is strongly exception
+ * safe: if one column throws, the fields already appended are removed.
+ */
+
+#ifndef SOA_LIST_HPP_
+#define SOA_LIST_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "adt/linear_list.hpp"
+
+template <typename... Fields>
+class SoaList {
+  static_assert(sizeof...(Fields) > 0, "a record needs at least one field");
+
+  static constexpr size_t FIELDS = sizeof...(Fields);
+  using Indices = std::make_index_sequence<FIELDS>;
+
+ public:
+  template <size_t I>
+  using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+  using value_type = std::tuple<Fields...>;
+  using reference = std::tuple<Fields&...>;
+  using const_reference = std::tuple<const Fields&...>;
+
+  // constructors & destructor
+ public:
+  SoaList() = default;
+
+  SoaList(const SoaList&) = default;
+
+  SoaList(SoaList&&) noexcept = default;
+
+  ~SoaList() = default;
+
+  SoaList& operator=(const SoaList&) = default;
+
+  SoaList& operator=(SoaList&&) noexcept = default;
+
+  // public method
+ public:
+  bool empty() const { return size() == 0; }
+
+  size_t size() const { return std::get<0>(columns_).size(); }
+
+  size_t capacity() const { return std::get<0>(columns_).capacity(); }
+
+  /**
+   * @brief
+   *
+   * append a record whose I-th field is constructed from the I-th argument.
+   */
+  template <typename... Args>
+  void emplace_back(Args&&... args) {
+    static_assert(sizeof...(Args) == FIELDS, "one argument per field");
+    emplace_back_impl(Indices(), std::forward<Args>(args)...);
+  }
+
+  void push_back(const value_type& val) {
+    std::apply([this](const Fields&... f) { emplace_back(f...); }, val);
+  }
+
+  void push_back(value_type&& val) {
+    std::apply([this](Fields&... f) { emplace_back(std::move(f)...); }, val);
+  }
+
+  void pop_back() {
+    assert((size() > 0) && "pop back on an empty soa-list");
+    std::apply([](auto&... col) { (col.pop_back(), ...); }, columns_);
+  }
+
+  void clear() {
+    std::apply([](auto&... col) { (col.clear(), ...); }, columns_);
+  }
+
+  // make room for at least size records in every column
+  void reserve(size_t size) {
+    std::apply([size](auto&... col) { (col.reserve(size), ...); }, columns_);
+  }
+
+  void shrink_to_fit() {
+    std::apply([](auto&... col) { (col.shrink_to_fit(), ...); }, columns_);
+  }
+
+  reference operator[](size_t idx) {
+    return record<reference>(columns_, idx, Indices());
+  }
+
+  const_reference operator[](size_t idx) const {
+    return record<const_reference>(columns_, idx, Indices());
+  }
+
+  const_reference at(size_t idx) const { return (*this)[idx]; }
+
+  reference front() { return (*this)[0]; }
+
+  const_reference front() const { return (*this)[0]; }
+
+  reference back() { return (*this)[size() - 1]; }
+
+  const_reference back() const { return (*this)[size() - 1]; }
+
+  // a copy of record idx
+  value_type value(size_t idx) const {
+    return record<value_type>(columns_, idx, Indices());
+  }
+
+  // the I-th field of every record, contiguous
+  template <size_t I>
+  std::span<field_type<I>> column() {
+    auto& col = std::get<I>(columns_);
+    return std::span<field_type<I>>(col.first(), col.size());
+  }
+
+  template <size_t I>
+  std::span<const field_type<I>> column() const {
+    const auto& col = std::get<I>(columns_);
+    return std::span<const field_type<I>>(col.first(), col.size());
+  }
+
+  void swap(SoaList& oth) noexcept { swap_impl(oth, Indices()); }
+
+  // private method
+ private:
+  template <size_t... I, typename... Args>
+  void emplace_back_impl(std::index_sequence<I...>, Args&&... args) {
+    size_t done = 0;
+    try {
+      ((std::get<I>(columns_).emplace_back(std::forward<Args>(args)),
+        ++done),
+       ...);
+    } catch (...) {
+      // the first done columns got their field: take it back
+      ((I < done ? std::get<I>(columns_).pop_back() : void()), ...);
+      throw;
+    }
+  }
+
+  // Record built from the fields of record idx in columns
+  template <typename Record, typename Columns, size_t... I>
+  static Record record(Columns& columns, size_t idx,
+                       std::index_sequence<I...>) {
+    return Record(std::get<I>(columns)[idx]...);
+  }
+
+  template <size_t... I>
+  void swap_impl(SoaList& oth, std::index_sequence<I...>) noexcept {
+    (std::get<I>(columns_).swap(std::get<I>(oth.columns_)), ...);
+  }
+
+  // members
+ private:
+  std::tuple<LinearList<Fields>...> columns_;
+};
+
+#endif
@@ -0,0 +1,438 @@
+/**
+ * @file unrolled_list.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines the unrolled linked list data structure.
+ *
+ * An unrolled list is a doubly linked list of chunks, each holding up to
+ * CAPACITY elements in a contiguous slot array. A chunk is sized to
+ * NodeBytes (one cache line by default) unless that would hold fewer than 4
+ * elements, so for small elements the pointer overhead is paid once per chunk
+ * instead of once per element and traversal walks contiguous memory.
+ *
+ * Pushing and popping at both ends is O(1). Inserting or erasing in the
+ * middle shifts at most half a chunk and may split a full chunk or merge two
+ * sparse ones, so it is O(CAPACITY). Splicing a whole list in is O(CAPACITY)
+ * for splitting the chunk at the insertion point.
+ *
+ * Insertion and erasure invalidate the iterators into the chunks they touch.
+ */
+
+#ifndef UNROLLED_LIST_HPP_
+#define UNROLLED_LIST_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <class Ty, size_t NodeBytes = 64>
+class UnrolledList {
+  // definitions
+ private:
+  struct ChunkHeader {
+    ChunkHeader *prior_, *next_;
+    uint16_t begin_, end_;
+  };
+
+ public:
+  // the number of elements a chunk holds; at least 4, so that a chunk of
+  // large elements outgrows NodeBytes rather than degrading into a list
+  static constexpr size_t CAPACITY = std::max<size_t>(
+      4, (NodeBytes - sizeof(ChunkHeader)) / sizeof(Ty));
+
+  static_assert(CAPACITY < UINT16_MAX, "chunk too large");
+
+  // aligned to a cache line, so that a chunk of NodeBytes = 64 is one line
+  struct alignas(64) Chunk {
+    Chunk *prior_, *next_;
+    // live elements occupy slots [begin_, end_)
+    uint16_t begin_, end_;
+    alignas(Ty) unsigned char slots_[CAPACITY * sizeof(Ty)];
+
+    size_t count() const { return end_ - begin_; }
+
+    Ty* slot(size_t idx) {
+      return std::launder(reinterpret_cast<Ty*>(slots_) + idx);
+    }
+  };
+
+  // a chunk of small elements takes exactly NodeBytes
+  static_assert(NodeBytes % 64 != 0 || alignof(Ty) > alignof(ChunkHeader) ||
+                    CAPACITY * sizeof(Ty) + sizeof(ChunkHeader) > NodeBytes ||
+                    sizeof(Chunk) == NodeBytes,
+                "chunk does not fit its node");
+
+  template <bool Const>
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Ty;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const Ty*, Ty*>;
+    using reference = std::conditional_t<Const, const Ty&, Ty&>;
+
+    Iterator() = default;
+
+    Iterator(const UnrolledList* list, Chunk* chunk, size_t slot)
+        : list_(list), chunk_(chunk), slot_(slot) {}
+
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    Iterator(const Iterator<false>& oth)
+        : list_(oth.list_), chunk_(oth.chunk_), slot_(oth.slot_) {}
+
+    reference operator*() const { return *chunk_->slot(slot_); }
+
+    pointer operator->() const { return chunk_->slot(slot_); }
+
+    Iterator& operator++() {
+      if (++slot_ == chunk_->end_) {
+        chunk_ = chunk_->next_;
+        slot_ = chunk_ ? chunk_->begin_ : 0;
+      }
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator ret = *this;
+      ++*this;
+      return ret;
+    }
+
+    Iterator& operator--() {
+      if (chunk_ == nullptr) {
+        chunk_ = list_->tail_;
+        slot_ = chunk_->end_;
+      } else if (slot_ == chunk_->begin_) {
+        chunk_ = chunk_->prior_;
+        slot_ = chunk_->end_;
+      }
+      --slot_;
+      return *this;
+    }
+
+    Iterator operator--(int) {
+      Iterator ret = *this;
+      --*this;
+      return ret;
+    }
+
+    bool operator==(const Iterator& oth) const {
+      return chunk_ == oth.chunk_ && slot_ == oth.slot_;
+    }
+
+   private:
+    friend class UnrolledList;
+    friend class Iterator<!Const>;
+
+    const UnrolledList* list_ = nullptr;
+    Chunk* chunk_ = nullptr;
+    size_t slot_ = 0;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  // constructors & destructor
+ public:
+  UnrolledList() : head_(nullptr), tail_(nullptr), size_(0) {}
+
+  UnrolledList(const UnrolledList& oth) : UnrolledList() {
+    for (const Ty& val : oth) push_back(val);
+  }
+
+  UnrolledList(UnrolledList&& oth) noexcept : UnrolledList() { swap(oth); }
+
+  ~UnrolledList() { clear(); }
+
+  UnrolledList& operator=(const UnrolledList& oth) {
+    if (this != &oth) {
+      UnrolledList tmp(oth);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  UnrolledList& operator=(UnrolledList&& oth) noexcept {
+    if (this != &oth) {
+      clear();
+      swap(oth);
+    }
+    return *this;
+  }
+
+  // public method
+ public:
+  size_t size() const { return size_; }
+
+  bool empty() const { return (size_ == 0u); }
+
+  iterator begin() {
+    return iterator(this, head_, head_ ? head_->begin_ : 0);
+  }
+
+  iterator end() { return iterator(this, nullptr, 0); }
+
+  const_iterator begin() const {
+    return const_iterator(this, head_, head_ ? head_->begin_ : 0);
+  }
+
+  const_iterator end() const { return const_iterator(this, nullptr, 0); }
+
+  Ty& front() { return *head_->slot(head_->begin_); }
+
+  const Ty& front() const { return *head_->slot(head_->begin_); }
+
+  Ty& back() { return *tail_->slot(tail_->end_ - 1); }
+
+  const Ty& back() const { return *tail_->slot(tail_->end_ - 1); }
+
+  template <typename... Args>
+  Ty& emplace_back(Args&&... args) {
+    if (tail_ == nullptr || tail_->end_ == CAPACITY)
+      link_after(tail_, alloc_chunk(0));
+    Ty* ret = ::new ((void*)tail_->slot(tail_->end_))
+        Ty(std::forward<Args>(args)...);
+    tail_->end_++, size_++;
+    return *ret;
+  }
+
+  template <typename... Args>
+  Ty& emplace_front(Args&&... args) {
+    if (head_ == nullptr || head_->begin_ == 0)
+      link_after(nullptr, alloc_chunk(CAPACITY));
+    Ty* ret = ::new ((void*)head_->slot(head_->begin_ - 1))
+        Ty(std::forward<Args>(args)...);
+    head_->begin_--, size_++;
+    return *ret;
+  }
+
+  void push_back(const Ty& val) { emplace_back(val); }
+
+  void push_front(const Ty& val) { emplace_front(val); }
+
+  void pop_back() {
+    assert((tail_ != nullptr) && "pop_back on an empty list");
+    std::destroy_at(tail_->slot(--tail_->end_));
+    size_--;
+    if (tail_->count() == 0) unlink_free(tail_);
+  }
+
+  void pop_front() {
+    assert((head_ != nullptr) && "pop_front on an empty list");
+    std::destroy_at(head_->slot(head_->begin_++));
+    size_--;
+    if (head_->count() == 0) unlink_free(head_);
+  }
+
+  void clear() {
+    while (head_ != nullptr) {
+      std::destroy(head_->slot(head_->begin_), head_->slot(head_->end_));
+      unlink_free(head_);
+    }
+    size_ = 0;
+  }
+
+  /**
+   * @brief
+   *
+   * insert val before pos. A full chunk is split in halves first.
+   *
+   * @return iterator the iterator to the inserted element
+   */
+  iterator insert(const_iterator pos, const Ty& val) {
+    if (pos.chunk_ == nullptr) {
+      emplace_back(val);
+      return iterator(this, tail_, tail_->end_ - 1);
+    }
+    Chunk* chunk = pos.chunk_;
+    size_t slot = pos.slot_;
+    if (chunk->count() == CAPACITY) {
+      Chunk* upper = split(chunk, chunk->begin_ + CAPACITY / 2);
+      if (slot >= chunk->end_) {
+        slot = slot - chunk->end_ + upper->begin_;
+        chunk = upper;
+      }
+    }
+    Ty tmp(val);
+    if (chunk->end_ < CAPACITY) {
+      shift(chunk, slot, chunk->end_, slot + 1);
+      chunk->end_++;
+    } else {
+      shift(chunk, chunk->begin_, slot, chunk->begin_ - 1);
+      chunk->begin_--, slot--;
+    }
+    ::new ((void*)chunk->slot(slot)) Ty(std::move(tmp));
+    size_++;
+    return iterator(this, chunk, slot);
+  }
+
+  /**
+   * @brief
+   *
+   * erase the element at pos. The shorter side of the chunk is shifted to
+   * close the gap, and the chunk is merged into its successor when both fit
+   * into half a chunk.
+   *
+   * @return iterator the iterator to the element after the erased one
+   */
+  iterator erase(const_iterator pos) {
+    Chunk* chunk = pos.chunk_;
+    size_t slot = pos.slot_;
+    assert((chunk != nullptr) && "erase at end()");
+
+    std::destroy_at(chunk->slot(slot));
+    size_--;
+    if (slot - chunk->begin_ < chunk->end_ - 1 - slot) {
+      shift(chunk, chunk->begin_, slot, chunk->begin_ + 1);
+      chunk->begin_++, slot++;
+    } else {
+      shift(chunk, slot + 1, chunk->end_, slot);
+      chunk->end_--;
+    }
+
+    if (chunk->count() == 0) {
+      Chunk* next = chunk->next_;
+      unlink_free(chunk);
+      return iterator(this, next, next ? next->begin_ : 0);
+    }
+
+    // the successor, as an offset from the chunk's first element
+    size_t offset = slot - chunk->begin_;
+    Chunk* next = chunk->next_;
+    if (next != nullptr && chunk->count() + next->count() <= CAPACITY / 2) {
+      shift(chunk, chunk->begin_, chunk->end_, 0);
+      chunk->end_ = chunk->count(), chunk->begin_ = 0;
+      shift_into(next, chunk);
+      unlink_free(next);
+    }
+    if (offset == chunk->count()) {
+      next = chunk->next_;
+      return iterator(this, next, next ? next->begin_ : 0);
+    }
+    return iterator(this, chunk, chunk->begin_ + offset);
+  }
+
+  /**
+   * @brief
+   *
+   * move all elements of oth before pos without copying them. oth is left
+   * empty.
+   */
+  void splice(const_iterator pos, UnrolledList& oth) {
+    if (oth.empty() || &oth == this) return;
+    Chunk* after;
+    if (pos.chunk_ == nullptr)
+      after = tail_;
+    else if (pos.slot_ == pos.chunk_->begin_)
+      after = pos.chunk_->prior_;
+    else
+      after = split(pos.chunk_, pos.slot_)->prior_;
+
+    Chunk* before = after ? after->next_ : head_;
+    oth.head_->prior_ = after;
+    oth.tail_->next_ = before;
+    (after ? after->next_ : head_) = oth.head_;
+    (before ? before->prior_ : tail_) = oth.tail_;
+    size_ += oth.size_;
+    oth.head_ = oth.tail_ = nullptr, oth.size_ = 0;
+  }
+
+  void swap(UnrolledList& oth) noexcept {
+    std::swap(head_, oth.head_);
+    std::swap(tail_, oth.tail_);
+    std::swap(size_, oth.size_);
+  }
+
+  // the number of chunks currently allocated
+  size_t chunks() const {
+    size_t ret = 0;
+    for (Chunk* cur = head_; cur; cur = cur->next_) ret++;
+    return ret;
+  }
+
+  // private method
+ private:
+  Chunk* alloc_chunk(size_t at) {
+    Chunk* ret = new Chunk;
+    ret->prior_ = ret->next_ = nullptr;
+    ret->begin_ = ret->end_ = (uint16_t)at;
+    return ret;
+  }
+
+  // link chunk after after, or at the head if after is nullptr
+  void link_after(Chunk* after, Chunk* chunk) {
+    chunk->prior_ = after;
+    chunk->next_ = after ? after->next_ : head_;
+    (chunk->next_ ? chunk->next_->prior_ : tail_) = chunk;
+    (after ? after->next_ : head_) = chunk;
+  }
+
+  // unlink and free a chunk whose elements are already gone
+  void unlink_free(Chunk* chunk) {
+    (chunk->prior_ ? chunk->prior_->next_ : head_) = chunk->next_;
+    (chunk->next_ ? chunk->next_->prior_ : tail_) = chunk->prior_;
+    delete chunk;
+  }
+
+  /**
+   * @brief
+   *
+   * relocate the elements in slots [from, to) of chunk so that they start at
+   * slot dest. The source and destination ranges may overlap.
+   */
+  static void shift(Chunk* chunk, size_t from, size_t to, size_t dest) {
+    if (from == dest || from == to) return;
+    if constexpr (std::is_trivially_copyable_v<Ty>) {
+      memmove(chunk->slot(dest), chunk->slot(from), (to - from) * sizeof(Ty));
+    } else if (dest < from) {
+      for (size_t i = from; i < to; ++i) relocate(chunk, i, dest + (i - from));
+    } else {
+      for (size_t i = to; i-- > from;) relocate(chunk, i, dest + (i - from));
+    }
+  }
+
+  static void relocate(Chunk* chunk, size_t from, size_t to) {
+    ::new ((void*)chunk->slot(to)) Ty(std::move(*chunk->slot(from)));
+    std::destroy_at(chunk->slot(from));
+  }
+
+  // append the elements of src to dst, which must have room for them
+  static void shift_into(Chunk* src, Chunk* dst) {
+    for (size_t i = src->begin_; i < src->end_; ++i) {
+      ::new ((void*)dst->slot(dst->end_++)) Ty(std::move(*src->slot(i)));
+      std::destroy_at(src->slot(i));
+    }
+    src->begin_ = src->end_ = 0;
+  }
+
+  // move slots [slot, end_) of chunk into a new chunk linked after it
+  Chunk* split(Chunk* chunk, size_t slot) {
+    Chunk* upper = alloc_chunk(0);
+    for (size_t i = slot; i < chunk->end_; ++i) {
+      ::new ((void*)upper->slot(upper->end_++)) Ty(std::move(*chunk->slot(i)));
+      std::destroy_at(chunk->slot(i));
+    }
+    chunk->end_ = (uint16_t)slot;
+    link_after(chunk, upper);
+    return upper;
+  }
+
+  // members
+ private:
+  Chunk *head_, *tail_;
+  size_t size_;
+};
+
+#endif
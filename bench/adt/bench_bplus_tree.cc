@@ -0,0 +1,161 @@
+/**
+ * @file bench_bplus_tree.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-04
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file compares BPlusTreeMap, with its default 256-byte nodes and with
+ * page-sized ones, against std::map on random 64-bit keys: point lookups,
+ * random inserts into a growing map, and range scans of RANGE consecutive
+ * elements from a random key. BulkLoad builds a map from sorted elements.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <random>
+#include <utility>
+
+#include "adt/bplus_tree.hpp"
+#include "adt/linear_list.hpp"
+#include "benchmark/benchmark.h"
+
+#ifndef HYPERION_BENCH_MAX_N
+#define HYPERION_BENCH_MAX_N 1000000
+#endif
+
+// lookups per iteration of Find
+const static size_t LOOKUPS = 1024;
+// elements per scan
+const static size_t RANGE = 1000;
+
+// uniform access to the maps under test
+template <class Map>
+struct TreeOps {
+  static void insert(Map& map, uint64_t key, uint64_t val) {
+    map.insert(key, val);
+  }
+  static bool contains(const Map& map, uint64_t key) {
+    return map.contains(key);
+  }
+  // the sum of the values of the keys in [lo, hi)
+  static uint64_t scan(const Map& map, uint64_t lo, uint64_t hi) {
+    uint64_t sum = 0;
+    map.for_range(lo, hi,
+                  [&](const uint64_t&, const uint64_t& val) { sum += val; });
+    return sum;
+  }
+};
+
+template <>
+struct TreeOps<std::map<uint64_t, uint64_t>> {
+  using Map = std::map<uint64_t, uint64_t>;
+  static void insert(Map& map, uint64_t key, uint64_t val) {
+    map.emplace(key, val);
+  }
+  static bool contains(const Map& map, uint64_t key) {
+    return map.find(key) != map.end();
+  }
+  static uint64_t scan(const Map& map, uint64_t lo, uint64_t hi) {
+    uint64_t sum = 0;
+    for (auto it = map.lower_bound(lo); it != map.end() && it->first < hi;
+         ++it)
+      sum += it->second;
+    return sum;
+  }
+};
+
+using BPlusMap = BPlusTreeMap<uint64_t, uint64_t>;
+using BPlusPageMap =
+    BPlusTreeMap<uint64_t, uint64_t, std::less<uint64_t>, 4096>;
+using StdOrderedMap = std::map<uint64_t, uint64_t>;
+
+static LinearList<uint64_t> random_keys(size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  LinearList<uint64_t> ret;
+  ret.reserve(n);
+  for (size_t i = 0; i < n; ++i) ret.push_back(rng());
+  return ret;
+}
+
+template <class Map>
+static Map build(const LinearList<uint64_t>& keys) {
+  Map map;
+  for (size_t i = 0; i < keys.size(); ++i)
+    TreeOps<Map>::insert(map, keys[i], i);
+  return map;
+}
+
+template <class Map>
+static void BM_Find(benchmark::State& state) {
+  const LinearList<uint64_t> keys = random_keys(state.range(0), 1);
+  const Map map = build<Map>(keys);
+  std::mt19937_64 rng(2);
+  LinearList<uint64_t> probes;
+  for (size_t i = 0; i < LOOKUPS; ++i)
+    probes.push_back(keys[rng() % keys.size()]);
+  for (auto _ : state) {
+    size_t found = 0;
+    for (size_t i = 0; i < LOOKUPS; ++i)
+      found += TreeOps<Map>::contains(map, probes[i]);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+
+template <class Map>
+static void BM_Insert(benchmark::State& state) {
+  const LinearList<uint64_t> keys = random_keys(state.range(0), 1);
+  for (auto _ : state) {
+    Map map = build<Map>(keys);
+    benchmark::DoNotOptimize(&map);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template <class Map>
+static void BM_Scan(benchmark::State& state) {
+  // keys 0, 1, 2, ...: a scan from a random key visits RANGE elements
+  const size_t n = state.range(0);
+  Map map;
+  for (size_t i = 0; i < n; ++i) TreeOps<Map>::insert(map, i, i);
+  std::mt19937_64 rng(3);
+  for (auto _ : state) {
+    const uint64_t from = rng() % (n - RANGE);
+    benchmark::DoNotOptimize(TreeOps<Map>::scan(map, from, from + RANGE));
+  }
+  state.SetItemsProcessed(state.iterations() * RANGE);
+}
+
+template <class Map>
+static void BM_BulkLoad(benchmark::State& state) {
+  const size_t n = state.range(0);
+  LinearList<std::pair<uint64_t, uint64_t>> sorted;
+  for (size_t i = 0; i < n; ++i) sorted.push_back({i * 2, i});
+  for (auto _ : state) {
+    Map map;
+    map.bulk_load(sorted);
+    benchmark::DoNotOptimize(&map);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+#define TREE_BENCHMARK(func, map) \
+  BENCHMARK_TEMPLATE(func, map)   \
+      ->RangeMultiplier(10)       \
+      ->Range(10000, HYPERION_BENCH_MAX_N)
+
+TREE_BENCHMARK(BM_Find, BPlusMap);
+TREE_BENCHMARK(BM_Find, BPlusPageMap);
+TREE_BENCHMARK(BM_Find, StdOrderedMap);
+TREE_BENCHMARK(BM_Insert, BPlusMap);
+TREE_BENCHMARK(BM_Insert, BPlusPageMap);
+TREE_BENCHMARK(BM_Insert, StdOrderedMap);
+TREE_BENCHMARK(BM_Scan, BPlusMap);
+TREE_BENCHMARK(BM_Scan, BPlusPageMap);
+TREE_BENCHMARK(BM_Scan, StdOrderedMap);
+TREE_BENCHMARK(BM_BulkLoad, BPlusMap);
+TREE_BENCHMARK(BM_BulkLoad, BPlusPageMap);
@@ -0,0 +1,117 @@
+/**
+ * @file bench_dary_heap.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file compares DaryHeap, with four and with two children per node,
+ * against std::priority_queue, all as min-heaps of random 32-bit keys. Hold
+ * is the classic scheduler pattern: pop the earliest key and push it back
+ * a random distance of up to 2^32 later, so the size stays constant and
+ * the new key may land at any depth. Build heapifies n keys, and Drain
+ * pops all of them.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "adt/dary_heap.hpp"
+#include "adt/linear_list.hpp"
+#include "benchmark/benchmark.h"
+
+#ifndef HYPERION_BENCH_MAX_N
+#define HYPERION_BENCH_MAX_N 1000000
+#endif
+
+// uniform access to the heaps under test
+template <class Heap>
+struct HeapOps {
+  static Heap build(const LinearList<uint64_t>& keys) { return Heap(keys); }
+  static uint64_t top(const Heap& heap) { return heap.top(); }
+};
+
+using StdHeap =
+    std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<>>;
+
+template <>
+struct HeapOps<StdHeap> {
+  static StdHeap build(const LinearList<uint64_t>& keys) {
+    return StdHeap(std::greater<>(),
+                   std::vector<uint64_t>(keys.first(),
+                                         keys.first() + keys.size()));
+  }
+  static uint64_t top(const StdHeap& heap) { return heap.top(); }
+};
+
+using QuadHeap = DaryHeap<uint64_t, 4>;
+using BinaryHeap = DaryHeap<uint64_t, 2>;
+
+static LinearList<uint64_t> random_keys(size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  LinearList<uint64_t> ret;
+  ret.reserve(n);
+  for (size_t i = 0; i < n; ++i) ret.push_back(rng() >> 32);
+  return ret;
+}
+
+template <class Heap>
+static void BM_Hold(benchmark::State& state) {
+  Heap heap = HeapOps<Heap>::build(random_keys(state.range(0), 1));
+  std::mt19937_64 rng(2);
+  for (auto _ : state) {
+    const uint64_t key = HeapOps<Heap>::top(heap);
+    heap.pop();
+    heap.push(key + (rng() >> 32));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <class Heap>
+static void BM_Build(benchmark::State& state) {
+  const LinearList<uint64_t> keys = random_keys(state.range(0), 1);
+  for (auto _ : state) {
+    Heap heap = HeapOps<Heap>::build(keys);
+    benchmark::DoNotOptimize(HeapOps<Heap>::top(heap));
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template <class Heap>
+static void BM_Drain(benchmark::State& state) {
+  const LinearList<uint64_t> keys = random_keys(state.range(0), 1);
+  Heap heap = HeapOps<Heap>::build(LinearList<uint64_t>());
+  for (auto _ : state) {
+    // the drained heap is freed outside the timed region too
+    state.PauseTiming();
+    heap = HeapOps<Heap>::build(keys);
+    state.ResumeTiming();
+    uint64_t sum = 0;
+    while (!heap.empty()) {
+      sum += HeapOps<Heap>::top(heap);
+      heap.pop();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+#define HEAP_BENCHMARK(func, heap) \
+  BENCHMARK_TEMPLATE(func, heap)   \
+      ->RangeMultiplier(10)        \
+      ->Range(1000, HYPERION_BENCH_MAX_N)
+
+HEAP_BENCHMARK(BM_Hold, QuadHeap);
+HEAP_BENCHMARK(BM_Hold, BinaryHeap);
+HEAP_BENCHMARK(BM_Hold, StdHeap);
+HEAP_BENCHMARK(BM_Build, QuadHeap);
+HEAP_BENCHMARK(BM_Build, BinaryHeap);
+HEAP_BENCHMARK(BM_Build, StdHeap);
+HEAP_BENCHMARK(BM_Drain, QuadHeap);
+HEAP_BENCHMARK(BM_Drain, BinaryHeap);
+HEAP_BENCHMARK(BM_Drain, StdHeap);
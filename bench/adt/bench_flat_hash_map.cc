@@ -0,0 +1,175 @@
+/**
+ * @file bench_flat_hash_map.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file compares FlatHashMap with std::unordered_map on random 64-bit
+ * keys: building a map, lookups of present and absent keys, and churn, an
+ * erasure followed by an insertion of a fresh key, which keeps the size
+ * constant and leaves tombstones behind in tables that use them. StringFind
+ * looks up 16-byte std::string keys.
+ */
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "adt/flat_hash_map.hpp"
+#include "adt/linear_list.hpp"
+#include "benchmark/benchmark.h"
+
+#ifndef HYPERION_BENCH_MAX_N
+#define HYPERION_BENCH_MAX_N 1000000
+#endif
+
+// lookups per iteration of the find benchmarks
+const static size_t LOOKUPS = 1024;
+
+// uniform access to the maps under test
+template <class Map>
+struct MapOps;
+
+template <class Key, class Value, class Hash, class Eq>
+struct MapOps<FlatHashMap<Key, Value, Hash, Eq>> {
+  using Map = FlatHashMap<Key, Value, Hash, Eq>;
+  static void insert(Map& map, const Key& key, Value val) {
+    map.insert(key, val);
+  }
+  static bool contains(const Map& map, const Key& key) {
+    return map.contains(key);
+  }
+  static void erase(Map& map, const Key& key) { map.erase(key); }
+};
+
+template <class Key, class Value, class Hash, class Eq>
+struct MapOps<std::unordered_map<Key, Value, Hash, Eq>> {
+  using Map = std::unordered_map<Key, Value, Hash, Eq>;
+  static void insert(Map& map, const Key& key, Value val) {
+    map.emplace(key, val);
+  }
+  static bool contains(const Map& map, const Key& key) {
+    return map.find(key) != map.end();
+  }
+  static void erase(Map& map, const Key& key) { map.erase(key); }
+};
+
+static LinearList<uint64_t> random_keys(size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  LinearList<uint64_t> ret;
+  ret.reserve(n);
+  for (size_t i = 0; i < n; ++i) ret.push_back(rng());
+  return ret;
+}
+
+template <class Map>
+static Map build(const LinearList<uint64_t>& keys) {
+  Map map;
+  for (size_t i = 0; i < keys.size(); ++i)
+    MapOps<Map>::insert(map, keys[i], i);
+  return map;
+}
+
+template <class Map>
+static void BM_Insert(benchmark::State& state) {
+  const LinearList<uint64_t> keys = random_keys(state.range(0), 1);
+  for (auto _ : state) {
+    Map map = build<Map>(keys);
+    benchmark::DoNotOptimize(&map);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template <class Map>
+static void BM_FindHit(benchmark::State& state) {
+  const LinearList<uint64_t> keys = random_keys(state.range(0), 1);
+  const Map map = build<Map>(keys);
+  std::mt19937_64 rng(2);
+  LinearList<uint64_t> probes;
+  for (size_t i = 0; i < LOOKUPS; ++i)
+    probes.push_back(keys[rng() % keys.size()]);
+  for (auto _ : state) {
+    size_t found = 0;
+    for (size_t i = 0; i < LOOKUPS; ++i)
+      found += MapOps<Map>::contains(map, probes[i]);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+
+template <class Map>
+static void BM_FindMiss(benchmark::State& state) {
+  const Map map = build<Map>(random_keys(state.range(0), 1));
+  const LinearList<uint64_t> probes = random_keys(LOOKUPS, 3);
+  for (auto _ : state) {
+    size_t found = 0;
+    for (size_t i = 0; i < LOOKUPS; ++i)
+      found += MapOps<Map>::contains(map, probes[i]);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+
+template <class Map>
+static void BM_Churn(benchmark::State& state) {
+  const size_t n = state.range(0);
+  // a ring of live keys: erase the oldest, insert a fresh one
+  LinearList<uint64_t> live = random_keys(n, 1);
+  Map map = build<Map>(live);
+  std::mt19937_64 rng(4);
+  size_t oldest = 0;
+  for (auto _ : state) {
+    MapOps<Map>::erase(map, live[oldest]);
+    live[oldest] = rng();
+    MapOps<Map>::insert(map, live[oldest], oldest);
+    oldest = oldest + 1 == n ? 0 : oldest + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <class Map>
+static void BM_StringFind(benchmark::State& state) {
+  const LinearList<uint64_t> ids = random_keys(state.range(0), 1);
+  LinearList<std::string> keys;
+  for (size_t i = 0; i < ids.size(); ++i)
+    keys.push_back(std::to_string(ids[i]).substr(0, 16));
+  Map map;
+  for (size_t i = 0; i < keys.size(); ++i)
+    MapOps<Map>::insert(map, keys[i], i);
+  std::mt19937_64 rng(2);
+  LinearList<std::string> probes;
+  for (size_t i = 0; i < LOOKUPS; ++i)
+    probes.push_back(keys[rng() % keys.size()]);
+  for (auto _ : state) {
+    size_t found = 0;
+    for (size_t i = 0; i < LOOKUPS; ++i)
+      found += MapOps<Map>::contains(map, probes[i]);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * LOOKUPS);
+}
+
+using FlatMap = FlatHashMap<uint64_t, uint64_t>;
+using StdMap = std::unordered_map<uint64_t, uint64_t>;
+using FlatStringMap = FlatHashMap<std::string, uint64_t>;
+using StdStringMap = std::unordered_map<std::string, uint64_t>;
+
+#define HASH_MAP_BENCHMARK(func, map) \
+  BENCHMARK_TEMPLATE(func, map)       \
+      ->RangeMultiplier(10)           \
+      ->Range(1000, HYPERION_BENCH_MAX_N)
+
+HASH_MAP_BENCHMARK(BM_Insert, FlatMap);
+HASH_MAP_BENCHMARK(BM_Insert, StdMap);
+HASH_MAP_BENCHMARK(BM_FindHit, FlatMap);
+HASH_MAP_BENCHMARK(BM_FindHit, StdMap);
+HASH_MAP_BENCHMARK(BM_FindMiss, FlatMap);
+HASH_MAP_BENCHMARK(BM_FindMiss, StdMap);
+HASH_MAP_BENCHMARK(BM_Churn, FlatMap);
+HASH_MAP_BENCHMARK(BM_Churn, StdMap);
+HASH_MAP_BENCHMARK(BM_StringFind, FlatStringMap);
+HASH_MAP_BENCHMARK(BM_StringFind, StdStringMap);
@@ -0,0 +1,139 @@
+/**
+ * @file bench_ring_buffer.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file measures producer/consumer throughput of the ring buffers
+ * against the lock()/append/unlock() pattern of a std::mutex-guarded queue.
+ * Every run moves ITEMS_PER_PRODUCER items from each producer thread to the
+ * consumer threads; the reported rate is items per wall-clock second.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "adt/ring_buffer.hpp"
+#include "benchmark/benchmark.h"
+
+const static uint64_t ITEMS_PER_PRODUCER = 100000;
+const static size_t RING_CAPACITY = 1024;
+const static size_t BATCH = 32;
+
+// the baseline: one mutex serializing every push and pop
+class MutexQueue {
+ public:
+  explicit MutexQueue(size_t) {}
+
+  bool try_push(uint64_t val) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    queue_.push_back(val);
+    return true;
+  }
+
+  bool try_pop(uint64_t& out) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (queue_.empty()) return false;
+    out = queue_.front();
+    queue_.pop_front();
+    return true;
+  }
+
+  size_t push_batch(const uint64_t* vals, size_t n) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    queue_.insert(queue_.end(), vals, vals + n);
+    return n;
+  }
+
+  size_t pop_batch(uint64_t* out, size_t n) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    n = std::min(n, queue_.size());
+    for (size_t i = 0; i < n; ++i) out[i] = queue_.front(), queue_.pop_front();
+    return n;
+  }
+
+ private:
+  std::mutex mtx_;
+  std::deque<uint64_t> queue_;
+};
+
+template <class Queue, bool Batched>
+static void run(int producers, int consumers) {
+  Queue queue(RING_CAPACITY);
+  const uint64_t total = ITEMS_PER_PRODUCER * producers;
+  std::atomic<uint64_t> consumed{0};
+  std::vector<std::thread> threads;
+
+  for (int p = 0; p < producers; ++p)
+    threads.emplace_back([&]() {
+      uint64_t batch[BATCH] = {};
+      for (uint64_t i = 0; i < ITEMS_PER_PRODUCER;) {
+        const size_t n = std::min<uint64_t>(BATCH, ITEMS_PER_PRODUCER - i);
+        size_t k;
+        if constexpr (Batched)
+          k = queue.push_batch(batch, n);
+        else
+          k = queue.try_push(i);
+        if (!k) std::this_thread::yield();
+        i += k;
+      }
+    });
+
+  for (int c = 0; c < consumers; ++c)
+    threads.emplace_back([&]() {
+      uint64_t out[BATCH];
+      while (consumed.load(std::memory_order_relaxed) < total) {
+        size_t k;
+        if constexpr (Batched)
+          k = queue.pop_batch(out, BATCH);
+        else
+          k = queue.try_pop(out[0]);
+        if (!k)
+          std::this_thread::yield();
+        else
+          consumed.fetch_add(k, std::memory_order_relaxed);
+      }
+    });
+
+  for (auto& t : threads) t.join();
+}
+
+template <class Queue, bool Batched>
+static void BM_Throughput(benchmark::State& state) {
+  const int producers = state.range(0), consumers = state.range(1);
+  for (auto _ : state) run<Queue, Batched>(producers, consumers);
+  state.SetItemsProcessed(state.iterations() * ITEMS_PER_PRODUCER * producers);
+}
+
+BENCHMARK_TEMPLATE(BM_Throughput, MutexQueue, false)
+    ->Args({1, 1})
+    ->Args({2, 2})
+    ->Args({4, 4})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, MutexQueue, true)
+    ->Args({1, 1})
+    ->Args({4, 4})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, SpscRingBuffer<uint64_t>, false)
+    ->Args({1, 1})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, SpscRingBuffer<uint64_t>, true)
+    ->Args({1, 1})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, MpmcRingBuffer<uint64_t>, false)
+    ->Args({1, 1})
+    ->Args({2, 2})
+    ->Args({4, 4})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Throughput, MpmcRingBuffer<uint64_t>, true)
+    ->Args({1, 1})
+    ->Args({4, 4})
+    ->UseRealTime();
@@ -0,0 +1,260 @@
+/**
+ * @file bench_sequence.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file benchmarks LinearList and LinkedList against std::vector,
+ * std::list and std::deque: push/pop, iteration, random access and
+ * copy/move, for 8- and 64-byte elements and counts from 10 up to
+ * HYPERION_BENCH_MAX_N. ShortLists builds many lists of a few elements each,
+ * where SmallLinearList saves the allocation LinearList makes.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "adt/linear_list.hpp"
+#include "adt/linked_list.hpp"
+#include "adt/small_linear_list.hpp"
+#include "benchmark/benchmark.h"
+
+#ifndef HYPERION_BENCH_MAX_N
+#define HYPERION_BENCH_MAX_N 1000000
+#endif
+
+// positional lookups into node-based lists are O(n), so they stop earlier
+const static int64_t LIST_RANDOM_ACCESS_MAX_N = 10000;
+// lists built per iteration of ShortLists
+const static size_t SHORT_LISTS = 1024;
+
+template <size_t Bytes>
+struct Payload {
+  static_assert(Bytes % sizeof(uint64_t) == 0);
+  uint64_t data_[Bytes / sizeof(uint64_t)];
+
+  Payload() = default;
+  explicit Payload(uint64_t val) {
+    for (auto& d : data_) d = val;
+  }
+
+  uint64_t key() const { return data_[0]; }
+};
+
+template <class Ty>
+static uint64_t key_of(const Ty& val) {
+  return val.key();
+}
+
+// uniform access to the containers under test
+
+template <class C>
+static void visit(const C& c, uint64_t& sum) {
+  for (const auto& val : c) sum += key_of(val);
+}
+
+template <class Ty, class G>
+static void visit(const LinearList<Ty, G>& c, uint64_t& sum) {
+  const Ty* data = c.first();
+  for (size_t i = 0, n = c.size(); i < n; ++i) sum += key_of(data[i]);
+}
+
+template <class Ty, class A>
+static void visit(const LinkedList<Ty, A>& c, uint64_t& sum) {
+  for (auto* cur = c.first(); cur != nullptr; cur = cur->next_)
+    sum += key_of(cur->value_);
+}
+
+template <class C>
+static uint64_t get(const C& c, size_t idx) {
+  return key_of(c[idx]);
+}
+
+template <class Ty, class A>
+static uint64_t get(const std::list<Ty, A>& c, size_t idx) {
+  return key_of(*std::next(c.begin(), idx));
+}
+
+template <class Ty, class A>
+static uint64_t get(const LinkedList<Ty, A>& c, size_t idx) {
+  return key_of(c.at(idx)->value_);
+}
+
+template <class C>
+struct ValueType {
+  using type = typename C::value_type;
+};
+
+template <class Ty, class G>
+struct ValueType<LinearList<Ty, G>> {
+  using type = Ty;
+};
+
+template <class Ty, class A>
+struct ValueType<LinkedList<Ty, A>> {
+  using type = Ty;
+};
+
+template <class Ty, size_t N, class G>
+struct ValueType<SmallLinearList<Ty, N, G>> {
+  using type = Ty;
+};
+
+template <class C>
+using ValueOf = typename ValueType<C>::type;
+
+template <class C>
+static C make_list(size_t n) {
+  C ret;
+  for (size_t i = 0; i < n; ++i) ret.push_back(ValueOf<C>(i));
+  return ret;
+}
+
+// benchmarks
+
+template <class C>
+static void BM_PushBack(benchmark::State& state) {
+  const size_t n = state.range(0);
+  for (auto _ : state) {
+    C c;
+    for (size_t i = 0; i < n; ++i) c.push_back(ValueOf<C>(i));
+    benchmark::DoNotOptimize(c);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <class C>
+static void BM_PushPopBack(benchmark::State& state) {
+  const size_t n = state.range(0);
+  C c = make_list<C>(n);
+  for (auto _ : state) {
+    for (size_t i = 0; i < n; ++i) c.pop_back();
+    for (size_t i = 0; i < n; ++i) c.push_back(ValueOf<C>(i));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n * 2);
+}
+
+template <class C>
+static void BM_Iterate(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const C c = make_list<C>(n);
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    visit(c, sum);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * n * sizeof(ValueOf<C>));
+}
+
+template <class C>
+static void BM_RandomAccess(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const C c = make_list<C>(n);
+  std::mt19937_64 rnd(n);
+  std::vector<size_t> idx(1024);
+  for (auto& i : idx) i = rnd() % n;
+
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (size_t i : idx) sum += get(c, i);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * idx.size());
+}
+
+template <class C>
+static void BM_Copy(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const C c = make_list<C>(n);
+  for (auto _ : state) {
+    C copy(c);
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <class C>
+static void BM_Move(benchmark::State& state) {
+  const size_t n = state.range(0);
+  C c = make_list<C>(n);
+  for (auto _ : state) {
+    C moved(std::move(c));
+    c = std::move(moved);
+    benchmark::DoNotOptimize(c);
+  }
+}
+
+// build and sum up SHORT_LISTS lists of n elements each
+template <class C>
+static void BM_ShortLists(benchmark::State& state) {
+  const size_t n = state.range(0);
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (size_t k = 0; k < SHORT_LISTS; ++k) {
+      C c;
+      for (size_t i = 0; i < n; ++i) c.push_back(ValueOf<C>(k + i));
+      sum += key_of(c[n - 1]);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * SHORT_LISTS);
+}
+
+// register the suite for container C as "<name>/<op>/<count>"
+template <class C>
+static void register_suite(const std::string& name, bool node_based) {
+  auto add = [&](const char* op, void (*fn)(benchmark::State&),
+                 int64_t max_n) {
+    benchmark::RegisterBenchmark((name + "/" + op).c_str(), fn)
+        ->RangeMultiplier(10)
+        ->Range(10, std::min<int64_t>(max_n, HYPERION_BENCH_MAX_N));
+  };
+  add("PushBack", BM_PushBack<C>, HYPERION_BENCH_MAX_N);
+  add("PushPopBack", BM_PushPopBack<C>, HYPERION_BENCH_MAX_N);
+  add("Iterate", BM_Iterate<C>, HYPERION_BENCH_MAX_N);
+  add("RandomAccess", BM_RandomAccess<C>,
+      node_based ? LIST_RANDOM_ACCESS_MAX_N : HYPERION_BENCH_MAX_N);
+  add("Copy", BM_Copy<C>, HYPERION_BENCH_MAX_N);
+  add("Move", BM_Move<C>, HYPERION_BENCH_MAX_N);
+}
+
+template <size_t Bytes>
+static void register_all() {
+  using Ty = Payload<Bytes>;
+  const std::string suffix = "<" + std::to_string(Bytes) + "B>";
+  register_suite<LinearList<Ty>>("LinearList" + suffix, false);
+  register_suite<std::vector<Ty>>("std::vector" + suffix, false);
+  register_suite<std::deque<Ty>>("std::deque" + suffix, false);
+  register_suite<LinkedList<Ty>>("LinkedList" + suffix, true);
+  register_suite<std::list<Ty>>("std::list" + suffix, true);
+
+  auto add_short = [&](const std::string& name,
+                       void (*fn)(benchmark::State&)) {
+    benchmark::RegisterBenchmark((name + suffix + "/ShortLists").c_str(), fn)
+        ->Arg(1)
+        ->Arg(4)
+        ->Arg(8)
+        ->Arg(16);
+  };
+  add_short("LinearList", BM_ShortLists<LinearList<Ty>>);
+  add_short("SmallLinearList<8>", BM_ShortLists<SmallLinearList<Ty, 8>>);
+  add_short("std::vector", BM_ShortLists<std::vector<Ty>>);
+}
+
+static const int REGISTERED = []() {
+  register_all<8>();
+  register_all<64>();
+  return 0;
+}();
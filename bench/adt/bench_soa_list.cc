@@ -0,0 +1,112 @@
+/**
+ * @file bench_soa_list.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-30
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file compares a LinearList of 32-byte particle structs with a
+ * SoaList of the same fields, on kernels touching one or two fields: a sum
+ * of one field, and an update of one field from another.
+ */
+
+#include <cstdint>
+
+#include "adt/linear_list.hpp"
+#include "adt/soa_list.hpp"
+#include "benchmark/benchmark.h"
+
+#ifndef HYPERION_BENCH_MAX_N
+#define HYPERION_BENCH_MAX_N 1000000
+#endif
+
+struct Particle {
+  float x, y, z;
+  float vx, vy, vz;
+  float mass;
+  uint32_t id;
+};
+
+using ParticleSoa =
+    SoaList<float, float, float, float, float, float, float, uint32_t>;
+
+static LinearList<Particle> make_aos(size_t n) {
+  LinearList<Particle> ret;
+  ret.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    const float f = (float)i;
+    ret.push_back(Particle{f, f, f, 1.0f, 1.0f, 1.0f, 2.0f, (uint32_t)i});
+  }
+  return ret;
+}
+
+static ParticleSoa make_soa(size_t n) {
+  ParticleSoa ret;
+  ret.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    const float f = (float)i;
+    ret.emplace_back(f, f, f, 1.0f, 1.0f, 1.0f, 2.0f, (uint32_t)i);
+  }
+  return ret;
+}
+
+static void BM_AosSumMass(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const LinearList<Particle> list = make_aos(n);
+  for (auto _ : state) {
+    float sum = 0;
+    const Particle* data = list.first();
+    for (size_t i = 0; i < n; ++i) sum += data[i].mass;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_SoaSumMass(benchmark::State& state) {
+  const size_t n = state.range(0);
+  const ParticleSoa list = make_soa(n);
+  for (auto _ : state) {
+    float sum = 0;
+    for (float mass : list.column<6>()) sum += mass;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_AosAdvanceX(benchmark::State& state) {
+  const size_t n = state.range(0);
+  LinearList<Particle> list = make_aos(n);
+  for (auto _ : state) {
+    Particle* data = list.first();
+    for (size_t i = 0; i < n; ++i) data[i].x += data[i].vx;
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_SoaAdvanceX(benchmark::State& state) {
+  const size_t n = state.range(0);
+  ParticleSoa list = make_soa(n);
+  for (auto _ : state) {
+    float* x = list.column<0>().data();
+    const float* vx = list.column<3>().data();
+    for (size_t i = 0; i < n; ++i) x[i] += vx[i];
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_AosSumMass)
+    ->RangeMultiplier(10)
+    ->Range(1000, HYPERION_BENCH_MAX_N);
+BENCHMARK(BM_SoaSumMass)
+    ->RangeMultiplier(10)
+    ->Range(1000, HYPERION_BENCH_MAX_N);
+BENCHMARK(BM_AosAdvanceX)
+    ->RangeMultiplier(10)
+    ->Range(1000, HYPERION_BENCH_MAX_N);
+BENCHMARK(BM_SoaAdvanceX)
+    ->RangeMultiplier(10)
+    ->Range(1000, HYPERION_BENCH_MAX_N);
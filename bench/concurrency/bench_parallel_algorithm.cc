@@ -0,0 +1,114 @@
+/**
+ * @file bench_parallel_algorithm.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-23
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file measures how the parallel algorithms scale with the number of
+ * workers. Every benchmark runs on HYPERION_BENCH_MAX_N elements; the
+ * argument is the size of the ThreadPool, with 0 standing for the serial
+ * loop over the same data.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <span>
+
+#include "adt/linear_list.hpp"
+#include "benchmark/benchmark.h"
+#include "concurrency/parallel_algorithm.hpp"
+#include "concurrency/thread_pool.hpp"
+#include "math/carmack_batch.hpp"
+#include "math/carmack_magic.hpp"
+
+#ifndef HYPERION_BENCH_MAX_N
+#define HYPERION_BENCH_MAX_N 1000000
+#endif
+
+namespace PA = ParallelAlgorithm;
+
+static LinearList<float> make_floats() {
+  LinearList<float> ret;
+  ret.reserve(HYPERION_BENCH_MAX_N);
+  for (size_t i = 0; i < HYPERION_BENCH_MAX_N; ++i)
+    ret.push_back(1.0f + (float)(i % 4096));
+  return ret;
+}
+
+// Q_rsqrt element by element
+static void BM_RsqrtScalar(benchmark::State& state) {
+  const size_t threads = state.range(0);
+  LinearList<float> data = make_floats();
+  ThreadPool pool(std::max<size_t>(threads, 1));
+  auto kernel = [](float& x) { x = CarmackMagic::Q_rsqrt(x); };
+  for (auto _ : state) {
+    if (threads == 0)
+      for (size_t i = 0; i < data.size(); ++i) kernel(data[i]);
+    else
+      PA::for_each(pool, data, kernel);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+// the best CarmackBatch kernel chunk by chunk
+static void BM_RsqrtBatch(benchmark::State& state) {
+  const size_t threads = state.range(0);
+  LinearList<float> data = make_floats();
+  ThreadPool pool(std::max<size_t>(threads, 1));
+  auto kernel = [](std::span<float> s) { CarmackBatch::rsqrt_inplace(s); };
+  for (auto _ : state) {
+    if (threads == 0)
+      kernel(std::span<float>(data.first(), data.size()));
+    else
+      PA::for_each_chunk(pool, data, kernel);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+static void BM_Reduce(benchmark::State& state) {
+  const size_t threads = state.range(0);
+  LinearList<float> data = make_floats();
+  ThreadPool pool(std::max<size_t>(threads, 1));
+  for (auto _ : state) {
+    double sum;
+    if (threads == 0)
+      sum = std::accumulate(data.first(), data.first() + data.size(), 0.0);
+    else
+      sum = PA::reduce(pool, data, 0.0);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+static void BM_Sort(benchmark::State& state) {
+  const size_t threads = state.range(0);
+  LinearList<uint64_t> src;
+  std::mt19937_64 rng(1);
+  for (size_t i = 0; i < HYPERION_BENCH_MAX_N; ++i) src.push_back(rng());
+  ThreadPool pool(std::max<size_t>(threads, 1));
+  for (auto _ : state) {
+    state.PauseTiming();
+    LinearList<uint64_t> data = src;
+    state.ResumeTiming();
+    if (threads == 0)
+      std::sort(data.first(), data.first() + data.size());
+    else
+      PA::sort(pool, data);
+    benchmark::DoNotOptimize(data.first());
+  }
+  state.SetItemsProcessed(state.iterations() * src.size());
+}
+
+BENCHMARK(BM_RsqrtScalar)->Arg(0)->RangeMultiplier(2)->Range(1, 8)
+    ->UseRealTime();
+BENCHMARK(BM_RsqrtBatch)->Arg(0)->RangeMultiplier(2)->Range(1, 8)
+    ->UseRealTime();
+BENCHMARK(BM_Reduce)->Arg(0)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK(BM_Sort)->Arg(0)->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
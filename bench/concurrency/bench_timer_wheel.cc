@@ -0,0 +1,149 @@
+/**
+ * @file bench_timer_wheel.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file compares TimerWheel with a scheduler built on
+ * std::priority_queue, which cancels lazily: a cancelled entry stays in the
+ * heap and is skipped when it reaches the top.
+ *
+ * Rearm models per-connection idle timeouts: range(0) connections each hold
+ * a timeout of 1000 to 30000 ticks. Every operation moves one tick forward
+ * and pushes back the timeout of one random connection (a cancel and a
+ * schedule); a connection whose timeout expires is given a new one.
+ * ScheduleDrain schedules range(0) timers and then expires all of them.
+ */
+
+#include <cstdint>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "adt/linear_list.hpp"
+#include "benchmark/benchmark.h"
+#include "concurrency/timer_wheel.hpp"
+
+#ifndef HYPERION_BENCH_MAX_N
+#define HYPERION_BENCH_MAX_N 1000000
+#endif
+
+const static uint64_t MIN_TIMEOUT = 1000;
+const static uint64_t MAX_TIMEOUT = 30000;
+
+// the callback: which connection timed out
+struct Expire {
+  uint32_t conn_ = 0;
+};
+
+class HeapScheduler {
+  struct Entry {
+    uint64_t expiry_;
+    uint32_t conn_;
+    uint32_t generation_;
+    bool operator>(const Entry& oth) const { return expiry_ > oth.expiry_; }
+  };
+
+ public:
+  explicit HeapScheduler(size_t conns) : generation_(conns, 0) {}
+
+  uint64_t now() const { return now_; }
+
+  void schedule_at(uint64_t expiry, uint32_t conn) {
+    heap_.push(Entry{expiry, conn, ++generation_[conn]});
+  }
+
+  void cancel(uint32_t conn) { ++generation_[conn]; }
+
+  void advance(uint64_t tick, LinearList<Expire>& due) {
+    now_ = tick;
+    while (!heap_.empty() && heap_.top().expiry_ <= tick) {
+      const Entry top = heap_.top();
+      heap_.pop();
+      if (top.generation_ == generation_[top.conn_])
+        due.push_back(Expire{top.conn_});
+    }
+  }
+
+ private:
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap_;
+  std::vector<uint32_t> generation_;
+  uint64_t now_ = 0;
+};
+
+class WheelScheduler {
+ public:
+  explicit WheelScheduler(size_t conns) : handles_(conns) {}
+
+  uint64_t now() const { return wheel_.now(); }
+
+  void schedule_at(uint64_t expiry, uint32_t conn) {
+    handles_[conn] = wheel_.schedule_at(expiry, Expire{conn});
+  }
+
+  void cancel(uint32_t conn) { wheel_.cancel(handles_[conn]); }
+
+  void advance(uint64_t tick, LinearList<Expire>& due) {
+    wheel_.advance(tick, due);
+  }
+
+ private:
+  TimerWheel<Expire> wheel_;
+  std::vector<TimerWheel<Expire>::Handle> handles_;
+};
+
+template <class Scheduler>
+static void BM_Rearm(benchmark::State& state) {
+  const uint32_t conns = state.range(0);
+  std::mt19937_64 rng(42);
+  auto timeout = [&rng]() {
+    return MIN_TIMEOUT + rng() % (MAX_TIMEOUT - MIN_TIMEOUT);
+  };
+  Scheduler sched(conns);
+  for (uint32_t c = 0; c < conns; ++c) sched.schedule_at(timeout(), c);
+  LinearList<Expire> due;
+  for (auto _ : state) {
+    const uint32_t conn = rng() % conns;
+    sched.cancel(conn);
+    sched.schedule_at(sched.now() + timeout(), conn);
+    sched.advance(sched.now() + 1, due);
+    for (size_t i = 0; i < due.size(); ++i)
+      sched.schedule_at(sched.now() + timeout(), due[i].conn_);
+    due.clear();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <class Scheduler>
+static void BM_ScheduleDrain(benchmark::State& state) {
+  const uint32_t timers = state.range(0);
+  std::mt19937_64 rng(42);
+  LinearList<uint64_t> delays;
+  for (uint32_t i = 0; i < timers; ++i) delays.push_back(1 + rng() % 30000);
+  LinearList<Expire> due;
+  due.reserve(timers);
+  for (auto _ : state) {
+    Scheduler sched(timers);
+    for (uint32_t i = 0; i < timers; ++i) sched.schedule_at(delays[i], i);
+    sched.advance(MAX_TIMEOUT, due);
+    benchmark::DoNotOptimize(due.first());
+    due.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * timers);
+}
+
+BENCHMARK_TEMPLATE(BM_Rearm, HeapScheduler)
+    ->RangeMultiplier(10)
+    ->Range(1000, HYPERION_BENCH_MAX_N);
+BENCHMARK_TEMPLATE(BM_Rearm, WheelScheduler)
+    ->RangeMultiplier(10)
+    ->Range(1000, HYPERION_BENCH_MAX_N);
+BENCHMARK_TEMPLATE(BM_ScheduleDrain, HeapScheduler)
+    ->RangeMultiplier(10)
+    ->Range(1000, HYPERION_BENCH_MAX_N);
+BENCHMARK_TEMPLATE(BM_ScheduleDrain, WheelScheduler)
+    ->RangeMultiplier(10)
+    ->Range(1000, HYPERION_BENCH_MAX_N);
@@ -0,0 +1,250 @@
+/**
+ * @file adaptive_lock.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines spin-then-park locks for short critical sections.
+ *
+ * AdaptiveMutex is a drop-in std::mutex. A contended lock() first spins,
+ * with a pause instruction and exponential backoff between polls, for about
+ * as long as recent acquisitions needed (the adaptive spin count of glibc's
+ * PTHREAD_MUTEX_ADAPTIVE_NP). Only then does it park in std::atomic::wait,
+ * i.e. a futex on Linux. The state word is 0 when unlocked, 1 when locked
+ * and 2 when locked with possible sleepers, so that unlock() issues a wake
+ * only when somebody may be asleep.
+ *
+ * AdaptiveSharedMutex is a drop-in std::shared_mutex for read-mostly data.
+ * Every reader increments a counter on its own cache line, picked per
+ * thread, and checks for a writer; readers never write a line shared with
+ * readers of other slots. A writer raises its flag and waits for every
+ * counter to drain. Writers take precedence over new readers, so taking a
+ * shared lock recursively may deadlock once a writer is waiting. Each lock
+ * takes READER_SLOTS + 2 cache lines.
+ *
+ * On a single CPU spinning cannot help, and both locks park at once.
+ */
+
+#ifndef ADAPTIVE_LOCK_HPP_
+#define ADAPTIVE_LOCK_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "concurrency/cache_line.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace AdaptiveLockDetail {
+
+// the longest a contended lock spins, in polls
+const static uint32_t MAX_SPINS = 100;
+// the most pause instructions between two polls
+const static uint32_t MAX_BACKOFF = 64;
+const static size_t READER_SLOTS = 16;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+inline bool multicore() {
+  static const bool ret = std::thread::hardware_concurrency() > 1;
+  return ret;
+}
+
+// exponential backoff between polls of a contended word
+class Backoff {
+ public:
+  void pause() {
+    for (uint32_t i = 0; i < pauses_; ++i) cpu_relax();
+    pauses_ = std::min(pauses_ * 2, MAX_BACKOFF);
+  }
+
+ private:
+  uint32_t pauses_ = 1;
+};
+
+/**
+ * @brief
+ *
+ * block until word no longer holds old: spin up to spins polls, then park.
+ */
+inline void wait_while(const std::atomic<uint32_t>& word, uint32_t old,
+                       uint32_t spins = MAX_SPINS) {
+  if (multicore()) {
+    Backoff backoff;
+    for (uint32_t i = 0; i < spins; ++i) {
+      if (word.load(std::memory_order_acquire) != old) return;
+      backoff.pause();
+    }
+  }
+  while (word.load(std::memory_order_acquire) == old)
+    word.wait(old, std::memory_order_acquire);
+}
+
+// the reader slot of the calling thread
+inline size_t reader_slot() {
+  static std::atomic<size_t> next{0};
+  static thread_local size_t idx =
+      next.fetch_add(1, std::memory_order_relaxed) % READER_SLOTS;
+  return idx;
+}
+
+};  // namespace AdaptiveLockDetail
+
+class AdaptiveMutex {
+ public:
+  AdaptiveMutex() = default;
+
+  AdaptiveMutex(const AdaptiveMutex&) = delete;
+
+  AdaptiveMutex& operator=(const AdaptiveMutex&) = delete;
+
+ public:
+  void lock() {
+    uint32_t c = 0;
+    if (state_.compare_exchange_strong(c, 1, std::memory_order_acquire))
+      return;
+    if (AdaptiveLockDetail::multicore() && spin()) return;
+    // park; whoever wakes us may leave other sleepers, so keep the state 2
+    while (state_.exchange(2, std::memory_order_acquire) != 0)
+      state_.wait(2, std::memory_order_relaxed);
+  }
+
+  bool try_lock() {
+    uint32_t c = 0;
+    return state_.compare_exchange_strong(c, 1, std::memory_order_acquire);
+  }
+
+  void unlock() {
+    if (state_.exchange(0, std::memory_order_release) == 2)
+      state_.notify_one();
+  }
+
+ private:
+  // spin for the lock, adapting the spin budget to how long it took
+  bool spin() {
+    const uint32_t budget = std::min(
+        2 * spins_.load(std::memory_order_relaxed) + 10,
+        AdaptiveLockDetail::MAX_SPINS);
+    AdaptiveLockDetail::Backoff backoff;
+    for (uint32_t i = 0; i < budget; ++i) {
+      uint32_t c = state_.load(std::memory_order_relaxed);
+      if (c == 0 &&
+          state_.compare_exchange_weak(c, 1, std::memory_order_acquire)) {
+        learn(i);
+        return true;
+      }
+      backoff.pause();
+    }
+    learn(budget);
+    return false;
+  }
+
+  // move the spin estimate 1/8 of the way towards the last spin count; a
+  // racy update is good enough for a heuristic
+  void learn(uint32_t spun) {
+    int32_t avg = (int32_t)spins_.load(std::memory_order_relaxed);
+    spins_.store((uint32_t)(avg + ((int32_t)spun - avg) / 8),
+                 std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint32_t> state_{0};
+  std::atomic<uint32_t> spins_{0};
+};
+
+class AdaptiveSharedMutex {
+ public:
+  AdaptiveSharedMutex() {
+    for (auto& slot : readers_)
+      slot.value_.store(0, std::memory_order_relaxed);
+  }
+
+  AdaptiveSharedMutex(const AdaptiveSharedMutex&) = delete;
+
+  AdaptiveSharedMutex& operator=(const AdaptiveSharedMutex&) = delete;
+
+ public:
+  void lock() {
+    writer_mtx_.lock();
+    writer_.value_.store(1, std::memory_order_seq_cst);
+    for (auto& slot : readers_) {
+      uint32_t cnt;
+      while ((cnt = slot.value_.load(std::memory_order_seq_cst)) != 0)
+        AdaptiveLockDetail::wait_while(slot.value_, cnt);
+    }
+  }
+
+  bool try_lock() {
+    if (!writer_mtx_.try_lock()) return false;
+    writer_.value_.store(1, std::memory_order_seq_cst);
+    for (auto& slot : readers_) {
+      if (slot.value_.load(std::memory_order_seq_cst) != 0) {
+        unlock();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void unlock() {
+    writer_.value_.store(0, std::memory_order_release);
+    writer_.value_.notify_all();
+    writer_mtx_.unlock();
+  }
+
+  void lock_shared() {
+    std::atomic<uint32_t>& slot = reader();
+    while (1) {
+      // announce first, then look for a writer; the writer does the mirror
+      slot.fetch_add(1, std::memory_order_seq_cst);
+      if (writer_.value_.load(std::memory_order_seq_cst) == 0) return;
+      release(slot);
+      AdaptiveLockDetail::wait_while(writer_.value_, 1);
+    }
+  }
+
+  bool try_lock_shared() {
+    std::atomic<uint32_t>& slot = reader();
+    slot.fetch_add(1, std::memory_order_seq_cst);
+    if (writer_.value_.load(std::memory_order_seq_cst) == 0) return true;
+    release(slot);
+    return false;
+  }
+
+  // shall be called on the thread that took the shared lock
+  void unlock_shared() { release(reader()); }
+
+ private:
+  std::atomic<uint32_t>& reader() {
+    return readers_[AdaptiveLockDetail::reader_slot()].value_;
+  }
+
+  void release(std::atomic<uint32_t>& slot) {
+    slot.fetch_sub(1, std::memory_order_seq_cst);
+    // a waiting writer sleeps on the counters
+    if (writer_.value_.load(std::memory_order_seq_cst) != 0) slot.notify_all();
+  }
+
+ private:
+  CacheLinePadded<std::atomic<uint32_t>>
+      readers_[AdaptiveLockDetail::READER_SLOTS];
+  CacheLinePadded<std::atomic<uint32_t>> writer_{0};
+  // orders writers among themselves
+  AdaptiveMutex writer_mtx_;
+};
+
+#endif
@@ -0,0 +1,711 @@
+/**
+ * @file async.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-01
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines a C++20 coroutine runtime on top of ThreadPool.
+ *
+ * Async::Task<Ty> is a lazy coroutine: it starts when awaited and resumes
+ * its awaiter when it finishes, by symmetric transfer, so chains of tasks
+ * take no thread and no stack. Blocking calls have awaitable counterparts
+ * that suspend the coroutine instead of its thread:
+ *
+ *   std::this_thread::sleep_for(d)      co_await Async::sleep_for(d)
+ *   std::this_thread::yield()           co_await Async::yield()
+ *   std::mutex::lock()                  co_await mtx.lock()
+ *   std::counting_semaphore::acquire()  co_await sem.acquire()
+ *
+ * A suspended coroutine is resumed on the pool it was running on, or, if it
+ * was not running on a pool, on the thread that wakes it. A Timer keeps its
+ * sleepers in a heap served by one thread, so any number of pending sleeps
+ * costs one thread in total. A pool must outlive the coroutines that a
+ * timer, mutex or semaphore may still resume on it.
+ *
+ *   Async::Task<int> work(ThreadPool& pool) {
+ *     co_await Async::schedule(pool);          // continue on the pool
+ *     co_await Async::sleep_for(std::chrono::milliseconds(10));
+ *     co_return 42;
+ *   }
+ *   int answer = Async::sync_wait(work(pool)); // block until it is done
+ *
+ * An exception escaping a task is rethrown by co_await or sync_wait; one
+ * escaping a spawn()ed task terminates the program, as with ThreadPool::post.
+ */
+
+#ifndef ASYNC_HPP_
+#define ASYNC_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "adt/linear_list.hpp"
+#include "concurrency/thread_pool.hpp"
+
+namespace Async {
+
+template <class Ty = void>
+class Task;
+
+namespace detail {
+
+// a suspended coroutine and the pool to resume it on
+struct Waiter {
+  std::coroutine_handle<> handle_;
+  ThreadPool* pool_ = nullptr;
+  Waiter* next_ = nullptr;
+
+  // called from await_suspend, before the waiter is published
+  void park(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    pool_ = ThreadPool::current();
+  }
+
+  // the waiter lives in the coroutine frame: it is gone after this call
+  void resume() {
+    std::coroutine_handle<> handle = handle_;
+    if (pool_ != nullptr)
+      pool_->post([handle]() { handle.resume(); });
+    else
+      handle.resume();
+  }
+};
+
+// an intrusive FIFO of waiters
+class WaiterQueue {
+ public:
+  bool empty() const { return head_ == nullptr; }
+
+  void push(Waiter* waiter) {
+    waiter->next_ = nullptr;
+    if (tail_ != nullptr)
+      tail_->next_ = waiter;
+    else
+      head_ = waiter;
+    tail_ = waiter;
+  }
+
+  Waiter* pop() {
+    Waiter* ret = head_;
+    head_ = ret->next_;
+    if (head_ == nullptr) tail_ = nullptr;
+    return ret;
+  }
+
+ private:
+  Waiter* head_ = nullptr;
+  Waiter* tail_ = nullptr;
+};
+
+class PromiseBase {
+ public:
+  // resume the awaiter of the finished task, if any
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+
+    template <class Promise>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<Promise> handle) noexcept {
+      std::coroutine_handle<> next = handle.promise().continuation_;
+      return next ? next : std::noop_coroutine();
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+
+  FinalAwaiter final_suspend() noexcept { return {}; }
+
+  void unhandled_exception() noexcept { error_ = std::current_exception(); }
+
+  std::coroutine_handle<> continuation_;
+
+ protected:
+  void rethrow() {
+    if (error_) std::rethrow_exception(error_);
+  }
+
+  std::exception_ptr error_;
+};
+
+template <class Ty>
+class Promise : public PromiseBase {
+ public:
+  Task<Ty> get_return_object() noexcept;
+
+  template <class U>
+  void return_value(U&& val) {
+    value_.emplace(std::forward<U>(val));
+  }
+
+  Ty result() {
+    rethrow();
+    return std::move(*value_);
+  }
+
+ private:
+  std::optional<Ty> value_;
+};
+
+template <>
+class Promise<void> : public PromiseBase {
+ public:
+  Task<void> get_return_object() noexcept;
+
+  void return_void() noexcept {}
+
+  void result() { rethrow(); }
+};
+
+// a coroutine that starts at once and frees itself when done
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() noexcept { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+};
+
+};  // namespace detail
+
+template <class Ty>
+class Task {
+ public:
+  using promise_type = detail::Promise<Ty>;
+
+ private:
+  struct Awaiter {
+    std::coroutine_handle<promise_type> handle_;
+
+    bool await_ready() noexcept { return handle_.done(); }
+
+    // start the task; it resumes the caller when it is done
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<> caller) noexcept {
+      handle_.promise().continuation_ = caller;
+      return handle_;
+    }
+
+    Ty await_resume() { return handle_.promise().result(); }
+  };
+
+  // constructors & destructor
+ public:
+  Task(Task&& old) noexcept : handle_(std::exchange(old.handle_, nullptr)) {}
+
+  ~Task() {
+    if (handle_) handle_.destroy();
+  }
+
+  Task& operator=(Task&& old) noexcept {
+    if (this != &old) {
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(old.handle_, nullptr);
+    }
+    return *this;
+  }
+
+  // public method
+ public:
+  Awaiter operator co_await() noexcept {
+    assert(handle_ && "co_await on an empty task");
+    return Awaiter{handle_};
+  }
+
+  bool done() const { return handle_ && handle_.done(); }
+
+ private:
+  friend promise_type;
+
+  explicit Task(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  // members
+ private:
+  std::coroutine_handle<promise_type> handle_;
+};
+
+template <class Ty>
+Task<Ty> detail::Promise<Ty>::get_return_object() noexcept {
+  return Task<Ty>(std::coroutine_handle<Promise>::from_promise(*this));
+}
+
+inline Task<void> detail::Promise<void>::get_return_object() noexcept {
+  return Task<void>(std::coroutine_handle<Promise>::from_promise(*this));
+}
+
+/**
+ * @brief
+ *
+ * continue on a worker of pool:
+ *
+ *   co_await Async::schedule(pool);
+ */
+inline auto schedule(ThreadPool& pool) {
+  struct Awaiter {
+    ThreadPool& pool_;
+
+    bool await_ready() noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+      pool_.post([handle]() { handle.resume(); });
+    }
+
+    void await_resume() noexcept {}
+  };
+  return Awaiter{pool};
+}
+
+// let other tasks of the current pool run; a no-op outside of a pool
+inline auto yield() {
+  struct Awaiter {
+    bool await_ready() noexcept { return ThreadPool::current() == nullptr; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+      ThreadPool::current()->post([handle]() { handle.resume(); });
+    }
+
+    void await_resume() noexcept {}
+  };
+  return Awaiter{};
+}
+
+namespace detail {
+
+inline Detached spawn_body(ThreadPool& pool, Task<void> task) {
+  co_await schedule(pool);
+  co_await task;
+}
+
+// the rendezvous of sync_wait and the coroutine it waits for
+struct SyncState {
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  bool done_ = false;
+  std::exception_ptr error_;
+
+  void finish() {
+    // notified under the lock: the waiter destroys *this once it sees done_
+    std::lock_guard<std::mutex> lock(mtx_);
+    done_ = true;
+    cv_.notify_one();
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this]() { return done_; });
+    if (error_) std::rethrow_exception(error_);
+  }
+};
+
+template <class Ty>
+Detached sync_wait_body(Task<Ty>& task, std::optional<Ty>& out,
+                        SyncState& state) {
+  try {
+    out.emplace(co_await task);
+  } catch (...) {
+    state.error_ = std::current_exception();
+  }
+  state.finish();
+}
+
+inline Detached sync_wait_body(Task<void>& task, SyncState& state) {
+  try {
+    co_await task;
+  } catch (...) {
+    state.error_ = std::current_exception();
+  }
+  state.finish();
+}
+
+};  // namespace detail
+
+// run task on pool without a way to wait for it
+inline void spawn(ThreadPool& pool, Task<void> task) {
+  detail::spawn_body(pool, std::move(task));
+}
+
+/**
+ * @brief
+ *
+ * run task, starting on the calling thread, and block until it is done.
+ * This is the way from blocking code into coroutines; calling it from a
+ * worker of the pool the task runs on takes that worker out of service.
+ *
+ * @return Ty the result of the task, or the exception it threw
+ */
+template <class Ty>
+Ty sync_wait(Task<Ty> task) {
+  detail::SyncState state;
+  if constexpr (std::is_void_v<Ty>) {
+    detail::sync_wait_body(task, state);
+    state.wait();
+  } else {
+    std::optional<Ty> out;
+    detail::sync_wait_body(task, out, state);
+    state.wait();
+    return std::move(*out);
+  }
+}
+
+/**
+ * @brief
+ *
+ * a mutex for coroutines: lock() suspends the caller until the mutex is
+ * free, instead of blocking its thread. unlock() hands the mutex directly to
+ * the longest waiting coroutine, so waiters are served in FIFO order.
+ */
+class Mutex {
+  // definitions
+ private:
+  class LockAwaiter : detail::Waiter {
+   public:
+    explicit LockAwaiter(Mutex& mtx) : mtx_(mtx) {}
+
+    bool await_ready() { return mtx_.try_lock(); }
+
+    // false if the mutex was taken after all
+    bool await_suspend(std::coroutine_handle<> handle) {
+      park(handle);
+      return mtx_.wait(this);
+    }
+
+    void await_resume() noexcept {}
+
+   protected:
+    Mutex& mtx_;
+  };
+
+ public:
+  // unlocks the mutex when destroyed
+  class LockGuard {
+   public:
+    explicit LockGuard(Mutex& mtx) : mtx_(&mtx) {}
+
+    LockGuard(LockGuard&& old) noexcept
+        : mtx_(std::exchange(old.mtx_, nullptr)) {}
+
+    ~LockGuard() {
+      if (mtx_ != nullptr) mtx_->unlock();
+    }
+
+   private:
+    Mutex* mtx_;
+  };
+
+ private:
+  class ScopedLockAwaiter : public LockAwaiter {
+   public:
+    using LockAwaiter::LockAwaiter;
+
+    LockGuard await_resume() noexcept { return LockGuard(mtx_); }
+  };
+
+  // constructors & destructor
+ public:
+  Mutex() = default;
+
+  Mutex(const Mutex&) = delete;
+
+  ~Mutex() { assert(waiters_.empty() && "mutex destroyed with waiters"); }
+
+  // public method
+ public:
+  // co_await mtx.lock(); ...; mtx.unlock();
+  LockAwaiter lock() { return LockAwaiter(*this); }
+
+  // auto guard = co_await mtx.scoped_lock();
+  ScopedLockAwaiter scoped_lock() { return ScopedLockAwaiter(*this); }
+
+  bool try_lock() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (locked_) return false;
+    locked_ = true;
+    return true;
+  }
+
+  void unlock() {
+    detail::Waiter* next;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      assert(locked_ && "unlock of an unlocked mutex");
+      if (waiters_.empty()) {
+        locked_ = false;
+        return;
+      }
+      // the mutex stays locked, on behalf of next
+      next = waiters_.pop();
+    }
+    next->resume();
+  }
+
+  // private method
+ private:
+  bool wait(detail::Waiter* waiter) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!locked_) {
+      locked_ = true;
+      return false;
+    }
+    waiters_.push(waiter);
+    return true;
+  }
+
+  // members
+ private:
+  std::mutex mtx_;
+  bool locked_ = false;
+  detail::WaiterQueue waiters_;
+};
+
+/**
+ * @brief
+ *
+ * a counting semaphore for coroutines: acquire() suspends the caller while
+ * no permit is left. Released permits go to waiters in FIFO order.
+ */
+class Semaphore {
+  // definitions
+ private:
+  class AcquireAwaiter : detail::Waiter {
+   public:
+    explicit AcquireAwaiter(Semaphore& sem) : sem_(sem) {}
+
+    bool await_ready() { return sem_.try_acquire(); }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      park(handle);
+      return sem_.wait(this);
+    }
+
+    void await_resume() noexcept {}
+
+   private:
+    Semaphore& sem_;
+  };
+
+  // constructors & destructor
+ public:
+  explicit Semaphore(size_t permits = 0) : permits_(permits) {}
+
+  Semaphore(const Semaphore&) = delete;
+
+  ~Semaphore() {
+    assert(waiters_.empty() && "semaphore destroyed with waiters");
+  }
+
+  // public method
+ public:
+  AcquireAwaiter acquire() { return AcquireAwaiter(*this); }
+
+  bool try_acquire() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (permits_ == 0) return false;
+    --permits_;
+    return true;
+  }
+
+  void release(size_t n = 1) {
+    detail::WaiterQueue woken;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      for (; n > 0 && !waiters_.empty(); --n) woken.push(waiters_.pop());
+      permits_ += n;
+    }
+    while (!woken.empty()) woken.pop()->resume();
+  }
+
+  // the permits left; exact only when nobody else uses the semaphore
+  size_t available() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return permits_;
+  }
+
+  // private method
+ private:
+  bool wait(detail::Waiter* waiter) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (permits_ > 0) {
+      --permits_;
+      return false;
+    }
+    waiters_.push(waiter);
+    return true;
+  }
+
+  // members
+ private:
+  std::mutex mtx_;
+  size_t permits_;
+  detail::WaiterQueue waiters_;
+};
+
+/**
+ * @brief
+ *
+ * a thread serving sleeping coroutines. Sleepers are kept in a binary heap
+ * by deadline; the thread sleeps until the earliest one and wakes every
+ * sleeper due by then in one batch. Destroying the timer wakes the pending
+ * sleepers early.
+ */
+class Timer {
+  // definitions
+ public:
+  using Clock = std::chrono::steady_clock;
+
+ private:
+  struct Entry {
+    Clock::time_point deadline_;
+    // breaks ties, so that equal deadlines wake in the order of sleeping
+    uint64_t seq_;
+    detail::Waiter* waiter_;
+  };
+
+  // heap order, with the earliest entry on top
+  struct Later {
+    bool operator()(const Entry& a, const Entry& b) const {
+      if (a.deadline_ != b.deadline_) return a.deadline_ > b.deadline_;
+      return a.seq_ > b.seq_;
+    }
+  };
+
+  class SleepAwaiter : detail::Waiter {
+   public:
+    SleepAwaiter(Timer& timer, Clock::time_point deadline)
+        : timer_(timer), deadline_(deadline) {}
+
+    bool await_ready() { return deadline_ <= Clock::now(); }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+      park(handle);
+      timer_.add(deadline_, this);
+    }
+
+    void await_resume() noexcept {}
+
+   private:
+    Timer& timer_;
+    Clock::time_point deadline_;
+  };
+
+  // constructors & destructor
+ public:
+  Timer() : thread_([this]() { run(); }) {}
+
+  Timer(const Timer&) = delete;
+
+  ~Timer() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+  // public method
+ public:
+  // the timer behind Async::sleep_for and Async::sleep_until
+  static Timer& global() {
+    static Timer timer;
+    return timer;
+  }
+
+  SleepAwaiter sleep_until(Clock::time_point deadline) {
+    return SleepAwaiter(*this, deadline);
+  }
+
+  template <class Rep, class Period>
+  SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> duration) {
+    return sleep_until(Clock::now() +
+                       std::chrono::ceil<Clock::duration>(duration));
+  }
+
+  // the number of sleepers not woken yet
+  size_t pending() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return heap_.size();
+  }
+
+  // private method
+ private:
+  void add(Clock::time_point deadline, detail::Waiter* waiter) {
+    bool earliest;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      heap_.push_back(Entry{deadline, seq_++, waiter});
+      std::push_heap(heap_.first(), heap_.first() + heap_.size(), Later());
+      earliest = (heap_.front().waiter_ == waiter);
+    }
+    // only a new earliest deadline changes how long the thread sleeps
+    if (earliest) cv_.notify_one();
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (1) {
+      detail::WaiterQueue due;
+      const Clock::time_point now = Clock::now();
+      while (!heap_.empty() && (stop_ || heap_.front().deadline_ <= now)) {
+        due.push(heap_.front().waiter_);
+        std::pop_heap(heap_.first(), heap_.first() + heap_.size(), Later());
+        heap_.pop_back();
+      }
+      if (!due.empty()) {
+        lock.unlock();
+        while (!due.empty()) due.pop()->resume();
+        lock.lock();
+        continue;
+      }
+      if (stop_) break;
+      if (heap_.empty()) {
+        cv_.wait(lock);
+      } else {
+        // by value: the heap may be reallocated while this thread waits
+        const Clock::time_point next = heap_.front().deadline_;
+        cv_.wait_until(lock, next);
+      }
+    }
+  }
+
+  // members
+ private:
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  LinearList<Entry> heap_;
+  uint64_t seq_ = 0;
+  bool stop_ = false;
+  // started last, once everything it uses is constructed
+  std::thread thread_;
+};
+
+// co_await Async::sleep_for(d) suspends the coroutine for at least d
+template <class Rep, class Period>
+auto sleep_for(std::chrono::duration<Rep, Period> duration) {
+  return Timer::global().sleep_for(duration);
+}
+
+inline auto sleep_until(Timer::Clock::time_point deadline) {
+  return Timer::global().sleep_until(deadline);
+}
+
+};  // namespace Async
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ * @file cache_line.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines the cache line size used to keep hot atomics apart.
+ *
+ * std::hardware_destructive_interference_size is not used because its value
+ * may differ between translation units compiled with different flags.
+ */
+
+#ifndef CACHE_LINE_HPP_
+#define CACHE_LINE_HPP_
+
+#include <cstddef>
+
+const static size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief
+ *
+ * a value alone on its cache line(s).
+ */
+template <typename Ty>
+struct alignas(CACHE_LINE_SIZE) CacheLinePadded {
+  Ty value_;
+};
+
+#endif
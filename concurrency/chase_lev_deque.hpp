@@ -0,0 +1,158 @@
+/**
+ * @file chase_lev_deque.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines the Chase-Lev work-stealing deque.
+ *
+ * The owner thread pushes and pops at the bottom without contention; any
+ * other thread may steal from the top. The buffer is a circular array that
+ * the owner doubles when full. Old arrays may still be read by a concurrent
+ * thief, so they are retired rather than freed and released together with
+ * the deque.
+ *
+ * The memory orderings follow Le, Pop, Cohen and Zappa Nardelli, "Correct
+ * and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ */
+
+#ifndef CHASE_LEV_DEQUE_HPP_
+#define CHASE_LEV_DEQUE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#include "adt/linear_list.hpp"
+#include "concurrency/cache_line.hpp"
+
+template <class Ty>
+class ChaseLevDeque {
+  static_assert(std::is_trivially_copyable_v<Ty>,
+                "elements are copied racily and must be trivially copyable");
+
+ private:
+  struct Array {
+    explicit Array(size_t capacity)
+        : mask_(capacity - 1), slots_(new std::atomic<Ty>[capacity]) {}
+
+    ~Array() { delete[] slots_; }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    Ty get(int64_t idx) const {
+      return slots_[idx & mask_].load(std::memory_order_relaxed);
+    }
+
+    void put(int64_t idx, Ty val) {
+      slots_[idx & mask_].store(val, std::memory_order_relaxed);
+    }
+
+    const size_t mask_;
+    std::atomic<Ty>* const slots_;
+  };
+
+ public:
+  explicit ChaseLevDeque(size_t capacity = 64) {
+    top_.value_.store(0, std::memory_order_relaxed);
+    bottom_.value_.store(0, std::memory_order_relaxed);
+    Array* array = new Array(std::bit_ceil(std::max<size_t>(capacity, 2)));
+    array_.store(array, std::memory_order_relaxed);
+    arrays_.push_back(array);
+  }
+
+  ChaseLevDeque(const ChaseLevDeque&) = delete;
+
+  ~ChaseLevDeque() {
+    for (size_t i = 0; i < arrays_.size(); ++i) delete arrays_[i];
+  }
+
+ public:
+  // the approximate number of elements
+  size_t size() const {
+    int64_t b = bottom_.value_.load(std::memory_order_relaxed);
+    int64_t t = top_.value_.load(std::memory_order_relaxed);
+    return b > t ? (size_t)(b - t) : 0;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  // owner only: push at the bottom
+  void push(Ty val) {
+    int64_t b = bottom_.value_.load(std::memory_order_relaxed);
+    int64_t t = top_.value_.load(std::memory_order_acquire);
+    Array* a = array_.load(std::memory_order_relaxed);
+    if (b - t > (int64_t)a->capacity() - 1) a = grow(a, t, b);
+    a->put(b, val);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.value_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // owner only: pop at the bottom, i.e. the most recently pushed element
+  std::optional<Ty> pop() {
+    int64_t b = bottom_.value_.load(std::memory_order_relaxed) - 1;
+    Array* a = array_.load(std::memory_order_relaxed);
+    bottom_.value_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.value_.load(std::memory_order_relaxed);
+
+    std::optional<Ty> ret;
+    if (t <= b) {
+      ret = a->get(b);
+      if (t == b) {
+        // the last element: race the thieves for it
+        if (!top_.value_.compare_exchange_strong(t, t + 1,
+                                                 std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed))
+          ret.reset();
+        bottom_.value_.store(b + 1, std::memory_order_relaxed);
+      }
+    } else {
+      bottom_.value_.store(b + 1, std::memory_order_relaxed);
+    }
+    return ret;
+  }
+
+  // any thread: steal at the top, i.e. the oldest element
+  std::optional<Ty> steal() {
+    int64_t t = top_.value_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.value_.load(std::memory_order_acquire);
+
+    if (t < b) {
+      Array* a = array_.load(std::memory_order_acquire);
+      Ty ret = a->get(t);
+      if (!top_.value_.compare_exchange_strong(t, t + 1,
+                                               std::memory_order_seq_cst,
+                                               std::memory_order_relaxed))
+        return std::nullopt;
+      return ret;
+    }
+    return std::nullopt;
+  }
+
+ private:
+  Array* grow(Array* a, int64_t t, int64_t b) {
+    Array* bigger = new Array(a->capacity() * 2);
+    for (int64_t i = t; i < b; ++i) bigger->put(i, a->get(i));
+    arrays_.push_back(bigger);
+    array_.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+ private:
+  CacheLinePadded<std::atomic<int64_t>> top_;
+  CacheLinePadded<std::atomic<int64_t>> bottom_;
+  std::atomic<Array*> array_;
+  // every array ever used, owned by the deque; only the owner appends
+  LinearList<Array*> arrays_;
+};
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * @file epoch_reclaimer.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-27
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines epoch-based reclamation (Fraser, 2004), a reclaimer for
+ * the lock-free containers with the interface of HazardPointerDomain.
+ *
+ * A Guard pins the global epoch for the duration of an operation instead of
+ * protecting single nodes, so protect() is a plain load and readers never
+ * write anything shared per node. A retired node goes to the limbo bag of
+ * the guard's record for the epoch current at retirement. The epoch only
+ * advances when every pinned guard has seen it, so a bag two epochs old can
+ * no longer be reached and is freed as a whole.
+ *
+ * Every ADVANCE_EVERY retirements a guard tries to advance the epoch and
+ * frees its expired bags. Memory thus stays bounded under sustained churn as
+ * long as operations are short: unlike hazard pointers, a guard that stays
+ * pinned holds back everything retired after it started.
+ */
+
+#ifndef EPOCH_RECLAIMER_HPP_
+#define EPOCH_RECLAIMER_HPP_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "adt/linear_list.hpp"
+#include "concurrency/cache_line.hpp"
+
+class EpochReclaimer {
+  // definitions
+ public:
+  using Deleter = void (*)(void* ptr, void* ctx);
+
+  // retirements between two attempts to advance the epoch
+  static constexpr size_t ADVANCE_EVERY = 64;
+
+ private:
+  struct Retired {
+    void* ptr_;
+    Deleter deleter_;
+    void* ctx_;
+  };
+
+  // the nodes retired in one epoch
+  struct Bag {
+    uint64_t epoch_ = 0;
+    LinearList<Retired> nodes_;
+  };
+
+  // the pinned epoch and limbo bags of one guard at a time
+  struct alignas(CACHE_LINE_SIZE) Record {
+    // (epoch << 1) | 1 while pinned, 0 while quiescent
+    std::atomic<uint64_t> local_{0};
+    std::atomic<bool> in_use_{true};
+    // immutable once the record is published
+    Record* next_ = nullptr;
+    // touched only by the guard holding the record; an epoch e lives in
+    // bags_[e % 3], the bags of e - 1 and e - 2 may still be unsafe
+    Bag bags_[3];
+    size_t retired_since_advance_ = 0;
+  };
+
+ public:
+  class Guard {
+   public:
+    explicit Guard(EpochReclaimer& reclaimer)
+        : reclaimer_(reclaimer), record_(reclaimer.acquire()) {
+      const uint64_t epoch =
+          reclaimer_.epoch_.value_.load(std::memory_order_relaxed);
+      // release: whatever the record's previous guard read happens before
+      // an advance that sees this pin
+      record_->local_.store((epoch << 1) | 1, std::memory_order_release);
+      // the pin must be visible before any node is read
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    Guard(const Guard&) = delete;
+
+    ~Guard() {
+      record_->local_.store(0, std::memory_order_release);
+      record_->in_use_.store(false, std::memory_order_release);
+    }
+
+    // the epoch keeps every reachable node alive: a plain load suffices
+    template <class Ty>
+    Ty* protect(size_t, const std::atomic<Ty*>& src) {
+      return src.load(std::memory_order_acquire);
+    }
+
+    void set(size_t, void*) {}
+
+    void retire(void* ptr, Deleter deleter, void* ctx) {
+      // tagged with the epoch after the unlink, not the pinned one
+      const uint64_t epoch =
+          reclaimer_.epoch_.value_.load(std::memory_order_seq_cst);
+      Bag& bag = record_->bags_[epoch % 3];
+      // a bag reused for a later epoch holds nodes at least 3 epochs old
+      if (bag.epoch_ != epoch) {
+        free_bag(bag);
+        bag.epoch_ = epoch;
+      }
+      bag.nodes_.push_back(Retired{ptr, deleter, ctx});
+
+      if (++record_->retired_since_advance_ >= ADVANCE_EVERY) {
+        record_->retired_since_advance_ = 0;
+        const uint64_t now = reclaimer_.try_advance();
+        for (Bag& old : record_->bags_)
+          if (old.epoch_ + 2 <= now) free_bag(old);
+      }
+    }
+
+   private:
+    EpochReclaimer& reclaimer_;
+    Record* record_;
+  };
+
+  // constructors & destructor
+ public:
+  EpochReclaimer() { epoch_.value_.store(0, std::memory_order_relaxed); }
+
+  EpochReclaimer(const EpochReclaimer&) = delete;
+
+  ~EpochReclaimer() {
+    drain();
+    Record* rec = records_.load(std::memory_order_acquire);
+    while (rec != nullptr) {
+      Record* next = rec->next_;
+      delete rec;
+      rec = next;
+    }
+  }
+
+  // public method
+ public:
+  // free every retired node; no guard of the reclaimer may be alive
+  void drain() {
+    for (Record* rec = records_.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next_) {
+      assert(!rec->in_use_.load() && "drain with a live guard");
+      for (Bag& bag : rec->bags_) free_bag(bag);
+    }
+  }
+
+  // the number of retired nodes not freed yet; exact only when quiescent
+  size_t pending() const {
+    size_t ret = 0;
+    for (Record* rec = records_.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next_)
+      for (const Bag& bag : rec->bags_) ret += bag.nodes_.size();
+    return ret;
+  }
+
+  uint64_t epoch() const {
+    return epoch_.value_.load(std::memory_order_acquire);
+  }
+
+  // private method
+ private:
+  static void free_bag(Bag& bag) {
+    for (size_t i = 0; i < bag.nodes_.size(); ++i)
+      bag.nodes_[i].deleter_(bag.nodes_[i].ptr_, bag.nodes_[i].ctx_);
+    bag.nodes_.clear();
+  }
+
+  // take an idle record, or publish a new one
+  Record* acquire() {
+    for (Record* rec = records_.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next_) {
+      bool idle = false;
+      if (!rec->in_use_.load(std::memory_order_relaxed) &&
+          rec->in_use_.compare_exchange_strong(idle, true,
+                                               std::memory_order_acquire))
+        return rec;
+    }
+    Record* rec = new Record;
+    Record* head = records_.load(std::memory_order_relaxed);
+    do {
+      rec->next_ = head;
+    } while (!records_.compare_exchange_weak(head, rec,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+    return rec;
+  }
+
+  // advance the epoch if every pinned guard has seen it; returns the epoch
+  uint64_t try_advance() {
+    uint64_t epoch = epoch_.value_.load(std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (Record* rec = records_.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next_) {
+      // acquire: the nodes a finished guard read happen before their free
+      const uint64_t local = rec->local_.load(std::memory_order_acquire);
+      if ((local & 1) && (local >> 1) != epoch) return epoch;
+    }
+    if (epoch_.value_.compare_exchange_strong(epoch, epoch + 1,
+                                              std::memory_order_seq_cst))
+      return epoch + 1;
+    return epoch;
+  }
+
+  // members
+ private:
+  CacheLinePadded<std::atomic<uint64_t>> epoch_;
+  std::atomic<Record*> records_{nullptr};
+};
+
+#endif
@@ -0,0 +1,227 @@
+/**
+ * @file hazard_pointer.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-26
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines hazard pointers (Michael, 2004), a safe memory
+ * reclamation scheme for lock-free containers.
+ *
+ * A thread publishes every node it is about to dereference in one of the
+ * SLOTS hazard pointers of its Guard. A node unlinked from the container is
+ * retired rather than freed; once enough nodes are retired, the retiring
+ * thread frees those no hazard pointer refers to. At most
+ * SLOTS * (number of guards) retired nodes can be held back at any time.
+ *
+ * A concurrent container owns its reclaimer, and uses it like this:
+ *
+ *   Reclaimer::Guard guard(reclaimer_);         // for one operation
+ *   Node* cur = guard.protect(0, head_);        // safe to dereference
+ *   guard.retire(cur, &Container::reclaim, this);
+ *
+ * Every reclaimer provides this interface:
+ *   Guard(Reclaimer&)              enter an operation
+ *   guard.protect(slot, src)       load src and keep the node alive
+ *   guard.set(slot, ptr)           keep ptr, already protected, alive
+ *   guard.retire(ptr, fn, ctx)     call fn(ptr, ctx) once it is unreachable
+ *   drain()                        free everything; no guard may be alive
+ *
+ * protect() ignores the lowest bit of the loaded pointer, so that marked
+ * pointers may be protected as they are.
+ */
+
+#ifndef HAZARD_POINTER_HPP_
+#define HAZARD_POINTER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "adt/linear_list.hpp"
+#include "concurrency/cache_line.hpp"
+
+class HazardPointerDomain {
+  // definitions
+ public:
+  using Deleter = void (*)(void* ptr, void* ctx);
+
+  // hazard pointers per guard
+  static constexpr size_t SLOTS = 3;
+  // a guard scans once it holds this many retired nodes, or twice the
+  // number of hazard pointers if that is more
+  static constexpr size_t SCAN_THRESHOLD = 64;
+
+ private:
+  struct Retired {
+    void* ptr_;
+    Deleter deleter_;
+    void* ctx_;
+  };
+
+  // the hazard pointers and retired nodes of one guard at a time
+  struct alignas(CACHE_LINE_SIZE) Record {
+    std::atomic<void*> hazards_[SLOTS] = {};
+    std::atomic<bool> active_{true};
+    // immutable once the record is published
+    Record* next_ = nullptr;
+    // touched only by the guard holding the record
+    LinearList<Retired> retired_;
+  };
+
+ public:
+  class Guard {
+   public:
+    explicit Guard(HazardPointerDomain& domain)
+        : domain_(domain), record_(domain.acquire()) {}
+
+    Guard(const Guard&) = delete;
+
+    ~Guard() {
+      for (size_t i = 0; i < SLOTS; ++i)
+        record_->hazards_[i].store(nullptr, std::memory_order_release);
+      record_->active_.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief
+     *
+     * load src and protect the node it points to in the given slot. The
+     * returned value, including its mark bit, is what src held at a moment
+     * the node was protected.
+     */
+    template <class Ty>
+    Ty* protect(size_t slot, const std::atomic<Ty*>& src) {
+      Ty* ptr = src.load(std::memory_order_acquire);
+      while (1) {
+        record_->hazards_[slot].store(unmark(ptr), std::memory_order_seq_cst);
+        Ty* again = src.load(std::memory_order_seq_cst);
+        if (again == ptr) return ptr;
+        ptr = again;
+      }
+    }
+
+    // protect ptr, which shall already be protected by another slot
+    void set(size_t slot, void* ptr) {
+      record_->hazards_[slot].store(ptr, std::memory_order_release);
+    }
+
+    void retire(void* ptr, Deleter deleter, void* ctx) {
+      record_->retired_.push_back(Retired{ptr, deleter, ctx});
+      if (record_->retired_.size() >= domain_.threshold())
+        domain_.scan(record_);
+    }
+
+   private:
+    template <class Ty>
+    static Ty* unmark(Ty* ptr) {
+      return reinterpret_cast<Ty*>(reinterpret_cast<uintptr_t>(ptr) &
+                                   ~(uintptr_t)1);
+    }
+
+   private:
+    HazardPointerDomain& domain_;
+    Record* record_;
+  };
+
+  // constructors & destructor
+ public:
+  HazardPointerDomain() = default;
+
+  HazardPointerDomain(const HazardPointerDomain&) = delete;
+
+  ~HazardPointerDomain() {
+    drain();
+    Record* rec = records_.load(std::memory_order_acquire);
+    while (rec != nullptr) {
+      Record* next = rec->next_;
+      delete rec;
+      rec = next;
+    }
+  }
+
+  // public method
+ public:
+  // free every retired node; no guard of the domain may be alive
+  void drain() {
+    for (Record* rec = records_.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next_) {
+      assert(!rec->active_.load() && "drain with a live guard");
+      for (size_t i = 0; i < rec->retired_.size(); ++i)
+        rec->retired_[i].deleter_(rec->retired_[i].ptr_,
+                                  rec->retired_[i].ctx_);
+      rec->retired_.clear();
+    }
+  }
+
+  // the number of retired nodes not freed yet; exact only when quiescent
+  size_t pending() const {
+    size_t ret = 0;
+    for (Record* rec = records_.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next_)
+      ret += rec->retired_.size();
+    return ret;
+  }
+
+  // private method
+ private:
+  // take an idle record, or publish a new one
+  Record* acquire() {
+    for (Record* rec = records_.load(std::memory_order_acquire);
+         rec != nullptr; rec = rec->next_) {
+      bool idle = false;
+      if (!rec->active_.load(std::memory_order_relaxed) &&
+          rec->active_.compare_exchange_strong(idle, true,
+                                               std::memory_order_acquire))
+        return rec;
+    }
+    Record* rec = new Record;
+    Record* head = records_.load(std::memory_order_relaxed);
+    do {
+      rec->next_ = head;
+    } while (!records_.compare_exchange_weak(head, rec,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed));
+    record_count_.fetch_add(1, std::memory_order_relaxed);
+    return rec;
+  }
+
+  size_t threshold() const {
+    return std::max(SCAN_THRESHOLD,
+                    2 * SLOTS * record_count_.load(std::memory_order_relaxed));
+  }
+
+  // free the retired nodes of rec that no hazard pointer refers to
+  void scan(Record* rec) {
+    LinearList<void*> hazards;
+    for (Record* cur = records_.load(std::memory_order_acquire);
+         cur != nullptr; cur = cur->next_)
+      for (size_t i = 0; i < SLOTS; ++i)
+        if (void* ptr = cur->hazards_[i].load(std::memory_order_seq_cst))
+          hazards.push_back(ptr);
+    void** begin = hazards.first();
+    void** end = begin + hazards.size();
+    std::sort(begin, end);
+
+    LinearList<Retired>& retired = rec->retired_;
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); ++i) {
+      if (std::binary_search(begin, end, retired[i].ptr_))
+        retired[kept++] = retired[i];
+      else
+        retired[i].deleter_(retired[i].ptr_, retired[i].ctx_);
+    }
+    while (retired.size() > kept) retired.pop_back();
+  }
+
+  // members
+ private:
+  std::atomic<Record*> records_{nullptr};
+  std::atomic<size_t> record_count_{0};
+};
+
+#endif
@@ -0,0 +1,331 @@
+/**
+ * @file parallel_algorithm.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-23
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines parallel algorithms over contiguous ranges, i.e. spans
+ * and LinearLists, running on a ThreadPool.
+ *
+ * A range is cut into chunks of whole cache lines, at least MIN_CHUNK_BYTES
+ * long, about CHUNKS_PER_WORKER per worker so that stealing can even out
+ * uneven chunks. The calling thread takes part in the work; called from a
+ * task of the same pool, the algorithms fork and join like any nested task.
+ *
+ * for_each_chunk() hands whole chunks to a span kernel, which is the way to
+ * combine with the batch kernels:
+ *
+ *   ParallelAlgorithm::for_each_chunk(pool, list, [](std::span<float> s) {
+ *     CarmackBatch::rsqrt_inplace(s);
+ *   });
+ *
+ * If a callable throws, the algorithm still waits for every chunk and then
+ * rethrows the first exception; the range is left in an unspecified state.
+ */
+
+#ifndef PARALLEL_ALGORITHM_HPP_
+#define PARALLEL_ALGORITHM_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <span>
+#include <utility>
+
+#include "adt/linear_list.hpp"
+#include "concurrency/cache_line.hpp"
+#include "concurrency/thread_pool.hpp"
+
+namespace ParallelAlgorithm {
+
+const static size_t MIN_CHUNK_BYTES = 16 * 1024;
+const static size_t CHUNKS_PER_WORKER = 4;
+
+/**
+ * @brief
+ *
+ * the number of elements per chunk when n elements of Ty are spread over
+ * the given number of workers.
+ */
+template <class Ty>
+size_t chunk_size(size_t n, size_t workers) {
+  const size_t line = std::max<size_t>(CACHE_LINE_SIZE / sizeof(Ty), 1);
+  const size_t chunks = std::max<size_t>(workers, 1) * CHUNKS_PER_WORKER;
+  size_t ret = std::max((n + chunks - 1) / chunks,
+                        std::max<size_t>(MIN_CHUNK_BYTES / sizeof(Ty), 1));
+  return (ret + line - 1) / line * line;
+}
+
+namespace detail {
+
+// run fn(begin, end, idx) for every chunk of [0, n) on the pool
+template <class Fn>
+void run_chunks(ThreadPool& pool, size_t n, size_t chunk, Fn&& fn) {
+  const size_t chunks = (n + chunk - 1) / chunk;
+  if (chunks <= 1) {
+    if (n) fn(size_t(0), n, size_t(0));
+    return;
+  }
+  LinearList<std::future<void>> futures;
+  futures.reserve(chunks - 1);
+  for (size_t k = 1; k < chunks; ++k)
+    futures.push_back(pool.submit([&fn, k, chunk, n]() {
+      fn(k * chunk, std::min(n, (k + 1) * chunk), k);
+    }));
+
+  std::exception_ptr error;
+  try {
+    fn(size_t(0), chunk, size_t(0));
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // the tasks refer to this frame: join all of them before leaving it
+  for (size_t k = 0; k < futures.size(); ++k) {
+    try {
+      pool.wait(futures[k]);
+    } catch (...) {
+      if (!error) error = std::current_exception();
+    }
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+// fn() on the pool and gn() here, then join
+template <class Fn, class Gn>
+void fork_join(ThreadPool& pool, Fn&& fn, Gn&& gn) {
+  std::future<void> left = pool.submit(std::ref(fn));
+  std::exception_ptr error;
+  try {
+    gn();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  try {
+    pool.wait(left);
+  } catch (...) {
+    if (!error) error = std::current_exception();
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+// merge the sorted ranges x and y into out, moving the elements
+template <class Ty, class Compare>
+void merge(ThreadPool& pool, Ty* x, size_t nx, Ty* y, size_t ny, Ty* out,
+           Compare& cmp, size_t grain) {
+  if (nx + ny <= grain) {
+    std::merge(std::make_move_iterator(x), std::make_move_iterator(x + nx),
+               std::make_move_iterator(y), std::make_move_iterator(y + ny),
+               out, cmp);
+    return;
+  }
+  if (nx < ny) std::swap(x, y), std::swap(nx, ny);
+  // split the longer run at its middle and the other at the same value
+  const size_t mx = nx / 2;
+  const size_t my = std::lower_bound(y, y + ny, x[mx], cmp) - y;
+  out[mx + my] = std::move(x[mx]);
+  fork_join(
+      pool, [&]() { detail::merge(pool, x, mx, y, my, out, cmp, grain); },
+      [&]() {
+        detail::merge(pool, x + mx + 1, nx - mx - 1, y + my, ny - my,
+                      out + mx + my + 1, cmp, grain);
+      });
+}
+
+/**
+ * @brief
+ *
+ * sort a[0, n) with b[0, n) as scratch space. The result ends up in b if
+ * into_b is set, otherwise in a.
+ */
+template <class Ty, class Compare>
+void sort(ThreadPool& pool, Ty* a, Ty* b, size_t n, bool into_b,
+          Compare& cmp, size_t grain) {
+  if (n <= grain) {
+    std::sort(a, a + n, cmp);
+    if (into_b) std::move(a, a + n, b);
+    return;
+  }
+  // sort both halves into the other buffer, then merge them back
+  const size_t half = n / 2;
+  fork_join(
+      pool, [&]() { detail::sort(pool, a, b, half, !into_b, cmp, grain); },
+      [&]() {
+        detail::sort(pool, a + half, b + half, n - half, !into_b, cmp,
+                     grain);
+      });
+  Ty* src = into_b ? a : b;
+  Ty* dst = into_b ? b : a;
+  detail::merge(pool, src, half, src + half, n - half, dst, cmp, grain);
+}
+
+}  // namespace detail
+
+/**
+ * @brief
+ *
+ * call fn(std::span<Ty>) once for every chunk of data.
+ */
+template <class Ty, class Fn>
+void for_each_chunk(ThreadPool& pool, std::span<Ty> data, Fn fn) {
+  detail::run_chunks(pool, data.size(),
+                     chunk_size<Ty>(data.size(), pool.size()),
+                     [&](size_t begin, size_t end, size_t) {
+                       fn(data.subspan(begin, end - begin));
+                     });
+}
+
+// call fn(Ty&) for every element of data
+template <class Ty, class Fn>
+void for_each(ThreadPool& pool, std::span<Ty> data, Fn fn) {
+  for_each_chunk(pool, data, [&fn](std::span<Ty> chunk) {
+    for (Ty& elem : chunk) fn(elem);
+  });
+}
+
+/**
+ * @brief
+ *
+ * out[i] = fn(in[i]) for every element of in. out shall hold at least as
+ * many elements as in, and may be the same range.
+ */
+template <class In, class Out, class Fn>
+void transform(ThreadPool& pool, std::span<In> in, std::span<Out> out,
+               Fn fn) {
+  assert((out.size() >= in.size()) && "transform output range too short");
+  detail::run_chunks(pool, in.size(), chunk_size<In>(in.size(), pool.size()),
+                     [&](size_t begin, size_t end, size_t) {
+                       for (size_t i = begin; i < end; ++i)
+                         out[i] = fn(in[i]);
+                     });
+}
+
+/**
+ * @brief
+ *
+ * fold data with op, starting from init. op shall be associative; the
+ * operands are combined in their order in data.
+ */
+template <class Ty, class Val, class Op = std::plus<>>
+Val reduce(ThreadPool& pool, std::span<Ty> data, Val init, Op op = Op()) {
+  if (data.empty()) return init;
+  const size_t chunk = chunk_size<Ty>(data.size(), pool.size());
+  const size_t chunks = (data.size() + chunk - 1) / chunk;
+  LinearList<Val> partial;
+  partial.reserve(chunks);
+  for (size_t k = 0; k < chunks; ++k) partial.emplace_back(data[k * chunk]);
+
+  detail::run_chunks(pool, data.size(), chunk,
+                     [&](size_t begin, size_t end, size_t k) {
+                       Val acc = partial[k];
+                       for (size_t i = begin + 1; i < end; ++i)
+                         acc = op(std::move(acc), data[i]);
+                       partial[k] = std::move(acc);
+                     });
+  for (size_t k = 0; k < chunks; ++k) init = op(std::move(init), partial[k]);
+  return init;
+}
+
+/**
+ * @brief
+ *
+ * replace data with its inclusive prefix fold under op, i.e. data[i] becomes
+ * data[0] op data[1] op ... op data[i]. op shall be associative.
+ *
+ * Every chunk is scanned on its own, the chunk totals are scanned serially,
+ * and each chunk but the first is then offset by the total before it. The
+ * work is about twice that of a serial scan.
+ */
+template <class Ty, class Op = std::plus<>>
+void scan(ThreadPool& pool, std::span<Ty> data, Op op = Op()) {
+  if (data.empty()) return;
+  const size_t chunk = chunk_size<Ty>(data.size(), pool.size());
+  const size_t chunks = (data.size() + chunk - 1) / chunk;
+
+  detail::run_chunks(pool, data.size(), chunk,
+                     [&](size_t begin, size_t end, size_t) {
+                       for (size_t i = begin + 1; i < end; ++i)
+                         data[i] = op(data[i - 1], data[i]);
+                     });
+  if (chunks == 1) return;
+
+  // carry[k] is the fold of every chunk before chunk k + 1
+  LinearList<Ty> carry;
+  carry.reserve(chunks - 1);
+  carry.push_back(data[chunk - 1]);
+  for (size_t k = 1; k + 1 < chunks; ++k)
+    carry.push_back(op(carry[k - 1], data[(k + 1) * chunk - 1]));
+
+  detail::run_chunks(pool, data.size() - chunk, chunk,
+                     [&](size_t begin, size_t end, size_t k) {
+                       for (size_t i = chunk + begin; i < chunk + end; ++i)
+                         data[i] = op(carry[k], data[i]);
+                     });
+}
+
+/**
+ * @brief
+ *
+ * sort data by cmp, a parallel merge sort whose merges are split in parallel
+ * too. The sort is not stable. Ty shall be copy constructible; a copy of
+ * data serves as scratch space.
+ */
+template <class Ty, class Compare = std::less<>>
+void sort(ThreadPool& pool, std::span<Ty> data, Compare cmp = Compare()) {
+  const size_t grain = chunk_size<Ty>(data.size(), pool.size());
+  if (data.size() <= grain) {
+    std::sort(data.begin(), data.end(), cmp);
+    return;
+  }
+  LinearList<Ty> scratch(data.data(), data.size());
+  detail::sort(pool, data.data(), scratch.first(), data.size(), false, cmp,
+               grain);
+}
+
+// LinearList overloads
+
+template <class Ty, class Growth, class Fn>
+void for_each_chunk(ThreadPool& pool, LinearList<Ty, Growth>& list, Fn fn) {
+  for_each_chunk(pool, std::span<Ty>(list.first(), list.size()),
+                 std::move(fn));
+}
+
+template <class Ty, class Growth, class Fn>
+void for_each(ThreadPool& pool, LinearList<Ty, Growth>& list, Fn fn) {
+  for_each(pool, std::span<Ty>(list.first(), list.size()), std::move(fn));
+}
+
+template <class In, class GIn, class Out, class GOut, class Fn>
+void transform(ThreadPool& pool, const LinearList<In, GIn>& in,
+               LinearList<Out, GOut>& out, Fn fn) {
+  transform(pool, std::span<const In>(in.first(), in.size()),
+            std::span<Out>(out.first(), out.size()), std::move(fn));
+}
+
+template <class Ty, class Growth, class Val, class Op = std::plus<>>
+Val reduce(ThreadPool& pool, const LinearList<Ty, Growth>& list, Val init,
+           Op op = Op()) {
+  return reduce(pool, std::span<const Ty>(list.first(), list.size()),
+                std::move(init), std::move(op));
+}
+
+template <class Ty, class Growth, class Op = std::plus<>>
+void scan(ThreadPool& pool, LinearList<Ty, Growth>& list, Op op = Op()) {
+  scan(pool, std::span<Ty>(list.first(), list.size()), std::move(op));
+}
+
+template <class Ty, class Growth, class Compare = std::less<>>
+void sort(ThreadPool& pool, LinearList<Ty, Growth>& list,
+          Compare cmp = Compare()) {
+  sort(pool, std::span<Ty>(list.first(), list.size()), std::move(cmp));
+}
+
+};  // namespace ParallelAlgorithm
+
+#endif
@@ -0,0 +1,224 @@
+/**
+ * @file profiled_mutex.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines ProfiledMutex, a drop-in std::mutex that records how it
+ * is used: the number of acquisitions, how many of them had to wait, and
+ * log2 histograms of the time spent waiting for and holding the lock.
+ *
+ * lock() first tries try_lock(), so an uncontended acquisition reads the
+ * clock only once, to start the hold timer. The counters are striped over
+ * STRIPES cache lines, each thread always using the same stripe, and are
+ * only summed up when stats() is called.
+ *
+ * Compiling with HYPERION_LOCK_PROFILING=0 turns ProfiledMutex into a plain
+ * std::mutex whose stats() are always zero.
+ */
+
+#ifndef PROFILED_MUTEX_HPP_
+#define PROFILED_MUTEX_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "concurrency/cache_line.hpp"
+
+#ifndef HYPERION_LOCK_PROFILING
+#define HYPERION_LOCK_PROFILING 1
+#endif
+
+namespace ProfiledMutexDetail {
+
+const static size_t STRIPES = 8;
+// bucket 0 counts zero durations, bucket b > 0 durations in [2^(b-1), 2^b)
+// nanoseconds; the last bucket also takes everything longer
+const static size_t BUCKETS = 32;
+
+inline size_t bucket(uint64_t ns) {
+  return std::min<size_t>(std::bit_width(ns), BUCKETS - 1);
+}
+
+// the stripe of the calling thread
+inline size_t stripe_index() {
+  static std::atomic<size_t> next{0};
+  static thread_local size_t idx =
+      next.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+  return idx;
+}
+
+inline uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+};  // namespace ProfiledMutexDetail
+
+/**
+ * @brief
+ *
+ * a snapshot of the counters of a ProfiledMutex. Times are in nanoseconds.
+ */
+struct ProfiledMutexStats {
+  uint64_t acquisitions = 0;
+  // acquisitions which found the mutex locked and had to block
+  uint64_t contended = 0;
+  uint64_t failed_try_locks = 0;
+  uint64_t wait_ns = 0, hold_ns = 0;
+  uint64_t wait_hist[ProfiledMutexDetail::BUCKETS] = {};
+  uint64_t hold_hist[ProfiledMutexDetail::BUCKETS] = {};
+
+  double contention_ratio() const {
+    return acquisitions ? (double)contended / acquisitions : 0.0;
+  }
+
+  /**
+   * @brief
+   *
+   * the upper bound of the histogram bucket holding the p-th quantile, i.e.
+   * a duration at most twice the true quantile.
+   */
+  static uint64_t quantile(
+      const uint64_t (&hist)[ProfiledMutexDetail::BUCKETS], double p) {
+    uint64_t total = 0;
+    for (uint64_t n : hist) total += n;
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(p * (total - 1)), seen = 0;
+    for (size_t b = 0; b < ProfiledMutexDetail::BUCKETS; ++b) {
+      seen += hist[b];
+      if (seen > rank) return b ? ((uint64_t)1 << b) - 1 : 0;
+    }
+    return UINT64_MAX;
+  }
+};
+
+#if HYPERION_LOCK_PROFILING
+
+class ProfiledMutex {
+ private:
+  struct alignas(CACHE_LINE_SIZE) Stripe {
+    std::atomic<uint64_t> acquisitions_{0}, contended_{0}, failed_{0};
+    std::atomic<uint64_t> wait_ns_{0}, hold_ns_{0};
+    std::atomic<uint64_t> wait_hist_[ProfiledMutexDetail::BUCKETS] = {};
+    std::atomic<uint64_t> hold_hist_[ProfiledMutexDetail::BUCKETS] = {};
+  };
+
+ public:
+  ProfiledMutex() = default;
+
+  ProfiledMutex(const ProfiledMutex&) = delete;
+
+  ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+ public:
+  void lock() {
+    if (mtx_.try_lock()) {
+      // uncontended: the wait is recorded as zero without reading the clock
+      record_acquire(0, false);
+      locked_at_ = ProfiledMutexDetail::now_ns();
+      return;
+    }
+    const uint64_t begin = ProfiledMutexDetail::now_ns();
+    mtx_.lock();
+    locked_at_ = ProfiledMutexDetail::now_ns();
+    record_acquire(locked_at_ - begin, true);
+  }
+
+  bool try_lock() {
+    if (!mtx_.try_lock()) {
+      inc(stripe().failed_, 1);
+      return false;
+    }
+    record_acquire(0, false);
+    locked_at_ = ProfiledMutexDetail::now_ns();
+    return true;
+  }
+
+  void unlock() {
+    const uint64_t held = ProfiledMutexDetail::now_ns() - locked_at_;
+    mtx_.unlock();
+    // recorded after unlocking, so that waiters do not pay for it
+    Stripe& s = stripe();
+    inc(s.hold_ns_, held);
+    inc(s.hold_hist_[ProfiledMutexDetail::bucket(held)], 1);
+  }
+
+  // sum the stripes up; concurrent updates may or may not be included
+  ProfiledMutexStats stats() const {
+    ProfiledMutexStats ret;
+    for (const Stripe& s : stripes_) {
+      ret.acquisitions += s.acquisitions_.load(std::memory_order_relaxed);
+      ret.contended += s.contended_.load(std::memory_order_relaxed);
+      ret.failed_try_locks += s.failed_.load(std::memory_order_relaxed);
+      ret.wait_ns += s.wait_ns_.load(std::memory_order_relaxed);
+      ret.hold_ns += s.hold_ns_.load(std::memory_order_relaxed);
+      for (size_t b = 0; b < ProfiledMutexDetail::BUCKETS; ++b) {
+        ret.wait_hist[b] += s.wait_hist_[b].load(std::memory_order_relaxed);
+        ret.hold_hist[b] += s.hold_hist_[b].load(std::memory_order_relaxed);
+      }
+    }
+    return ret;
+  }
+
+  void reset() {
+    for (Stripe& s : stripes_) {
+      s.acquisitions_.store(0, std::memory_order_relaxed);
+      s.contended_.store(0, std::memory_order_relaxed);
+      s.failed_.store(0, std::memory_order_relaxed);
+      s.wait_ns_.store(0, std::memory_order_relaxed);
+      s.hold_ns_.store(0, std::memory_order_relaxed);
+      for (size_t b = 0; b < ProfiledMutexDetail::BUCKETS; ++b) {
+        s.wait_hist_[b].store(0, std::memory_order_relaxed);
+        s.hold_hist_[b].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+ private:
+  Stripe& stripe() { return stripes_[ProfiledMutexDetail::stripe_index()]; }
+
+  // only the owning stripe's threads write, so a plain add would mostly do;
+  // the atomic keeps threads sharing a stripe exact
+  static void inc(std::atomic<uint64_t>& counter, uint64_t val) {
+    counter.fetch_add(val, std::memory_order_relaxed);
+  }
+
+  void record_acquire(uint64_t waited, bool contended) {
+    Stripe& s = stripe();
+    inc(s.acquisitions_, 1);
+    if (contended) {
+      inc(s.contended_, 1);
+      inc(s.wait_ns_, waited);
+    }
+    inc(s.wait_hist_[ProfiledMutexDetail::bucket(waited)], 1);
+  }
+
+ private:
+  std::mutex mtx_;
+  // written only by the holder of mtx_
+  uint64_t locked_at_ = 0;
+  Stripe stripes_[ProfiledMutexDetail::STRIPES];
+};
+
+#else
+
+class ProfiledMutex : public std::mutex {
+ public:
+  ProfiledMutexStats stats() const { return ProfiledMutexStats(); }
+
+  void reset() {}
+};
+
+#endif
+
+#endif
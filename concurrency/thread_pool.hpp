@@ -0,0 +1,291 @@
+/**
+ * @file thread_pool.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines the work-stealing thread pool.
+ *
+ * Every worker owns a Chase-Lev deque. Tasks submitted from a worker go to
+ * the bottom of its own deque and are popped LIFO, which keeps nested
+ * fork/join work hot in cache; idle workers steal the oldest tasks from the
+ * top of other deques. Tasks submitted from outside the pool go through a
+ * shared injection queue. Workers with nothing to do park on a condition
+ * variable instead of spinning.
+ *
+ * wait() on a future runs other tasks until the future is ready, so a task
+ * may fork subtasks and join them without blocking its worker.
+ */
+
+#ifndef THREAD_POOL_HPP_
+#define THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "adt/linear_list.hpp"
+#include "concurrency/chase_lev_deque.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+class ThreadPool {
+  // definitions
+ private:
+  struct TaskBase {
+    virtual ~TaskBase() = default;
+    virtual void run() = 0;
+  };
+
+  template <class F>
+  struct Task : TaskBase {
+    explicit Task(F&& fn) : fn_(std::move(fn)) {}
+    void run() override { fn_(); }
+    F fn_;
+  };
+
+  struct Worker {
+    ChaseLevDeque<TaskBase*> deque_;
+    std::thread thread_;
+  };
+
+  // constructors & destructor
+ public:
+  /**
+   * @brief
+   *
+   * start the workers.
+   *
+   * @param threads the number of workers; hardware_concurrency() by default
+   * @param pin_threads bind worker i to CPU i (Linux only)
+   */
+  explicit ThreadPool(size_t threads = default_threads(),
+                      bool pin_threads = false) {
+    threads = std::max<size_t>(threads, 1);
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) workers_.emplace_back(new Worker);
+    for (size_t i = 0; i < threads; ++i) {
+      workers_[i]->thread_ = std::thread([this, i]() { worker_loop(i); });
+      if (pin_threads) pin(workers_[i]->thread_, i);
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+
+  // runs every task submitted so far, then joins the workers
+  ~ThreadPool() {
+    // a task posted from outside may finish, and its submitter destroy the
+    // pool, before the post itself returns: let such posts leave first
+    while (posting_.load() > 0) std::this_thread::yield();
+    {
+      std::lock_guard<std::mutex> lock(sleep_mtx_);
+      stop_.store(true);
+    }
+    sleep_cv_.notify_all();
+    // other workers may still be stealing from a joined worker's deque
+    for (size_t i = 0; i < workers_.size(); ++i) workers_[i]->thread_.join();
+    for (size_t i = 0; i < workers_.size(); ++i) delete workers_[i];
+  }
+
+  // public method
+ public:
+  static size_t default_threads() {
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+
+  size_t size() const { return workers_.size(); }
+
+  // the pool the calling thread works for, or nullptr
+  static ThreadPool* current() { return current_pool(); }
+
+  /**
+   * @brief
+   *
+   * run fn(args...) on the pool without a way to wait for it. An exception
+   * escaping fn terminates the program.
+   */
+  template <class F, class... Args>
+  void post(F&& fn, Args&&... args) {
+    auto call = [fn = std::forward<F>(fn),
+                 ... args = std::forward<Args>(args)]() mutable {
+      std::invoke(std::move(fn), std::move(args)...);
+    };
+    enqueue(new Task<decltype(call)>(std::move(call)));
+  }
+
+  /**
+   * @brief
+   *
+   * run fn(args...) on the pool.
+   *
+   * @return std::future the result, or the exception thrown by fn
+   */
+  template <class F, class... Args>
+  auto submit(F&& fn, Args&&... args)
+      -> std::future<std::invoke_result_t<F, Args...>> {
+    using Ret = std::invoke_result_t<F, Args...>;
+    std::packaged_task<Ret()> task(
+        [fn = std::forward<F>(fn),
+         ... args = std::forward<Args>(args)]() mutable -> Ret {
+          return std::invoke(std::move(fn), std::move(args)...);
+        });
+    std::future<Ret> ret = task.get_future();
+    enqueue(new Task<std::packaged_task<Ret()>>(std::move(task)));
+    return ret;
+  }
+
+  /**
+   * @brief
+   *
+   * wait for fut, running other tasks of the pool meanwhile, and return its
+   * result. This is the join of nested fork/join: it is safe to call from a
+   * task even when every worker is busy.
+   */
+  template <class Ty>
+  Ty wait(std::future<Ty>& fut) {
+    while (fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+      if (!run_one()) std::this_thread::yield();
+    return fut.get();
+  }
+
+  // run one pending task on the calling thread, if there is any
+  bool run_one() {
+    TaskBase* task = take(current_index());
+    if (task == nullptr) return false;
+    task->run();
+    delete task;
+    return true;
+  }
+
+  // private method
+ private:
+  static ThreadPool*& current_pool() {
+    static thread_local ThreadPool* pool = nullptr;
+    return pool;
+  }
+
+  static size_t& current_worker() {
+    static thread_local size_t index = 0;
+    return index;
+  }
+
+  // the worker index of the calling thread in this pool, or size()
+  size_t current_index() const {
+    return current_pool() == this ? current_worker() : workers_.size();
+  }
+
+  void enqueue(TaskBase* task) {
+    const size_t self = current_index();
+    const bool outside = self >= workers_.size();
+    if (outside) posting_.fetch_add(1);
+    // counted before it is visible, so that pending_ never underflows
+    pending_.fetch_add(1);
+    if (!outside) {
+      workers_[self]->deque_.push(task);
+    } else {
+      std::lock_guard<std::mutex> lock(inject_mtx_);
+      injected_.push_back(task);
+    }
+    if (sleeping_.load() > 0) {
+      // taking the lock orders this against a worker about to sleep
+      { std::lock_guard<std::mutex> lock(sleep_mtx_); }
+      sleep_cv_.notify_one();
+    }
+    if (outside) posting_.fetch_sub(1);
+  }
+
+  // find a task: own deque, then the injection queue, then steal
+  TaskBase* take(size_t self) {
+    if (pending_.load(std::memory_order_relaxed) == 0) return nullptr;
+    TaskBase* task = nullptr;
+    if (self < workers_.size()) {
+      if (auto own = workers_[self]->deque_.pop()) task = *own;
+    }
+    if (task == nullptr) {
+      std::lock_guard<std::mutex> lock(inject_mtx_);
+      if (!injected_.empty()) {
+        task = injected_.front();
+        injected_.pop_front();
+      }
+    }
+    for (size_t k = 1; task == nullptr && k <= workers_.size(); ++k) {
+      size_t victim = (self + k) % workers_.size();
+      if (victim == self) continue;
+      if (auto stolen = workers_[victim]->deque_.steal()) task = *stolen;
+    }
+    if (task != nullptr) pending_.fetch_sub(1);
+    return task;
+  }
+
+  void worker_loop(size_t self) {
+    current_pool() = this;
+    current_worker() = self;
+    while (1) {
+      TaskBase* task = nullptr;
+      // a short spin before parking: new work often arrives in bursts
+      for (int spin = 0; spin < 64 && task == nullptr; ++spin) {
+        task = take(self);
+        if (task == nullptr) std::this_thread::yield();
+      }
+      if (task != nullptr) {
+        task->run();
+        delete task;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mtx_);
+      sleeping_.fetch_add(1);
+      sleep_cv_.wait(lock, [this]() {
+        return stop_.load() || pending_.load() > 0;
+      });
+      sleeping_.fetch_sub(1);
+      if (stop_.load() && pending_.load() == 0) break;
+    }
+    current_pool() = nullptr;
+  }
+
+  static void pin(std::thread& thread, size_t idx) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(idx % std::max<size_t>(std::thread::hardware_concurrency(), 1),
+            &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread, (void)idx;
+#endif
+  }
+
+  // members
+ private:
+  LinearList<Worker*> workers_;
+
+  std::mutex inject_mtx_;
+  std::deque<TaskBase*> injected_;
+
+  // tasks submitted but not taken yet
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> sleeping_{0};
+  // posts from non-worker threads still inside enqueue
+  std::atomic<size_t> posting_{0};
+  std::atomic<bool> stop_{false};
+  std::mutex sleep_mtx_;
+  std::condition_variable sleep_cv_;
+};
+
+#endif
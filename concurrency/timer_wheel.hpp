@@ -0,0 +1,466 @@
+/**
+ * @file timer_wheel.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines a hierarchical hashed timer wheel and a driver that runs
+ * its callbacks on a ThreadPool.
+ *
+ * TimerWheel<Fn> counts time in ticks. It has four levels of 256 slots; a
+ * slot of level l spans 256^l ticks, so the wheel covers 2^32 ticks ahead
+ * and a timer further out is parked in the last level until it comes into
+ * range. A timer lives in an intrusive list of one slot, which makes
+ * schedule and cancel O(1). When the wheel passes a multiple of 256^l, the
+ * due slot of level l is cascaded into the levels below, so every timer
+ * moves at most three times before it expires. advance() jumps over empty
+ * stretches using a bitmap of the occupied slots, so a sparse wheel costs
+ * nothing per idle tick.
+ *
+ *   TimerWheel<> wheel;
+ *   auto handle = wheel.schedule_after(30, [] { puts("timeout"); });
+ *   wheel.cancel(handle);     // or let it fire:
+ *   wheel.advance(wheel.now() + 30);
+ *
+ * Expired callbacks are handed out as a batch, in tick order; timers that
+ * expire on the same tick come out in no particular order. TimerWheel is not
+ * thread safe.
+ *
+ * TimerWheelDriver owns a wheel with a steady_clock resolution, a thread
+ * that sleeps until the next tick with work to do, and posts expired
+ * callbacks to a ThreadPool, up to BATCH of them per pool task. The pool
+ * must outlive the driver.
+ */
+
+#ifndef TIMER_WHEEL_HPP_
+#define TIMER_WHEEL_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "adt/linear_list.hpp"
+#include "concurrency/thread_pool.hpp"
+
+namespace TimerWheelDetail {
+const static size_t LEVELS = 4;
+const static size_t SLOT_BITS = 8;
+const static size_t SLOTS = size_t(1) << SLOT_BITS;
+const static uint64_t SLOT_MASK = SLOTS - 1;
+// ticks covered by the wheel ahead of the current tick
+const static uint64_t SPAN = uint64_t(1) << (SLOT_BITS * LEVELS);
+const static uint32_t NIL = UINT32_MAX;
+const static uint64_t NEVER = UINT64_MAX;
+};  // namespace TimerWheelDetail
+
+template <class Fn = std::function<void()>>
+class TimerWheel {
+  // definitions
+ public:
+  // identifies a scheduled timer; stale once it fired or was cancelled
+  struct Handle {
+    uint32_t index_ = TimerWheelDetail::NIL;
+    uint32_t generation_ = 0;
+  };
+
+ private:
+  struct Node {
+    Fn fn_;
+    uint64_t expiry_;
+    uint32_t prev_, next_;
+    // level * SLOTS + slot, or NIL while the node is free
+    uint32_t slot_;
+    uint32_t generation_;
+  };
+
+  using Bitmap = uint64_t[TimerWheelDetail::SLOTS / 64];
+
+  // constructors & destructor
+ public:
+  // a wheel whose current tick is start
+  explicit TimerWheel(uint64_t start = 0) : now_(start) {
+    std::fill(heads_, heads_ + TimerWheelDetail::LEVELS *
+                                   TimerWheelDetail::SLOTS,
+              TimerWheelDetail::NIL);
+    for (size_t l = 0; l < TimerWheelDetail::LEVELS; ++l)
+      std::fill(occupied_[l], occupied_[l] + TimerWheelDetail::SLOTS / 64,
+                uint64_t(0));
+  }
+
+  TimerWheel(const TimerWheel&) = delete;
+
+  ~TimerWheel() = default;
+
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // public method
+ public:
+  // the last tick advance() reached
+  uint64_t now() const { return now_; }
+
+  // the number of timers not fired or cancelled yet
+  size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * @brief
+   *
+   * run fn at tick expiry. A tick not after now() means the next tick.
+   */
+  Handle schedule_at(uint64_t expiry, Fn fn) {
+    uint32_t idx;
+    if (free_ != TimerWheelDetail::NIL) {
+      idx = free_;
+      free_ = nodes_[idx].next_;
+      nodes_[idx].fn_ = std::move(fn);
+    } else {
+      assert((nodes_.size() < TimerWheelDetail::NIL) && "too many timers");
+      idx = (uint32_t)nodes_.size();
+      nodes_.push_back(Node{std::move(fn), 0, TimerWheelDetail::NIL,
+                            TimerWheelDetail::NIL, TimerWheelDetail::NIL, 0});
+    }
+    nodes_[idx].expiry_ = std::max(expiry, now_ + 1);
+    place(idx, now_ + 1);
+    ++size_;
+    return Handle{idx, nodes_[idx].generation_};
+  }
+
+  // run fn ticks after now(), and at the next tick for zero
+  Handle schedule_after(uint64_t ticks, Fn fn) {
+    return schedule_at(now_ + ticks, std::move(fn));
+  }
+
+  // whether handle refers to a timer that has not fired or been cancelled
+  bool active(Handle handle) const {
+    return handle.index_ < nodes_.size() &&
+           nodes_[handle.index_].generation_ == handle.generation_ &&
+           nodes_[handle.index_].slot_ != TimerWheelDetail::NIL;
+  }
+
+  // drop the timer; false if it already fired or was cancelled
+  bool cancel(Handle handle) {
+    if (!active(handle)) return false;
+    unlink(handle.index_);
+    nodes_[handle.index_].fn_ = Fn();
+    release(handle.index_);
+    --size_;
+    return true;
+  }
+
+  /**
+   * @brief
+   *
+   * move the wheel to tick and append the callbacks of every timer that
+   * expired on the way to due, in tick order. The callbacks are not run.
+   *
+   * @return size_t the number of expired timers
+   */
+  size_t advance(uint64_t tick, LinearList<Fn>& due) {
+    const size_t before = due.size();
+    while (now_ < tick) {
+      // jump straight to the next tick that expires or cascades anything
+      const uint64_t next = next_tick();
+      if (next > tick) {
+        now_ = tick;
+        break;
+      }
+      now_ = next - 1;
+      step(due);
+    }
+    return due.size() - before;
+  }
+
+  // move the wheel to tick and run the expired callbacks
+  size_t advance(uint64_t tick) {
+    LinearList<Fn> due;
+    advance(tick, due);
+    // the wheel is consistent again: callbacks may schedule and cancel
+    for (size_t i = 0; i < due.size(); ++i) due[i]();
+    return due.size();
+  }
+
+  /**
+   * @brief
+   *
+   * the earliest tick at which advance() has work to do: a timer expires or
+   * a slot cascades. No timer expires before it. NEVER for an empty wheel.
+   */
+  uint64_t next_tick() const {
+    using namespace TimerWheelDetail;
+    if (size_ == 0) return NEVER;
+    const uint64_t from = now_ + 1;
+    uint64_t ret = NEVER;
+    for (size_t l = 0; l < LEVELS; ++l) {
+      const size_t shift = SLOT_BITS * l;
+      // the first tick at or after from that level l acts on
+      const uint64_t unit = ((from - 1) >> shift) + 1;
+      const uint64_t base = (unit & ~SLOT_MASK) << shift;
+      size_t slot = find(occupied_[l], unit & SLOT_MASK);
+      if (slot < SLOTS) {
+        ret = std::min(ret, base + ((uint64_t)slot << shift));
+        continue;
+      }
+      // the occupied slots of this level come round in the next rotation
+      slot = find(occupied_[l], 0);
+      if (slot < SLOTS)
+        ret = std::min(ret, base + ((SLOTS + (uint64_t)slot) << shift));
+    }
+    return ret;
+  }
+
+  // private method
+ private:
+  // put node idx into the slot for its expiry, seen from tick base
+  void place(uint32_t idx, uint64_t base) {
+    using namespace TimerWheelDetail;
+    Node& node = nodes_[idx];
+    const uint64_t delta = node.expiry_ - base;
+    // beyond the wheel: wait in the last level and be placed again later
+    const uint64_t at = delta < SPAN ? node.expiry_ : base + SPAN - 1;
+    size_t level = 0;
+    while (level + 1 < LEVELS && (at - base) >> (SLOT_BITS * (level + 1)))
+      ++level;
+    const size_t slot = (at >> (SLOT_BITS * level)) & SLOT_MASK;
+    link(idx, (uint32_t)(level * SLOTS + slot));
+  }
+
+  void link(uint32_t idx, uint32_t slot) {
+    Node& node = nodes_[idx];
+    node.slot_ = slot;
+    node.prev_ = TimerWheelDetail::NIL;
+    node.next_ = heads_[slot];
+    if (node.next_ != TimerWheelDetail::NIL) nodes_[node.next_].prev_ = idx;
+    heads_[slot] = idx;
+    mark(slot, true);
+  }
+
+  void unlink(uint32_t idx) {
+    Node& node = nodes_[idx];
+    if (node.prev_ != TimerWheelDetail::NIL)
+      nodes_[node.prev_].next_ = node.next_;
+    else
+      heads_[node.slot_] = node.next_;
+    if (node.next_ != TimerWheelDetail::NIL)
+      nodes_[node.next_].prev_ = node.prev_;
+    if (heads_[node.slot_] == TimerWheelDetail::NIL) mark(node.slot_, false);
+  }
+
+  // detach the whole list of slot and return its first node
+  uint32_t take(uint32_t slot) {
+    const uint32_t ret = heads_[slot];
+    heads_[slot] = TimerWheelDetail::NIL;
+    mark(slot, false);
+    return ret;
+  }
+
+  void release(uint32_t idx) {
+    Node& node = nodes_[idx];
+    node.slot_ = TimerWheelDetail::NIL;
+    ++node.generation_;
+    node.next_ = free_;
+    free_ = idx;
+  }
+
+  // process tick now_ + 1: cascade the due upper slots, then expire
+  void step(LinearList<Fn>& due) {
+    using namespace TimerWheelDetail;
+    const uint64_t tick = now_ + 1;
+    for (size_t l = 1; l < LEVELS; ++l) {
+      if (tick & ((uint64_t(1) << (SLOT_BITS * l)) - 1)) break;
+      const size_t slot = (tick >> (SLOT_BITS * l)) & SLOT_MASK;
+      uint32_t idx = take((uint32_t)(l * SLOTS + slot));
+      while (idx != NIL) {
+        const uint32_t next = nodes_[idx].next_;
+        place(idx, tick);
+        idx = next;
+      }
+    }
+    uint32_t idx = take((uint32_t)(tick & SLOT_MASK));
+    while (idx != NIL) {
+      const uint32_t next = nodes_[idx].next_;
+      due.push_back(std::move(nodes_[idx].fn_));
+      nodes_[idx].fn_ = Fn();
+      release(idx);
+      --size_;
+      idx = next;
+    }
+    now_ = tick;
+  }
+
+  void mark(uint32_t slot, bool on) {
+    const size_t level = slot / TimerWheelDetail::SLOTS;
+    const size_t bit = slot % TimerWheelDetail::SLOTS;
+    if (on)
+      occupied_[level][bit / 64] |= uint64_t(1) << (bit % 64);
+    else
+      occupied_[level][bit / 64] &= ~(uint64_t(1) << (bit % 64));
+  }
+
+  // the first occupied slot at or after from, or SLOTS
+  static size_t find(const Bitmap& bits, size_t from) {
+    for (size_t word = from / 64; word < TimerWheelDetail::SLOTS / 64;
+         ++word) {
+      uint64_t val = bits[word];
+      if (word == from / 64) val &= ~uint64_t(0) << (from % 64);
+      if (val) return word * 64 + std::countr_zero(val);
+    }
+    return TimerWheelDetail::SLOTS;
+  }
+
+  // members
+ private:
+  LinearList<Node> nodes_;
+  uint32_t free_ = TimerWheelDetail::NIL;
+  uint32_t heads_[TimerWheelDetail::LEVELS * TimerWheelDetail::SLOTS];
+  Bitmap occupied_[TimerWheelDetail::LEVELS];
+  uint64_t now_;
+  size_t size_ = 0;
+};
+
+class TimerWheelDriver {
+  // definitions
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Callback = std::function<void()>;
+  using Handle = TimerWheel<Callback>::Handle;
+
+  // the most callbacks run by one pool task
+  static constexpr size_t BATCH = 256;
+
+  // constructors & destructor
+ public:
+  /**
+   * @brief
+   *
+   * start the driver thread.
+   *
+   * @param pool the pool expired callbacks run on
+   * @param resolution the length of a tick; deadlines are rounded up to it
+   */
+  explicit TimerWheelDriver(
+      ThreadPool& pool,
+      Clock::duration resolution = std::chrono::milliseconds(1))
+      : pool_(pool),
+        resolution_(std::max(resolution, Clock::duration(1))),
+        start_(Clock::now()),
+        thread_([this]() { run(); }) {}
+
+  TimerWheelDriver(const TimerWheelDriver&) = delete;
+
+  // stop the thread; timers that have not expired are dropped
+  ~TimerWheelDriver() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+
+  // public method
+ public:
+  Handle schedule_at(Clock::time_point deadline, Callback fn) {
+    // round up, so that no callback runs before its deadline
+    const uint64_t tick =
+        deadline <= start_
+            ? 0
+            : (uint64_t)((deadline - start_ + resolution_ -
+                          Clock::duration(1)) /
+                         resolution_);
+    Handle ret;
+    bool sooner;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      ret = wheel_.schedule_at(tick, std::move(fn));
+      sooner = std::max(tick, wheel_.now() + 1) < wake_tick_;
+    }
+    if (sooner) cv_.notify_one();
+    return ret;
+  }
+
+  template <class Rep, class Period>
+  Handle schedule_after(std::chrono::duration<Rep, Period> duration,
+                        Callback fn) {
+    return schedule_at(
+        Clock::now() + std::chrono::ceil<Clock::duration>(duration),
+        std::move(fn));
+  }
+
+  bool cancel(Handle handle) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return wheel_.cancel(handle);
+  }
+
+  // the number of timers not expired or cancelled yet
+  size_t pending() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return wheel_.size();
+  }
+
+  // private method
+ private:
+  uint64_t current_tick() const {
+    return (uint64_t)((Clock::now() - start_) / resolution_);
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (!stop_) {
+      LinearList<Callback> due;
+      wheel_.advance(current_tick(), due);
+      if (!due.empty()) {
+        lock.unlock();
+        dispatch(due);
+        lock.lock();
+        continue;
+      }
+      wake_tick_ = wheel_.next_tick();
+      if (wake_tick_ == TimerWheelDetail::NEVER)
+        cv_.wait(lock);
+      else
+        cv_.wait_until(lock, start_ + resolution_ * (int64_t)wake_tick_);
+      wake_tick_ = 0;
+    }
+  }
+
+  // hand due to the pool in tasks of up to BATCH callbacks
+  void dispatch(LinearList<Callback>& due) {
+    for (size_t begin = 0; begin < due.size(); begin += BATCH) {
+      const size_t end = std::min(begin + BATCH, due.size());
+      LinearList<Callback> batch;
+      batch.reserve(end - begin);
+      for (size_t i = begin; i < end; ++i) batch.push_back(std::move(due[i]));
+      pool_.post([batch = std::move(batch)]() mutable {
+        for (size_t i = 0; i < batch.size(); ++i) batch[i]();
+      });
+    }
+  }
+
+  // members
+ private:
+  ThreadPool& pool_;
+  const Clock::duration resolution_;
+  const Clock::time_point start_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  TimerWheel<Callback> wheel_;
+  // the tick the thread sleeps until; 0 while it is awake
+  uint64_t wake_tick_ = 0;
+  bool stop_ = false;
+  // started last, once everything it uses is constructed
+  std::thread thread_;
+};
+
+#endif
@@ -0,0 +1,240 @@
+/**
+ * @file test_bplus_tree.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-04
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "adt/bplus_tree.hpp"
+#include "adt/linear_list.hpp"
+#include "gtest/gtest.h"
+
+// the elements of map, in the order for_each visits them
+template <class Map>
+static LinearList<std::pair<uint64_t, uint64_t>> dump(const Map& map) {
+  LinearList<std::pair<uint64_t, uint64_t>> ret;
+  map.for_each([&](const uint64_t& key, const uint64_t& val) {
+    ret.push_back({key, val});
+  });
+  return ret;
+}
+
+// the smallest nodes: four elements a leaf, many levels
+using TinyMap = BPlusTreeMap<uint64_t, uint64_t, std::less<uint64_t>, 64>;
+// integer keys under a comparator other than std::less: no padded search
+using PlainMap =
+    BPlusTreeMap<uint64_t, uint64_t, std::function<bool(uint64_t, uint64_t)>,
+                 64>;
+
+TEST(BPlusTreeTest, InsertFindErase) {
+  BPlusTreeMap<uint64_t, uint64_t> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.height(), 0u);
+  EXPECT_EQ(map.find(1), nullptr);
+  EXPECT_FALSE(map.erase(1));
+
+  for (uint64_t i = 0; i < 10000; ++i) EXPECT_TRUE(map.insert(i * 2, i));
+  EXPECT_FALSE(map.insert(10, 0));
+  EXPECT_EQ(map.size(), 10000u);
+  EXPECT_GE(map.height(), 2u);
+  for (uint64_t i = 0; i < 10000; ++i) {
+    ASSERT_NE(map.find(i * 2), nullptr);
+    ASSERT_EQ(*map.find(i * 2), i);
+    ASSERT_FALSE(map.contains(i * 2 + 1));
+  }
+  EXPECT_FALSE(map.insert_or_assign(10, 100));
+  EXPECT_EQ(*map.find(10), 100u);
+  // the largest key is also the padding of the search
+  EXPECT_FALSE(map.contains(UINT64_MAX));
+  EXPECT_TRUE(map.insert(UINT64_MAX, 1));
+  EXPECT_TRUE(map.contains(UINT64_MAX));
+
+  for (uint64_t i = 0; i < 10000; ++i) ASSERT_TRUE(map.erase(i * 2));
+  EXPECT_TRUE(map.erase(UINT64_MAX));
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.height(), 0u);
+  EXPECT_TRUE(map.insert(3, 3));
+  EXPECT_EQ(map.height(), 1u);
+}
+
+template <class Map>
+static void check_against_std_map(Map& map) {
+  std::mt19937_64 rng(5);
+  std::map<uint64_t, uint64_t> ref;
+  for (int op = 0; op < 100000; ++op) {
+    const uint64_t key = rng() % 3000, val = rng();
+    switch (rng() % 5) {
+      case 0:
+      case 1:
+        ASSERT_EQ(map.insert_or_assign(key, val),
+                  ref.insert_or_assign(key, val).second);
+        break;
+      case 2:
+      case 3:
+        ASSERT_EQ(map.erase(key), ref.erase(key) == 1);
+        break;
+      default: {
+        // a range scan
+        const uint64_t hi = key + rng() % 200;
+        auto it = ref.lower_bound(key);
+        bool same = true;
+        map.for_range(key, hi, [&](const uint64_t& k, uint64_t& v) {
+          same = same && it != ref.end() && it->first == k &&
+                 it->second == v;
+          ++it;
+        });
+        ASSERT_TRUE(same);
+        ASSERT_TRUE(it == ref.end() || it->first >= hi);
+      }
+    }
+    ASSERT_EQ(map.size(), ref.size());
+  }
+  const auto elems = dump(map);
+  ASSERT_EQ(elems.size(), ref.size());
+  size_t i = 0;
+  for (auto& [key, val] : ref) {
+    ASSERT_EQ(elems[i].first, key);
+    ASSERT_EQ(elems[i].second, val);
+    ++i;
+  }
+}
+
+TEST(BPlusTreeTest, MatchesStdMap) {
+  BPlusTreeMap<uint64_t, uint64_t> map;
+  check_against_std_map(map);
+  // splits, borrows and merges on every level
+  TinyMap tiny;
+  EXPECT_EQ(TinyMap::leaf_capacity(), 4u);
+  check_against_std_map(tiny);
+  PlainMap plain(std::less<uint64_t>{});
+  check_against_std_map(plain);
+  // page-sized nodes: the padded search narrows before it counts
+  BPlusTreeMap<uint64_t, uint64_t, std::less<uint64_t>, 4096> page;
+  check_against_std_map(page);
+}
+
+TEST(BPlusTreeTest, EraseEverythingInAnyOrder) {
+  std::mt19937_64 rng(9);
+  for (int round = 0; round < 5; ++round) {
+    TinyMap map;
+    LinearList<uint64_t> keys;
+    for (uint64_t i = 0; i < 2000; ++i) keys.push_back(i);
+    std::shuffle(keys.first(), keys.first() + keys.size(), rng);
+    for (size_t i = 0; i < keys.size(); ++i) map.insert(keys[i], i);
+    std::shuffle(keys.first(), keys.first() + keys.size(), rng);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      ASSERT_TRUE(map.erase(keys[i]));
+      if (i % 97 == 0) {
+        // the leaves stay linked and sorted
+        const auto elems = dump(map);
+        ASSERT_EQ(elems.size(), keys.size() - i - 1);
+        for (size_t j = 1; j < elems.size(); ++j)
+          ASSERT_LT(elems[j - 1].first, elems[j].first);
+      }
+    }
+    EXPECT_TRUE(map.empty());
+  }
+}
+
+TEST(BPlusTreeTest, BulkLoad) {
+  for (size_t n : {0, 1, 3, 4, 5, 17, 1000, 12345}) {
+    LinearList<std::pair<uint64_t, uint64_t>> sorted;
+    for (uint64_t i = 0; i < n; ++i) sorted.push_back({i * 3, i});
+    TinyMap map;
+    map.insert(1, 1);
+    map.bulk_load(sorted);
+    ASSERT_EQ(map.size(), n);
+    const auto elems = dump(map);
+    for (size_t i = 0; i < n; ++i) ASSERT_EQ(elems[i], sorted[i]);
+    // a loaded tree takes inserts and erases like a grown one
+    for (uint64_t i = 0; i < n; ++i) ASSERT_TRUE(map.insert(i * 3 + 1, i));
+    for (uint64_t i = 0; i < n; ++i) ASSERT_TRUE(map.erase(i * 3));
+    ASSERT_EQ(map.size(), n);
+    for (uint64_t i = 0; i < n; ++i) ASSERT_TRUE(map.contains(i * 3 + 1));
+  }
+
+  // a loaded tree is no taller than a grown one
+  LinearList<std::pair<uint64_t, uint64_t>> sorted;
+  for (uint64_t i = 0; i < 100000; ++i) sorted.push_back({i, i});
+  BPlusTreeMap<uint64_t, uint64_t> loaded, grown;
+  loaded.bulk_load(sorted);
+  for (uint64_t i = 0; i < 100000; ++i) grown.insert(i, i);
+  EXPECT_LE(loaded.height(), grown.height());
+}
+
+TEST(BPlusTreeTest, SetAndStringKeys) {
+  BPlusTreeSet<std::string, std::less<std::string>, 128> set;
+  std::set<std::string> ref;
+  std::mt19937_64 rng(13);
+  for (int i = 0; i < 5000; ++i) {
+    const std::string key = "key" + std::to_string(rng() % 2000);
+    if (rng() % 3)
+      ASSERT_EQ(set.insert(key), ref.insert(key).second);
+    else
+      ASSERT_EQ(set.erase(key), ref.erase(key) == 1);
+  }
+  ASSERT_EQ(set.size(), ref.size());
+  auto it = ref.begin();
+  set.for_each([&](const std::string& key) {
+    ASSERT_EQ(key, *it);
+    ++it;
+  });
+  size_t in_range = 0;
+  set.for_range("key1", "key2", [&](const std::string&) { ++in_range; });
+  EXPECT_EQ(in_range, std::distance(ref.lower_bound("key1"),
+                                    ref.lower_bound("key2")));
+
+  // copies are deep
+  BPlusTreeSet<std::string, std::less<std::string>, 128> copy(set);
+  copy.insert("zzz");
+  EXPECT_FALSE(set.contains("zzz"));
+  EXPECT_EQ(copy.size(), set.size() + 1);
+  set = std::move(copy);
+  EXPECT_TRUE(set.contains("zzz"));
+}
+
+TEST(BPlusTreeTest, ArgumentsIntoTheTree) {
+  // the inserted values refer to elements that the insertion shifts
+  BPlusTreeMap<uint64_t, std::string> map;
+  map.insert(10, "ten");
+  map.insert(20, "twenty");
+  EXPECT_TRUE(map.insert(5, *map.find(20)));
+  EXPECT_EQ(*map.find(5), "twenty");
+
+  // ... or moves to a new leaf
+  BPlusTreeMap<uint64_t, std::string, std::less<uint64_t>, 64> tiny;
+  const size_t n = decltype(tiny)::leaf_capacity();
+  for (uint64_t i = 0; i < n; ++i) tiny.insert(i * 10 + 10, std::to_string(i));
+  EXPECT_TRUE(tiny.insert(1, *tiny.find(n * 10)));
+  EXPECT_EQ(*tiny.find(1), std::to_string(n - 1));
+  EXPECT_TRUE(tiny.insert_or_assign(2, *tiny.find(20)));
+  EXPECT_EQ(*tiny.find(2), "1");
+
+  // a key that is a value of the tree
+  BPlusTreeMap<std::string, std::string, std::less<std::string>, 64> names;
+  for (int i = 0; i < 4; ++i)
+    names.insert("k" + std::to_string(i), "k" + std::to_string(i + 4));
+  EXPECT_TRUE(names.insert(*names.find("k3"), *names.find("k0")));
+  ASSERT_NE(names.find("k7"), nullptr);
+  EXPECT_EQ(*names.find("k7"), "k4");
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,260 @@
+/**
+ * @file test_concurrent_linked_list.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-26
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "adt/concurrent_linked_list.hpp"
+#include "concurrency/epoch_reclaimer.hpp"
+#include "concurrency/hazard_pointer.hpp"
+#include "gtest/gtest.h"
+
+// counts live objects, to catch leaks and double frees
+struct Tracked {
+  static inline std::atomic<int64_t> live{0};
+
+  explicit Tracked(uint64_t v = 0) : value_(v) { live++; }
+  Tracked(const Tracked& oth) : value_(oth.value_) { live++; }
+  Tracked(Tracked&& oth) noexcept : value_(oth.value_) { live++; }
+  ~Tracked() { live--; }
+  bool operator<(const Tracked& oth) const { return value_ < oth.value_; }
+
+  uint64_t value_;
+};
+
+TEST(HazardPointerTest, ProtectedNodesSurviveScans) {
+  HazardPointerDomain domain;
+  std::atomic<int*> shared{new int(42)};
+  int freed = 0;
+  auto deleter = [](void* ptr, void* ctx) {
+    delete static_cast<int*>(ptr);
+    ++*static_cast<int*>(ctx);
+  };
+
+  HazardPointerDomain::Guard reader(domain);
+  int* seen = reader.protect(0, shared);
+  {
+    HazardPointerDomain::Guard writer(domain);
+    shared.store(nullptr);
+    writer.retire(seen, deleter, &freed);
+    // enough retirements to force scans: only the protected one survives
+    for (size_t i = 0; i < 2 * HazardPointerDomain::SCAN_THRESHOLD; ++i)
+      writer.retire(new int(0), deleter, &freed);
+  }
+  EXPECT_EQ(*seen, 42);
+  EXPECT_GE(freed, (int)HazardPointerDomain::SCAN_THRESHOLD);
+  EXPECT_GE(domain.pending(), 1u);
+
+  reader.set(0, nullptr);
+  int before = freed;
+  {
+    // a new guard takes over an idle record with its retired nodes
+    HazardPointerDomain::Guard writer(domain);
+    for (size_t i = 0; i < 2 * HazardPointerDomain::SCAN_THRESHOLD; ++i)
+      writer.retire(new int(0), deleter, &freed);
+  }
+  EXPECT_GT(freed, before);
+}
+
+TEST(EpochReclaimerTest, PinnedGuardHoldsBackFrees) {
+  EpochReclaimer reclaimer;
+  int freed = 0;
+  auto deleter = [](void* ptr, void* ctx) {
+    delete static_cast<int*>(ptr);
+    ++*static_cast<int*>(ctx);
+  };
+
+  {
+    auto reader = std::make_unique<EpochReclaimer::Guard>(reclaimer);
+    std::thread([&]() {
+      EpochReclaimer::Guard writer(reclaimer);
+      for (size_t i = 0; i < 8 * EpochReclaimer::ADVANCE_EVERY; ++i)
+        writer.retire(new int(0), deleter, &freed);
+    }).join();
+    // the reader pinned the first epoch: it can advance once, no further
+    EXPECT_EQ(freed, 0);
+    EXPECT_LE(reclaimer.epoch(), 1u);
+    reader.reset();
+  }
+
+  // with short operations only, the epoch moves on and the bags are freed in
+  // batches
+  for (size_t i = 0; i < 8 * EpochReclaimer::ADVANCE_EVERY; ++i) {
+    EpochReclaimer::Guard writer(reclaimer);
+    writer.retire(new int(0), deleter, &freed);
+  }
+  EXPECT_GE(reclaimer.epoch(), 3u);
+  EXPECT_GT(freed, 0);
+  EXPECT_LE(reclaimer.pending(), 3 * EpochReclaimer::ADVANCE_EVERY);
+  reclaimer.drain();
+  EXPECT_EQ(freed, (int)(16 * EpochReclaimer::ADVANCE_EVERY));
+}
+
+// every container test runs with each reclaimer
+template <class Reclaimer>
+class ConcurrentQueueTest : public testing::Test {};
+template <class Reclaimer>
+class ConcurrentOrderedListTest : public testing::Test {};
+
+using Reclaimers = testing::Types<HazardPointerDomain, EpochReclaimer>;
+TYPED_TEST_SUITE(ConcurrentQueueTest, Reclaimers);
+TYPED_TEST_SUITE(ConcurrentOrderedListTest, Reclaimers);
+
+TYPED_TEST(ConcurrentQueueTest, SingleThread) {
+  {
+    ConcurrentQueue<Tracked, TypeParam> queue;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.pop().has_value());
+    for (uint64_t i = 0; i < 1000; ++i) queue.emplace(i);
+    EXPECT_FALSE(queue.empty());
+    for (uint64_t i = 0; i < 600; ++i) EXPECT_EQ(queue.pop()->value_, i);
+    // the rest is destroyed with the queue
+  }
+  EXPECT_EQ(Tracked::live.load(), 0);
+
+  ConcurrentQueue<std::unique_ptr<std::string>, TypeParam> owners;
+  owners.push(std::make_unique<std::string>("move-only"));
+  EXPECT_EQ(**owners.pop(), "move-only");
+}
+
+TYPED_TEST(ConcurrentQueueTest, ProducersConsumers) {
+  const int producers = 4, consumers = 4;
+  const uint64_t per_producer = 50000;
+  {
+    ConcurrentQueue<Tracked, TypeParam> queue;
+    std::atomic<uint64_t> consumed{0}, sum{0};
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; ++p)
+      threads.emplace_back([&, p]() {
+        for (uint64_t i = 0; i < per_producer; ++i)
+          queue.emplace(((uint64_t)p << 32) | i);
+      });
+    for (int c = 0; c < consumers; ++c)
+      threads.emplace_back([&]() {
+        // per-producer order must be kept
+        uint64_t last[producers];
+        std::fill(last, last + producers, UINT64_MAX);
+        while (consumed.load() < producers * per_producer) {
+          auto val = queue.pop();
+          if (!val) {
+            std::this_thread::yield();
+            continue;
+          }
+          uint64_t p = val->value_ >> 32, v = val->value_ & 0xffffffffu;
+          EXPECT_TRUE(last[p] == UINT64_MAX || v > last[p]);
+          last[p] = v;
+          sum += v;
+          consumed++;
+        }
+      });
+    for (auto& t : threads) t.join();
+
+    EXPECT_EQ(sum.load(), producers * per_producer * (per_producer - 1) / 2);
+    EXPECT_TRUE(queue.empty());
+  }
+  EXPECT_EQ(Tracked::live.load(), 0);
+}
+
+TYPED_TEST(ConcurrentOrderedListTest, SingleThread) {
+  ConcurrentOrderedList<int, std::less<int>, TypeParam> list;
+  EXPECT_FALSE(list.contains(3));
+  EXPECT_TRUE(list.insert(3));
+  EXPECT_TRUE(list.insert(1));
+  EXPECT_TRUE(list.insert(2));
+  EXPECT_FALSE(list.insert(2));
+  EXPECT_TRUE(list.contains(1) && list.contains(2) && list.contains(3));
+  EXPECT_TRUE(list.erase(2));
+  EXPECT_FALSE(list.erase(2));
+  EXPECT_FALSE(list.contains(2));
+  EXPECT_TRUE(list.contains(1) && list.contains(3));
+
+  ConcurrentOrderedList<std::string, std::greater<>, TypeParam> words;
+  EXPECT_TRUE(words.insert("b"));
+  EXPECT_TRUE(words.insert("a"));
+  EXPECT_TRUE(words.erase("b"));
+  EXPECT_TRUE(words.contains("a"));
+}
+
+TYPED_TEST(ConcurrentOrderedListTest, ConcurrentInsertErase) {
+  const int threads = 6;
+  const uint64_t keys = 2000;
+  {
+    ConcurrentOrderedList<Tracked, std::less<Tracked>, TypeParam> list;
+    std::atomic<int64_t> inserted{0}, erased{0};
+    std::atomic<int> finished{0};
+    std::vector<std::thread> workers;
+    // every thread inserts all keys, so the inserts of a key race; then it
+    // erases the keys of its residue, racing the unlinking of neighbours
+    for (int t = 0; t < threads; ++t)
+      workers.emplace_back([&, t]() {
+        for (uint64_t k = 0; k < keys; ++k)
+          inserted += list.insert(Tracked(k));
+        finished++;
+        while (finished.load() < threads) std::this_thread::yield();
+        for (uint64_t k = t; k < keys; k += threads)
+          erased += list.erase(Tracked(k));
+      });
+    for (auto& w : workers) w.join();
+
+    // each key was inserted exactly once and erased exactly once
+    EXPECT_EQ(inserted.load(), (int64_t)keys);
+    EXPECT_EQ(erased.load(), (int64_t)keys);
+    for (uint64_t k = 0; k < keys; ++k)
+      EXPECT_FALSE(list.contains(Tracked(k)));
+  }
+  EXPECT_EQ(Tracked::live.load(), 0);
+}
+
+TYPED_TEST(ConcurrentOrderedListTest, Churn) {
+  // readers keep traversing while writers insert and erase the same keys
+  ConcurrentOrderedList<uint64_t, std::less<uint64_t>, TypeParam> list;
+  const int writers = 3, rounds = 20000;
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < writers; ++t)
+    threads.emplace_back([&, t]() {
+      for (int round = 0; round < rounds; ++round) {
+        uint64_t k = (round * 7 + t) % 64;
+        if (round % 2)
+          list.insert(k);
+        else
+          list.erase(k);
+      }
+    });
+  threads.emplace_back([&]() {
+    while (!stop.load())
+      for (uint64_t k = 0; k < 64; ++k) list.contains(k);
+  });
+  for (int t = 0; t < writers; ++t) threads[t].join();
+  stop = true;
+  threads.back().join();
+  // retired nodes stay bounded by the scan threshold, or by the limbo bags
+  // of three epochs per thread
+  if constexpr (std::is_same_v<TypeParam, HazardPointerDomain>)
+    EXPECT_LE(list.reclaimer().pending(),
+              4 * 2 * HazardPointerDomain::SCAN_THRESHOLD);
+  else
+    EXPECT_LE(list.reclaimer().pending(),
+              4 * 3 * EpochReclaimer::ADVANCE_EVERY);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,231 @@
+/**
+ * @file test_dary_heap.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-05
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "adt/dary_heap.hpp"
+#include "adt/linear_list.hpp"
+#include "gtest/gtest.h"
+
+// pop everything, in order
+template <class Heap>
+static LinearList<uint64_t> drain(Heap& heap) {
+  LinearList<uint64_t> ret;
+  uint64_t val;
+  while (heap.try_pop(val)) ret.push_back(val);
+  return ret;
+}
+
+template <class Heap>
+static void check_heap_sort() {
+  std::mt19937_64 rng(1);
+  for (size_t n : {0, 1, 2, 5, 17, 100, 1000, 4097}) {
+    LinearList<uint64_t> vals;
+    for (size_t i = 0; i < n; ++i) vals.push_back(rng() % 500);
+    Heap heap;
+    for (size_t i = 0; i < n; ++i) heap.push(vals[i]);
+    ASSERT_EQ(heap.size(), n);
+    const LinearList<uint64_t> out = drain(heap);
+    std::sort(vals.first(), vals.first() + vals.size());
+    ASSERT_EQ(out.size(), n);
+    for (size_t i = 0; i < n; ++i) ASSERT_EQ(out[i], vals[i]);
+    EXPECT_TRUE(heap.empty());
+  }
+}
+
+TEST(DaryHeapTest, PushPopInOrder) {
+  check_heap_sort<DaryHeap<uint64_t>>();
+  check_heap_sort<DaryHeap<uint64_t, 2>>();
+  check_heap_sort<DaryHeap<uint64_t, 3>>();
+  check_heap_sort<DaryHeap<uint64_t, 8>>();
+  check_heap_sort<IndexedDaryHeap<uint64_t>>();
+  check_heap_sort<IndexedDaryHeap<uint64_t, 3>>();
+
+  // a max-heap, like std::priority_queue
+  DaryHeap<int, 4, std::greater<int>> max_heap;
+  for (int i = 0; i < 100; ++i) max_heap.push(i * 7 % 100);
+  EXPECT_EQ(max_heap.top(), 99);
+  max_heap.pop();
+  EXPECT_EQ(max_heap.top(), 98);
+
+  // move-only elements
+  DaryHeap<std::unique_ptr<int>, 4,
+           std::function<bool(const std::unique_ptr<int>&,
+                              const std::unique_ptr<int>&)>>
+      owners([](const auto& lhs, const auto& rhs) { return *lhs < *rhs; });
+  for (int i = 10; i > 0; --i) owners.emplace(new int(i));
+  std::unique_ptr<int> out;
+  ASSERT_TRUE(owners.try_pop(out));
+  EXPECT_EQ(*out, 1);
+  EXPECT_EQ(*owners.top(), 2);
+}
+
+TEST(DaryHeapTest, HeapifyAndBatches) {
+  std::mt19937_64 rng(2);
+  LinearList<uint64_t> vals;
+  for (size_t i = 0; i < 10000; ++i) vals.push_back(rng());
+  DaryHeap<uint64_t> heap(vals);
+  EXPECT_EQ(heap.size(), vals.size());
+
+  // a small batch is sifted in, a large one rebuilds the heap
+  LinearList<uint64_t> small, large;
+  for (size_t i = 0; i < 100; ++i) small.push_back(rng());
+  for (size_t i = 0; i < 20000; ++i) large.push_back(rng());
+  heap.push_batch(small.first(), small.size());
+  heap.push_batch(large.first(), large.size());
+  for (size_t i = 0; i < small.size(); ++i) vals.push_back(small[i]);
+  for (size_t i = 0; i < large.size(); ++i) vals.push_back(large[i]);
+  std::sort(vals.first(), vals.first() + vals.size());
+
+  LinearList<uint64_t> out;
+  out.resize(vals.size() + 10);
+  size_t got = 0;
+  while (size_t n = heap.pop_batch(out.first() + got, 777)) got += n;
+  ASSERT_EQ(got, vals.size());
+  for (size_t i = 0; i < got; ++i) ASSERT_EQ(out[i], vals[i]);
+  EXPECT_EQ(heap.pop_batch(out.first(), 5), 0u);
+}
+
+TEST(DaryHeapTest, HandlesFollowTheirElements) {
+  IndexedDaryHeap<uint64_t> heap;
+  using Handle = IndexedDaryHeap<uint64_t>::Handle;
+  EXPECT_FALSE(heap.contains(Handle()));
+  LinearList<Handle> handles;
+  for (uint64_t i = 0; i < 1000; ++i) handles.push_back(heap.push(1000 + i));
+  for (uint64_t i = 0; i < 1000; ++i)
+    ASSERT_EQ(*heap.find(handles[i]), 1000 + i);
+
+  // the last element becomes the top
+  EXPECT_TRUE(heap.decrease_key(handles[999], 1));
+  EXPECT_EQ(heap.top(), 1u);
+  EXPECT_EQ(heap.top_handle().index_, handles[999].index_);
+  EXPECT_TRUE(heap.update(handles[999], 5000));
+  EXPECT_EQ(heap.top(), 1000u);
+  EXPECT_TRUE(heap.erase(handles[0]));
+  EXPECT_EQ(heap.top(), 1001u);
+
+  // stale handles are rejected, also once their slot is reused
+  EXPECT_FALSE(heap.contains(handles[0]));
+  EXPECT_EQ(heap.find(handles[0]), nullptr);
+  EXPECT_FALSE(heap.erase(handles[0]));
+  EXPECT_FALSE(heap.decrease_key(handles[0], 0));
+  const Handle reused = heap.push(7);
+  EXPECT_EQ(reused.index_, handles[0].index_);
+  EXPECT_FALSE(heap.update(handles[0], 0));
+  EXPECT_EQ(*heap.find(reused), 7u);
+
+  heap.pop();
+  EXPECT_FALSE(heap.contains(reused));
+  heap.clear();
+  EXPECT_TRUE(heap.empty());
+  EXPECT_FALSE(heap.contains(handles[500]));
+}
+
+TEST(DaryHeapTest, MatchesOrderedSet) {
+  // random pushes, pops, updates and erasures against a std::set of
+  // (value, id) pairs
+  std::mt19937_64 rng(3);
+  IndexedDaryHeap<std::pair<uint64_t, uint64_t>, 3> heap;
+  using Handle = decltype(heap)::Handle;
+  std::set<std::pair<uint64_t, uint64_t>> ref;
+  std::map<uint64_t, Handle> live;
+  uint64_t next_id = 0;
+  for (int op = 0; op < 100000; ++op) {
+    const uint64_t val = rng() % 1000;
+    switch (rng() % 6) {
+      case 0:
+      case 1: {
+        const uint64_t id = next_id++;
+        live[id] = heap.push({val, id});
+        ref.insert({val, id});
+        break;
+      }
+      case 2:
+        if (!ref.empty()) {
+          ASSERT_EQ(heap.top(), *ref.begin());
+          live.erase(ref.begin()->second);
+          ref.erase(ref.begin());
+          heap.pop();
+        }
+        break;
+      default: {
+        if (live.empty()) break;
+        auto it = live.lower_bound(rng() % next_id);
+        if (it == live.end()) it = live.begin();
+        const auto old = *heap.find(it->second);
+        ref.erase(old);
+        if (op % 3 == 0) {
+          ASSERT_TRUE(heap.erase(it->second));
+          live.erase(it);
+        } else if (op % 3 == 1 && val <= old.first) {
+          ASSERT_TRUE(heap.decrease_key(it->second, {val, old.second}));
+          ref.insert({val, old.second});
+        } else {
+          ASSERT_TRUE(heap.update(it->second, {val, old.second}));
+          ref.insert({val, old.second});
+        }
+      }
+    }
+    ASSERT_EQ(heap.size(), ref.size());
+  }
+  for (auto& [id, handle] : live) ASSERT_EQ(heap.find(handle)->second, id);
+
+  // a batch larger than the heap is heapified with the handles intact
+  LinearList<std::pair<uint64_t, uint64_t>> batch;
+  for (size_t i = 0; i < 2 * ref.size() + 10; ++i)
+    batch.push_back({rng() % 1000, next_id + i});
+  LinearList<Handle> handles;
+  handles.resize(batch.size());
+  heap.push_batch(batch.first(), batch.size(), handles.first());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ASSERT_EQ(*heap.find(handles[i]), batch[i]);
+    ref.insert(batch[i]);
+  }
+  for (auto& [id, handle] : live) ASSERT_EQ(heap.find(handle)->second, id);
+  for (auto& elem : ref) {
+    ASSERT_EQ(heap.top(), elem);
+    heap.pop();
+  }
+  EXPECT_TRUE(heap.empty());
+}
+
+TEST(DaryHeapTest, StringElements) {
+  IndexedDaryHeap<std::string> heap;
+  LinearList<std::string> words;
+  for (int i = 0; i < 300; ++i) words.push_back("w" + std::to_string(i));
+  heap.push_batch(words.first(), words.size());
+  auto handle = heap.push("zzz");
+  heap.decrease_key(handle, "a");
+  std::string out;
+  ASSERT_TRUE(heap.try_pop(out));
+  EXPECT_EQ(out, "a");
+  EXPECT_EQ(heap.top(), "w0");
+  EXPECT_EQ(heap.size(), 300u);
+
+  IndexedDaryHeap<std::string> other;
+  other.swap(heap);
+  EXPECT_TRUE(heap.empty());
+  EXPECT_EQ(other.top(), "w0");
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,231 @@
+/**
+ * @file test_flat_hash_map.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "adt/flat_hash_map.hpp"
+#include "gtest/gtest.h"
+#include "test/adt/tracked.hpp"
+
+// sends every key to the same few home slots
+struct BadHash {
+  size_t operator()(uint64_t key) const { return key % 3; }
+};
+
+TEST(FlatHashMapTest, InsertFindErase) {
+  FlatHashMap<uint64_t, uint64_t> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.find(1), nullptr);
+  EXPECT_FALSE(map.erase(1));
+
+  for (uint64_t i = 0; i < 10000; ++i) EXPECT_TRUE(map.insert(i, i * i));
+  EXPECT_FALSE(map.insert(5, 0));
+  EXPECT_EQ(map.size(), 10000u);
+  EXPECT_LE(map.size(), map.capacity() / 8 * 7);
+  for (uint64_t i = 0; i < 10000; ++i) ASSERT_EQ(map.at(i), i * i);
+  EXPECT_FALSE(map.contains(10000));
+
+  EXPECT_FALSE(map.insert_or_assign(5, 1));
+  EXPECT_EQ(map.at(5), 1u);
+  map[5] += 1;
+  EXPECT_EQ(map[5], 2u);
+  EXPECT_EQ(map[20000], 0u);
+  EXPECT_EQ(map.size(), 10001u);
+
+  for (uint64_t i = 0; i < 10000; i += 2) EXPECT_TRUE(map.erase(i));
+  EXPECT_EQ(map.size(), 5001u);
+  for (uint64_t i = 0; i < 10000; ++i)
+    ASSERT_EQ(map.contains(i), i % 2 == 1) << i;
+
+  uint64_t sum = 0;
+  map.for_each([&](const uint64_t& key, uint64_t& val) {
+    sum += key;
+    val = 0;
+  });
+  EXPECT_EQ(sum, 25000000u + 20000u);
+  EXPECT_EQ(map.at(7), 0u);
+
+  const size_t capacity = map.capacity();
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.capacity(), capacity);
+  EXPECT_FALSE(map.contains(7));
+}
+
+TEST(FlatHashMapTest, MatchesUnorderedMap) {
+  // a small key space makes inserts and erases of the same keys collide
+  std::mt19937_64 rng(3);
+  FlatHashMap<uint64_t, uint64_t> map;
+  std::unordered_map<uint64_t, uint64_t> ref;
+  for (int op = 0; op < 200000; ++op) {
+    const uint64_t key = rng() % 5000, val = rng();
+    switch (rng() % 4) {
+      case 0:
+      case 1:
+        EXPECT_EQ(map.insert_or_assign(key, val),
+                  ref.insert_or_assign(key, val).second);
+        break;
+      case 2:
+        EXPECT_EQ(map.erase(key), ref.erase(key) == 1);
+        break;
+      default: {
+        const uint64_t* found = map.find(key);
+        auto it = ref.find(key);
+        ASSERT_EQ(found != nullptr, it != ref.end());
+        if (found) {
+          EXPECT_EQ(*found, it->second);
+        }
+      }
+    }
+    ASSERT_EQ(map.size(), ref.size());
+  }
+  for (auto& [key, val] : ref) ASSERT_EQ(map.at(key), val);
+}
+
+TEST(FlatHashMapTest, CollidingKeys) {
+  // long runs that wrap around the end of the table, and erasures that
+  // shift them back
+  FlatHashMap<uint64_t, int, BadHash> map;
+  for (uint64_t i = 0; i < 300; ++i) map.insert(i, (int)i);
+  for (uint64_t i = 0; i < 300; i += 3) EXPECT_TRUE(map.erase(i));
+  for (uint64_t i = 0; i < 300; ++i)
+    ASSERT_EQ(map.contains(i), i % 3 != 0) << i;
+  for (uint64_t i = 0; i < 300; i += 3) map.insert(i, -(int)i);
+  for (uint64_t i = 0; i < 300; ++i)
+    ASSERT_EQ(map.at(i), i % 3 ? (int)i : -(int)i);
+
+  // a table filled to its highest load, erased in a random order
+  FlatHashMap<uint64_t, int> full(28);
+  EXPECT_EQ(full.capacity(), 32u);
+  for (uint64_t i = 0; i < 28; ++i) full.insert(i * 32, 0);
+  EXPECT_EQ(full.capacity(), 32u);
+  std::mt19937_64 rng(11);
+  LinearList<uint64_t> order;
+  for (uint64_t i = 0; i < 28; ++i) order.push_back(i * 32);
+  std::shuffle(order.first(), order.first() + order.size(), rng);
+  for (size_t i = 0; i < order.size(); ++i) {
+    ASSERT_TRUE(full.erase(order[i]));
+    for (size_t j = i + 1; j < order.size(); ++j)
+      ASSERT_TRUE(full.contains(order[j]));
+  }
+  EXPECT_TRUE(full.empty());
+}
+
+TEST(FlatHashMapTest, HeterogeneousLookup) {
+  FlatHashMap<std::string, int, FlatHashMapPolicy::StringHash,
+              std::equal_to<>>
+      map;
+  map.try_emplace(std::string_view("alpha"), 1);
+  map.try_emplace("beta", 2);
+  map[std::string("gamma")] = 3;
+  EXPECT_EQ(map.at(std::string_view("alpha")), 1);
+  EXPECT_EQ(*map.find("beta"), 2);
+  EXPECT_TRUE(map.contains(std::string("gamma")));
+  const std::string text = "xxgammaxx";
+  EXPECT_TRUE(map.contains(std::string_view(text).substr(2, 5)));
+  EXPECT_TRUE(map.erase(std::string_view("beta")));
+  EXPECT_FALSE(map.contains("beta"));
+  EXPECT_EQ(map.size(), 2u);
+}
+
+TEST(FlatHashMapTest, NonTrivialElements) {
+  {
+    FlatHashMap<std::string, Tracked> map;
+    for (int i = 0; i < 1000; ++i)
+      map.try_emplace("key" + std::to_string(i), i);
+    EXPECT_EQ(Tracked::alive, 1000);
+    for (int i = 0; i < 1000; i += 2) map.erase("key" + std::to_string(i));
+    EXPECT_EQ(Tracked::alive, 500);
+
+    FlatHashMap<std::string, Tracked> copy(map);
+    EXPECT_EQ(Tracked::alive, 1000);
+    copy.at("key1").val = -1;
+    EXPECT_EQ(map.at("key1").val, 1);
+
+    FlatHashMap<std::string, Tracked> moved(std::move(copy));
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(moved.at("key1").val, -1);
+    map = moved;
+    EXPECT_EQ(map.at("key1").val, -1);
+    EXPECT_EQ(Tracked::alive, 1000);
+    moved.clear();
+    EXPECT_EQ(Tracked::alive, 500);
+  }
+  EXPECT_EQ(Tracked::alive, 0);
+
+  // move-only values
+  FlatHashMap<int, std::unique_ptr<int>> owners;
+  for (int i = 0; i < 100; ++i)
+    owners.try_emplace(i, std::make_unique<int>(i));
+  for (int i = 0; i < 100; i += 2) owners.erase(i);
+  for (int i = 1; i < 100; i += 2) ASSERT_EQ(*owners.at(i), i);
+}
+
+TEST(FlatHashMapTest, ArgumentsIntoTheMap) {
+  // each insertion below fills the table past its load and grows it, while
+  // its arguments refer to elements of the map
+  const std::string long_text(100, 'v');
+  FlatHashMap<int, std::string> map(28);
+  for (int i = 0; i < 28; ++i)
+    map.try_emplace(i, long_text + std::to_string(i));
+  ASSERT_EQ(map.capacity(), 32u);
+  EXPECT_TRUE(map.try_emplace(100, map.at(0)).second);
+  EXPECT_EQ(map.at(100), long_text + "0");
+
+  FlatHashMap<int, std::string> other(28);
+  for (int i = 0; i < 28; ++i)
+    other.try_emplace(i, long_text + std::to_string(i));
+  EXPECT_TRUE(other.insert_or_assign(100, other.at(1)));
+  EXPECT_EQ(other.at(100), long_text + "1");
+
+  FlatHashMap<std::string, std::string> names(28);
+  for (int i = 0; i < 28; ++i)
+    names.try_emplace(std::to_string(i), long_text + std::to_string(i));
+  EXPECT_TRUE(names.insert(names.at("2"), names.at("3")));
+  EXPECT_EQ(names.at(long_text + "2"), long_text + "3");
+}
+
+TEST(FlatHashMapTest, FailedGrowKeepsTheMap) {
+#ifdef __SANITIZE_ADDRESS__
+  GTEST_SKIP() << "AddressSanitizer aborts instead of throwing bad_alloc";
+#endif
+  // 2^27 slots of 1 MiB exceed any address space, while their control
+  // bytes are easily allocated: the slot allocation fails on its own
+  struct Page {
+    std::string name;
+    char bytes[1 << 20];
+  };
+  FlatHashMap<int, Page> map;
+  for (int i = 0; i < 10; ++i)
+    map.try_emplace(i).first->name = "p" + std::to_string(i);
+  const size_t capacity = map.capacity();
+  EXPECT_THROW(map.reserve(size_t(1) << 26), std::bad_alloc);
+  EXPECT_EQ(map.capacity(), capacity);
+  EXPECT_EQ(map.size(), 10u);
+  for (int i = 0; i < 10; ++i)
+    ASSERT_EQ(map.at(i).name, "p" + std::to_string(i));
+  map.try_emplace(10);
+  EXPECT_EQ(map.size(), 11u);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,111 @@
+/**
+ * @file test_indexed_linked_list.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-14
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "adt/indexed_linked_list.hpp"
+#include "adt/node_pool.hpp"
+#include "gtest/gtest.h"
+
+template <class List>
+static void expect_same(const List& list, const std::vector<int>& model) {
+  ASSERT_EQ(list.size(), model.size());
+  size_t idx = 0;
+  for (auto* cur = list.first(); cur != nullptr; cur = cur->next_)
+    ASSERT_EQ(cur->value_, model[idx++]);
+  for (auto* cur = list.last(); cur != nullptr; cur = cur->prior_)
+    ASSERT_EQ(cur->value_, model[--idx]);
+}
+
+TEST(IndexedLinkedListTest, LayoutTest) {
+  EXPECT_EQ(sizeof(IndexedLinkedList<int>::ListNode), 48u);
+  EXPECT_EQ(sizeof(IndexedLinkedList<double>::ListNode), 48u);
+}
+
+TEST(IndexedLinkedListTest, RandomOpsTest) {
+  /**
+   * @brief
+   *
+   * positional operations shall match a std::vector model.
+   */
+  std::mt19937 rnd(1);
+  IndexedLinkedList<int> list;
+  std::vector<int> model;
+
+  for (int i = 0; i < 20000; ++i) {
+    size_t op = rnd() % 6;
+    if (op < 3 || model.empty()) {
+      size_t idx = rnd() % (model.size() + 1);
+      auto* node = list.insert_at(idx, i);
+      model.insert(model.begin() + idx, i);
+      ASSERT_EQ(node->value_, i);
+    } else if (op < 5) {
+      size_t idx = rnd() % model.size();
+      list.erase_at(idx);
+      model.erase(model.begin() + idx);
+    } else {
+      size_t idx = rnd() % model.size();
+      ASSERT_EQ(list.at(idx)->value_, model[idx]);
+    }
+  }
+  expect_same(list, model);
+
+  IndexedLinkedList<int> copy(list);
+  expect_same(copy, model);
+}
+
+TEST(IndexedLinkedListTest, DequeOpsTest) {
+  using Pool = NodePool<int>;
+  IndexedLinkedList<int, Pool> list;
+  std::vector<int> model;
+
+  for (int i = 0; i < 1000; ++i) list.push_back(i), model.push_back(i);
+  for (int i = 0; i < 10; ++i)
+    list.push_front(-i), model.insert(model.begin(), -i);
+  list.pop_back(), model.pop_back();
+  list.pop_front(), model.erase(model.begin());
+
+  expect_same(list, model);
+  EXPECT_EQ(list.front(), model.front());
+  EXPECT_EQ(list.back(), model.back());
+  EXPECT_EQ(list.at(500)->value_, model[500]);
+
+  IndexedLinkedList<int, Pool> moved(std::move(list));
+  EXPECT_TRUE(list.empty());
+  expect_same(moved, model);
+
+  // the moved-from list keeps its pool
+  list.push_back(7);
+  EXPECT_EQ(list.front(), 7);
+
+  // assignment replaces the contents and takes over the pool
+  IndexedLinkedList<int, Pool> assigned;
+  assigned.push_back(1);
+  assigned = moved;
+  expect_same(assigned, model);
+  expect_same(moved, model);
+  assigned = std::move(list);
+  EXPECT_EQ(assigned.size(), 1u);
+  EXPECT_EQ(assigned.front(), 7);
+  const auto& self = assigned;
+  assigned = self;
+  EXPECT_EQ(assigned.front(), 7);
+  assigned.insert_at(0, 3);
+  EXPECT_EQ(assigned.at(0)->value_, 3);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
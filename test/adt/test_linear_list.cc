@@ -10,11 +10,16 @@
  *
  */
 
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <new>
+#include <string>
+#include <vector>
 
 #include "adt/linear_list.hpp"
 #include "gtest/gtest.h"
+#include "test/adt/tracked.hpp"
 
 TEST(LinearListTest, ConstructorTest) {
   if (1) {
@@ -22,6 +27,123 @@ TEST(LinearListTest, ConstructorTest) {
   }
 }
 
+template <typename Growth>
+static std::vector<size_t> growth_trace(size_t n) {
+  LinearList<int, Growth> list;
+  std::vector<size_t> ret;
+  for (size_t i = 0; i < n; ++i) {
+    list.push_back((int)i);
+    if (ret.empty() || ret.back() != list.capacity())
+      ret.push_back(list.capacity());
+  }
+  for (size_t i = 0; i < n; ++i) EXPECT_EQ(list.at(i), (int)i);
+  return ret;
+}
+
+TEST(LinearListTest, GrowthPolicyTest) {
+  using namespace LinearListPolicy;
+
+  EXPECT_EQ(growth_trace<OneAndHalf>(40),
+            (std::vector<size_t>{10, 15, 23, 35, 53}));
+  EXPECT_EQ(growth_trace<PowerOfTwo>(40),
+            (std::vector<size_t>{16, 32, 64}));
+  EXPECT_EQ(growth_trace<GoldenRatio>(40),
+            (std::vector<size_t>{10, 16, 25, 40}));
+  EXPECT_EQ(growth_trace<FixedChunk<16>>(40),
+            (std::vector<size_t>{16, 32, 48}));
+  EXPECT_EQ(growth_trace<ReserveExact>(4),
+            (std::vector<size_t>{1, 2, 3, 4}));
+}
+
+TEST(LinearListTest, NonTrivialTest) {
+  /**
+   * @brief
+   *
+   * non-trivially copyable payloads shall be constructed, moved and destroyed
+   * properly, and growth shall move instead of copy.
+   */
+  Tracked::alive = Tracked::copies = 0;
+  if (1) {
+    LinearList<Tracked> list;
+    for (int i = 0; i < 100; ++i) list.emplace_back(i);
+    EXPECT_EQ(Tracked::alive, 100);
+    EXPECT_EQ(Tracked::copies, 0);
+
+    list.pop_back();
+    EXPECT_EQ(Tracked::alive, 99);
+
+    LinearList<Tracked> copy(list);
+    EXPECT_EQ(Tracked::alive, 198);
+    EXPECT_EQ(copy.back().val, 98);
+
+    copy.resize(10);
+    EXPECT_EQ(copy.size(), 10u);
+    EXPECT_EQ(Tracked::alive, 109);
+  }
+  EXPECT_EQ(Tracked::alive, 0);
+
+  LinearList<std::string> strs;
+  for (int i = 0; i < 50; ++i) strs.push_back(std::string(40, 'a' + i % 26));
+  // the argument aliases an element that growth relocates
+  strs.push_back(strs[0]);
+  EXPECT_EQ(strs.back(), std::string(40, 'a'));
+
+  LinearList<std::unique_ptr<int>> ptrs;
+  for (int i = 0; i < 50; ++i) ptrs.emplace_back(std::make_unique<int>(i));
+  LinearList<std::unique_ptr<int>> moved(std::move(ptrs));
+  EXPECT_TRUE(ptrs.empty());
+  EXPECT_EQ(*moved.at(49), 49);
+}
+
+TEST(LinearListTest, ReserveTest) {
+  LinearList<std::string> list;
+  list.reserve(64);
+  EXPECT_EQ(list.capacity(), 64u);
+  for (int i = 0; i < 64; ++i) list.emplace_back(i, 'x');
+  EXPECT_EQ(list.capacity(), 64u);
+
+  // reserve never shrinks
+  list.reserve(8);
+  EXPECT_EQ(list.capacity(), 64u);
+
+  for (int i = 0; i < 60; ++i) list.pop_back();
+  list.shrink_to_fit();
+  EXPECT_EQ(list.capacity(), 4u);
+  EXPECT_EQ(list[3], "xxx");
+
+  list.clear();
+  list.shrink_to_fit();
+  EXPECT_EQ(list.capacity(), 0u);
+  EXPECT_EQ(list.first(), nullptr);
+}
+
+TEST(LinearListTest, MappedGrowthTest) {
+  /**
+   * @brief
+   *
+   * large trivially relocatable lists cross over to mremap-grown pages and
+   * back; the contents shall survive every transition.
+   */
+  const size_t n = LinearListStorage::MMAP_THRESHOLD / sizeof(uint64_t) * 3;
+
+  LinearList<uint64_t> list;
+  for (size_t i = 0; i < n; ++i) list.push_back(i * 7);
+  EXPECT_GE(list.capacity() * sizeof(uint64_t),
+            LinearListStorage::MMAP_THRESHOLD);
+  for (size_t i = 0; i < n; i += 4099) ASSERT_EQ(list.at(i), i * 7);
+
+  LinearList<uint64_t> copy(list);
+  EXPECT_EQ(copy.at(n - 1), (n - 1) * 7);
+
+  // mapped -> mapped, then mapped -> heap
+  list.reserve(n * 2);
+  EXPECT_EQ(list.at(n - 1), (n - 1) * 7);
+  list.resize(1000);
+  list.shrink_to_fit();
+  EXPECT_EQ(list.capacity(), 1000u);
+  for (size_t i = 0; i < 1000; ++i) ASSERT_EQ(list.at(i), i * 7);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
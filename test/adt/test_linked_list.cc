@@ -0,0 +1,166 @@
+/**
+ * @file test_linked_list.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-08
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "adt/linked_list.hpp"
+#include "adt/node_pool.hpp"
+#include "gtest/gtest.h"
+
+TEST(LinkedListTest, ConstructorTest) {
+  if (1) {
+    LinkedList<int> list;
+    EXPECT_TRUE(list.empty());
+  }
+
+  LinkedList<std::string> list;
+  for (int i = 0; i < 5; ++i) list.push_back(std::string(i + 1, 'a'));
+  list.push_front("z");
+
+  LinkedList<std::string> copy(list);
+  EXPECT_EQ(copy.size(), 6);
+  EXPECT_EQ(copy.front(), "z");
+  EXPECT_EQ(copy.back(), "aaaaa");
+  EXPECT_EQ(copy.at(2)->value_, "aa");
+
+  LinkedList<std::string> moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  moved.pop_front(), moved.pop_back();
+  EXPECT_EQ(moved.size(), 4);
+  EXPECT_EQ(moved.first()->value_, "a");
+  EXPECT_EQ(moved.last()->value_, "aaaa");
+}
+
+TEST(LinkedListTest, NodePoolTest) {
+  /**
+   * @brief
+   *
+   * nodes from a NodePool shall be carved from the same chunk, and released
+   * nodes shall be recycled without carving new chunks.
+   */
+  using Pool = NodePool<int, 64>;
+  Pool pool;
+  LinkedList<int, Pool> list(pool);
+
+  for (int i = 0; i < 64; ++i) list.push_back(i);
+  EXPECT_EQ(pool.chunks(), 1u);
+
+  // consecutive pushes give adjacent nodes: 24-byte nodes in 32-byte slots
+  auto* a = list.at(10);
+  auto* b = list.at(11);
+  EXPECT_EQ((uintptr_t)b - (uintptr_t)a, 32u);
+
+  // churn reuses the freed slots
+  for (int k = 0; k < 1000; ++k) {
+    list.pop_front();
+    list.push_back(k);
+  }
+  EXPECT_EQ(pool.chunks(), 1u);
+  EXPECT_EQ(list.size(), 64);
+
+  // a second list may share the pool
+  LinkedList<int, Pool> other(pool);
+  other.push_back(1);
+  EXPECT_EQ(pool.chunks(), 2u);
+  EXPECT_TRUE(other.get_allocator() == pool);
+
+  // copies share the pool as well
+  LinkedList<int, Pool> copy(list);
+  EXPECT_EQ(copy.back(), 999);
+  EXPECT_EQ(pool.chunks(), 3u);
+
+  // a moved-from list keeps its pool and stays usable
+  LinkedList<int, Pool> moved(std::move(copy));
+  copy.push_back(7);
+  EXPECT_EQ(copy.front(), 7);
+  EXPECT_TRUE(copy.get_allocator() == pool);
+}
+
+template <class List>
+static std::vector<int> to_vector(const List& list) {
+  std::vector<int> ret;
+  for (auto* cur = list.first(); cur != nullptr; cur = cur->next_)
+    ret.push_back(cur->value_);
+  // walk backwards too, so that broken prior_ links are caught
+  size_t idx = ret.size();
+  for (auto* cur = list.last(); cur != nullptr; cur = cur->prior_)
+    EXPECT_EQ(cur->value_, ret[--idx]);
+  EXPECT_EQ(idx, 0u);
+  EXPECT_EQ((size_t)list.size(), ret.size());
+  return ret;
+}
+
+TEST(LinkedListTest, SpliceTest) {
+  /**
+   * @brief
+   *
+   * splice and split_at relink nodes without reallocating them.
+   */
+  LinkedList<int> a, b;
+  for (int i = 0; i < 5; ++i) a.push_back(i), b.push_back(10 + i);
+
+  auto* node = b.at(1);
+  a.splice(a.at(2), b, b.at(1), b.at(3), 3);
+  EXPECT_EQ(to_vector(a), (std::vector<int>{0, 1, 11, 12, 13, 2, 3, 4}));
+  EXPECT_EQ(to_vector(b), (std::vector<int>{10, 14}));
+  EXPECT_EQ(a.at(2), node);
+
+  a.splice(nullptr, b);
+  EXPECT_EQ(to_vector(a),
+            (std::vector<int>{0, 1, 11, 12, 13, 2, 3, 4, 10, 14}));
+  EXPECT_TRUE(b.empty());
+
+  LinkedList<int> tail = a.split_at(a.at(6));
+  EXPECT_EQ(to_vector(a), (std::vector<int>{0, 1, 11, 12, 13, 2}));
+  EXPECT_EQ(to_vector(tail), (std::vector<int>{3, 4, 10, 14}));
+
+  // split at the head moves everything
+  LinkedList<int> all = tail.split_at(tail.first(), 4);
+  EXPECT_TRUE(tail.empty());
+  EXPECT_EQ(to_vector(all), (std::vector<int>{3, 4, 10, 14}));
+
+  // splice at the front
+  a.splice(a.first(), all);
+  EXPECT_EQ(a.front(), 3);
+  EXPECT_EQ(a.size(), 10);
+}
+
+TEST(LinkedListTest, MergeTest) {
+  using Pool = NodePool<int>;
+  Pool pool;
+  LinkedList<int, Pool> a(pool), b(pool);
+  for (int v : {1, 3, 3, 8, 9}) a.push_back(v);
+  for (int v : {0, 2, 3, 4, 5, 10, 11}) b.push_back(v);
+
+  auto* three = b.at(2);
+  a.merge(b);
+  EXPECT_EQ(to_vector(a),
+            (std::vector<int>{0, 1, 2, 3, 3, 3, 4, 5, 8, 9, 10, 11}));
+  EXPECT_TRUE(b.empty());
+  // stable: equal elements of the other list come after ours
+  EXPECT_EQ(a.at(5), three);
+
+  LinkedList<int, Pool> c(pool);
+  for (int v : {12, 7, 6}) c.push_back(v);
+  LinkedList<int, Pool> d(pool);
+  for (int v : {13, 5}) d.push_back(v);
+  c.merge(d, [](int x, int y) { return x > y; });
+  EXPECT_EQ(to_vector(c), (std::vector<int>{13, 12, 7, 6, 5}));
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,165 @@
+/**
+ * @file test_mapped_linear_list.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-29
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "adt/mapped_linear_list.hpp"
+#include "gtest/gtest.h"
+
+struct Point {
+  int32_t x, y;
+  double weight;
+};
+
+// a fresh path in the test temp directory, removed at the end of the test
+class MappedLinearListTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = testing::TempDir() + "mapped_linear_list_" +
+            std::to_string(getpid()) + "_" +
+            testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::remove(path_.c_str());
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  size_t file_size() const {
+    struct stat st;
+    return stat(path_.c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+  }
+
+  std::string path_;
+};
+
+TEST_F(MappedLinearListTest, PersistsAcrossReopen) {
+  {
+    MappedLinearList<Point> list;
+    EXPECT_FALSE(list.is_open());
+    EXPECT_FALSE(list.open(path_.c_str(), false));
+    ASSERT_TRUE(list.open(path_.c_str()));
+    EXPECT_TRUE(list.empty());
+    for (int i = 0; i < 100000; ++i) list.push_back(Point{i, -i, i * 0.5});
+    EXPECT_TRUE(list.sync());
+  }
+  EXPECT_GE(file_size(), MappedLinearListDetail::HEADER_BYTES +
+                             100000 * sizeof(Point));
+
+  MappedLinearList<Point> list;
+  ASSERT_TRUE(list.open(path_.c_str(), false));
+  ASSERT_EQ(list.size(), 100000u);
+  for (int i = 0; i < 100000; ++i) {
+    ASSERT_EQ(list[i].x, i);
+    ASSERT_EQ(list[i].weight, i * 0.5);
+  }
+  // keep appending to the reopened list
+  list.pop_back();
+  list.emplace_back(Point{7, 7, 7.0});
+  list.push_back(list.front());
+  EXPECT_EQ(list.size(), 100001u);
+  EXPECT_EQ(list.back().y, 0);
+  EXPECT_EQ(list.last()[-1].x, 7);
+}
+
+TEST_F(MappedLinearListTest, RejectsOtherFormats) {
+  {
+    MappedLinearList<uint64_t> list;
+    ASSERT_TRUE(list.open(path_.c_str()));
+    list.push_back(42);
+  }
+  // another element size
+  MappedLinearList<uint32_t> narrow;
+  EXPECT_FALSE(narrow.open(path_.c_str()));
+  EXPECT_FALSE(narrow.is_open());
+
+  // not a list at all
+  FILE* file = std::fopen(path_.c_str(), "r+b");
+  ASSERT_NE(file, nullptr);
+  std::fputs("garbage", file);
+  std::fclose(file);
+  MappedLinearList<uint64_t> wide;
+  EXPECT_FALSE(wide.open(path_.c_str()));
+
+  // a header longer than the file
+  std::remove(path_.c_str());
+  file = std::fopen(path_.c_str(), "wb");
+  std::fputs("short", file);
+  std::fclose(file);
+  EXPECT_FALSE(wide.open(path_.c_str()));
+
+  // a capacity whose size in bytes wraps around to fit the file
+  std::remove(path_.c_str());
+  unsigned char block[MappedLinearListDetail::HEADER_BYTES] = {};
+  const MappedLinearListDetail::Header header{
+      MappedLinearListDetail::MAGIC, MappedLinearListDetail::VERSION,
+      (uint32_t)sizeof(uint64_t), 1, (uint64_t)1 << 61};
+  memcpy(block, &header, sizeof(header));
+  file = std::fopen(path_.c_str(), "wb");
+  std::fwrite(block, 1, sizeof(block), file);
+  std::fclose(file);
+  EXPECT_FALSE(wide.open(path_.c_str()));
+}
+
+TEST_F(MappedLinearListTest, ResizeTruncatesTheFile) {
+  MappedLinearList<uint64_t, LinearListPolicy::PowerOfTwo> list;
+  ASSERT_TRUE(list.open(path_.c_str()));
+  for (uint64_t i = 0; i < 1000; ++i) list.push_back(i * 3);
+  EXPECT_EQ(list.capacity(), 1024u);
+  EXPECT_EQ(file_size(), MappedLinearListDetail::HEADER_BYTES + 1024 * 8);
+
+  list.resize(10);
+  EXPECT_EQ(list.size(), 10u);
+  EXPECT_EQ(file_size(), MappedLinearListDetail::HEADER_BYTES + 10 * 8);
+  list.reserve(5000);
+  EXPECT_EQ(list.capacity(), 5000u);
+  list.pop_back();
+  list.shrink_to_fit();
+  EXPECT_EQ(list.capacity(), 9u);
+  for (uint64_t i = 0; i < 9; ++i) EXPECT_EQ(list.at(i), i * 3);
+
+  list.clear();
+  EXPECT_TRUE(list.empty());
+  list.close();
+  ASSERT_TRUE(list.open(path_.c_str()));
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(list.capacity(), 9u);
+}
+
+TEST_F(MappedLinearListTest, MoveAndSwap) {
+  MappedLinearList<int> list;
+  ASSERT_TRUE(list.open(path_.c_str()));
+  list.push_back(1);
+
+  MappedLinearList<int> moved(std::move(list));
+  EXPECT_FALSE(list.is_open());
+  EXPECT_EQ(list.size(), 0u);
+  ASSERT_TRUE(moved.is_open());
+  EXPECT_EQ(moved.front(), 1);
+
+  MappedLinearList<int> other;
+  other = std::move(moved);
+  other.push_back(2);
+  other.swap(moved);
+  EXPECT_EQ(moved.size(), 2u);
+  EXPECT_FALSE(other.is_open());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+/**
+ * @file test_ring_buffer.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-18
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "adt/ring_buffer.hpp"
+#include "gtest/gtest.h"
+
+template <class Buffer>
+static void single_thread_ops() {
+  Buffer buf(5);
+  EXPECT_EQ(buf.capacity(), 8u);
+
+  int out;
+  EXPECT_FALSE(buf.try_pop(out));
+  for (int i = 0; i < 8; ++i) EXPECT_TRUE(buf.try_push(i));
+  EXPECT_FALSE(buf.try_push(8));
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(buf.try_pop(out));
+    EXPECT_EQ(out, i);
+  }
+
+  // the batch wraps around the end of the slots and stops when full
+  int vals[5] = {8, 9, 10, 11, 12};
+  EXPECT_EQ(buf.push_batch(vals, 5), 3u);
+
+  int outs[16];
+  EXPECT_EQ(buf.pop_batch(outs, 16), 8u);
+  for (int i = 0; i < 8; ++i) EXPECT_EQ(outs[i], i + 3);
+  EXPECT_EQ(buf.pop_batch(outs, 16), 0u);
+}
+
+TEST(RingBufferTest, SingleThreadTest) {
+  single_thread_ops<SpscRingBuffer<int>>();
+  single_thread_ops<MpmcRingBuffer<int>>();
+
+  SpscRingBuffer<std::string> strs(4);
+  std::string out;
+  EXPECT_TRUE(strs.try_push(std::string(100, 'x')));
+  EXPECT_TRUE(strs.try_pop(out));
+  EXPECT_EQ(out, std::string(100, 'x'));
+}
+
+TEST(RingBufferTest, SpscTest) {
+  /**
+   * @brief
+   *
+   * elements shall come out in order, none lost or duplicated.
+   */
+  const uint64_t n = 200000;
+  SpscRingBuffer<uint64_t> buf(256);
+
+  std::thread producer([&]() {
+    uint64_t batch[7];
+    for (uint64_t i = 0; i < n;) {
+      if (i % 3 == 0) {
+        size_t k = 0;
+        while (k < 7 && i + k < n) batch[k] = i + k, k++;
+        size_t pushed = buf.push_batch(batch, k);
+        i += pushed;
+        if (!pushed) std::this_thread::yield();
+      } else if (buf.try_push(i)) {
+        i++;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint64_t expect = 0, out[5];
+  while (expect < n) {
+    size_t k = buf.pop_batch(out, 5);
+    if (!k) std::this_thread::yield();
+    for (size_t i = 0; i < k; ++i) ASSERT_EQ(out[i], expect++);
+  }
+  producer.join();
+  EXPECT_EQ(buf.size(), 0u);
+}
+
+TEST(RingBufferTest, MpmcTest) {
+  /**
+   * @brief
+   *
+   * with several producers and consumers, every element shall be consumed
+   * exactly once and each producer's elements shall stay in order.
+   */
+  const int producers = 4, consumers = 4;
+  const uint64_t per_producer = 50000;
+  MpmcRingBuffer<uint64_t> buf(64);
+  std::atomic<uint64_t> consumed{0}, sum{0};
+  std::vector<std::thread> threads;
+
+  for (int p = 0; p < producers; ++p)
+    threads.emplace_back([&, p]() {
+      for (uint64_t i = 0; i < per_producer;) {
+        uint64_t val[2] = {(uint64_t)p << 32 | i, (uint64_t)p << 32 | (i + 1)};
+        size_t k = (i + 1 < per_producer && i % 2) ? buf.push_batch(val, 2)
+                                                   : buf.try_push(val[0]);
+        if (!k) std::this_thread::yield();
+        i += k;
+      }
+    });
+
+  for (int c = 0; c < consumers; ++c)
+    threads.emplace_back([&]() {
+      std::vector<uint64_t> last(producers, 0);
+      uint64_t out[3];
+      while (consumed.load() < producers * per_producer) {
+        size_t k = buf.pop_batch(out, 3);
+        if (!k) std::this_thread::yield();
+        for (size_t i = 0; i < k; ++i) {
+          uint64_t p = out[i] >> 32, v = out[i] & 0xffffffffu;
+          EXPECT_TRUE(v == 0 || v > last[p] || last[p] == 0);
+          last[p] = v;
+          sum += v;
+        }
+        consumed += k;
+      }
+    });
+
+  for (auto& t : threads) t.join();
+  EXPECT_EQ(consumed.load(), producers * per_producer);
+  EXPECT_EQ(sum.load(), producers * per_producer * (per_producer - 1) / 2);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,145 @@
+/**
+ * @file test_small_linear_list.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-28
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "adt/small_linear_list.hpp"
+#include "gtest/gtest.h"
+#include "test/adt/tracked.hpp"
+
+// whether the list keeps its elements inside its own object
+template <class List>
+static bool in_object(const List& list) {
+  auto* begin = reinterpret_cast<const unsigned char*>(&list);
+  auto* elem = reinterpret_cast<const unsigned char*>(list.first());
+  return elem >= begin && elem < begin + sizeof(List);
+}
+
+TEST(SmallLinearListTest, InlineThenSpill) {
+  SmallLinearList<int, 8> list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(list.capacity(), 8u);
+  for (int i = 0; i < 8; ++i) list.push_back(i);
+  EXPECT_TRUE(list.inlined());
+  EXPECT_TRUE(in_object(list));
+  EXPECT_EQ(list.capacity(), 8u);
+
+  // the ninth element spills everything to the heap
+  list.push_back(8);
+  EXPECT_FALSE(list.inlined());
+  EXPECT_FALSE(in_object(list));
+  EXPECT_EQ(list.capacity(), 12u);
+  for (int i = 9; i < 100; ++i) list.push_back(i);
+  for (int i = 0; i < 100; ++i) ASSERT_EQ(list.at(i), i);
+
+  // shrinking to fit moves the elements back inline
+  list.resize(5);
+  EXPECT_TRUE(list.inlined());
+  EXPECT_EQ(list.capacity(), 8u);
+  EXPECT_EQ(list.size(), 5u);
+  EXPECT_EQ(list.back(), 4);
+  list.reserve(20);
+  EXPECT_FALSE(list.inlined());
+  list.shrink_to_fit();
+  EXPECT_TRUE(list.inlined());
+  for (int i = 0; i < 5; ++i) EXPECT_EQ(list[i], i);
+}
+
+TEST(SmallLinearListTest, NonTrivialTest) {
+  Tracked::alive = Tracked::copies = 0;
+  if (1) {
+    SmallLinearList<Tracked, 4> list;
+    for (int i = 0; i < 4; ++i) list.emplace_back(i);
+    EXPECT_EQ(Tracked::alive, 4);
+    // spilling and growing move instead of copy
+    for (int i = 4; i < 50; ++i) list.emplace_back(i);
+    EXPECT_EQ(Tracked::alive, 50);
+    EXPECT_EQ(Tracked::copies, 0);
+
+    SmallLinearList<Tracked, 4> copy(list);
+    EXPECT_EQ(Tracked::alive, 100);
+    copy.resize(3);
+    EXPECT_TRUE(copy.inlined());
+    EXPECT_EQ(Tracked::alive, 53);
+    EXPECT_EQ(copy.back().val, 2);
+  }
+  EXPECT_EQ(Tracked::alive, 0);
+
+  SmallLinearList<std::string, 2> strs;
+  strs.push_back(std::string(40, 'a'));
+  strs.push_back(std::string(40, 'b'));
+  // the argument aliases an inline element that the spill relocates
+  strs.push_back(strs[0]);
+  EXPECT_EQ(strs.back(), std::string(40, 'a'));
+  EXPECT_EQ(strs.front(), std::string(40, 'a'));
+
+  SmallLinearList<std::unique_ptr<int>, 4> ptrs;
+  for (int i = 0; i < 3; ++i) ptrs.emplace_back(std::make_unique<int>(i));
+  SmallLinearList<std::unique_ptr<int>, 4> moved(std::move(ptrs));
+  EXPECT_TRUE(ptrs.empty());
+  EXPECT_TRUE(moved.inlined());
+  EXPECT_EQ(*moved.at(2), 2);
+}
+
+TEST(SmallLinearListTest, MoveAndSwap) {
+  using List = SmallLinearList<std::string, 3>;
+  auto make = [](int n, char c) {
+    List ret;
+    for (int i = 0; i < n; ++i) ret.emplace_back(20, (char)(c + i));
+    return ret;
+  };
+
+  // heap lists hand their block over
+  List big = make(10, 'a');
+  const std::string* block = big.first();
+  List stolen(std::move(big));
+  EXPECT_EQ(stolen.first(), block);
+  EXPECT_TRUE(big.empty());
+  EXPECT_TRUE(big.inlined());
+  big.push_back("reuse");
+  EXPECT_EQ(big.front(), "reuse");
+
+  // inline <-> heap, inline <-> inline, heap <-> heap
+  List small = make(2, 'x');
+  small.swap(stolen);
+  EXPECT_EQ(small.size(), 10u);
+  EXPECT_FALSE(small.inlined());
+  EXPECT_EQ(stolen.size(), 2u);
+  EXPECT_TRUE(stolen.inlined());
+  EXPECT_EQ(stolen[1], std::string(20, 'y'));
+
+  List tiny = make(1, 'q');
+  tiny.swap(stolen);
+  EXPECT_EQ(tiny.size(), 2u);
+  EXPECT_EQ(stolen.front(), std::string(20, 'q'));
+
+  List other = make(5, 'k');
+  other.swap(small);
+  EXPECT_EQ(other.size(), 10u);
+  EXPECT_EQ(small.back(), std::string(20, 'o'));
+
+  // assignment over a heap list releases its block
+  other = tiny;
+  EXPECT_EQ(other.size(), 2u);
+  EXPECT_TRUE(other.inlined());
+  small = std::move(other);
+  EXPECT_EQ(small[0], std::string(20, 'x'));
+  EXPECT_TRUE(other.empty());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,109 @@
+/**
+ * @file test_soa_list.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-30
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "adt/soa_list.hpp"
+#include "gtest/gtest.h"
+
+TEST(SoaListTest, RecordsAndColumns) {
+  SoaList<float, double, uint32_t> list;
+  EXPECT_TRUE(list.empty());
+  for (uint32_t i = 0; i < 1000; ++i)
+    list.emplace_back(i * 0.5f, i * 2.0, i);
+  list.push_back(std::make_tuple(-1.0f, -2.0, 7u));
+  EXPECT_EQ(list.size(), 1001u);
+
+  // fields through the proxy
+  auto [x, y, id] = list[10];
+  EXPECT_EQ(x, 5.0f);
+  EXPECT_EQ(y, 20.0);
+  EXPECT_EQ(id, 10u);
+  x = 100.0f;
+  EXPECT_EQ(std::get<0>(list[10]), 100.0f);
+  EXPECT_EQ(std::get<2>(list.back()), 7u);
+
+  // whole records: copy one over another
+  list[0] = list.value(1000);
+  EXPECT_EQ(list.value(0), std::make_tuple(-1.0f, -2.0, 7u));
+  EXPECT_EQ(list.at(1), std::make_tuple(0.5f, 2.0, 1u));
+
+  // columns are dense arrays
+  std::span<uint32_t> ids = list.column<2>();
+  ASSERT_EQ(ids.size(), 1001u);
+  EXPECT_EQ(&ids[1] - &ids[0], 1);
+  for (uint32_t& val : ids) val *= 2;
+  EXPECT_EQ(std::get<2>(list[500]), 1000u);
+  const auto& view = list;
+  std::span<const double> ys = view.column<1>();
+  EXPECT_EQ(std::accumulate(ys.begin() + 1, ys.begin() + 4, 0.0), 12.0);
+
+  list.pop_back();
+  EXPECT_EQ(list.size(), 1000u);
+  list.reserve(5000);
+  EXPECT_GE(list.capacity(), 5000u);
+  list.clear();
+  EXPECT_TRUE(list.empty());
+  list.shrink_to_fit();
+  EXPECT_EQ(list.capacity(), 0u);
+}
+
+TEST(SoaListTest, NonTrivialFields) {
+  SoaList<std::string, int> list;
+  list.emplace_back("alpha", 1);
+  list.push_back(std::make_tuple(std::string("beta"), 2));
+  std::tuple<std::string, int> gamma("gamma", 3);
+  list.push_back(gamma);
+
+  SoaList<std::string, int> copy(list);
+  std::get<0>(copy[0]) = "changed";
+  EXPECT_EQ(std::get<0>(list.front()), "alpha");
+  EXPECT_EQ(copy.column<0>()[2], "gamma");
+
+  SoaList<std::string, int> moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  moved.swap(list);
+  EXPECT_EQ(std::get<0>(moved[0]), "alpha");
+  EXPECT_EQ(std::get<0>(list[0]), "changed");
+}
+
+// throws when constructed from a negative value
+struct Picky {
+  int val;
+  explicit Picky(int v) : val(v) {
+    if (v < 0) throw std::invalid_argument("negative");
+  }
+};
+
+TEST(SoaListTest, PushBackIsAllOrNothing) {
+  SoaList<int, std::string, Picky> list;
+  list.emplace_back(1, "one", 1);
+  EXPECT_THROW(list.emplace_back(2, "two", -2), std::invalid_argument);
+  // the fields appended before the failure are gone again
+  EXPECT_EQ(list.size(), 1u);
+  EXPECT_EQ(list.column<0>().size(), 1u);
+  EXPECT_EQ(list.column<1>().size(), 1u);
+  list.emplace_back(3, "three", 3);
+  EXPECT_EQ(std::get<1>(list.back()), "three");
+  EXPECT_EQ(std::get<2>(list.back()).val, 3);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
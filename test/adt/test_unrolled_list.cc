@@ -0,0 +1,149 @@
+/**
+ * @file test_unrolled_list.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-10
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <deque>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "adt/unrolled_list.hpp"
+#include "gtest/gtest.h"
+
+template <class List, class Model>
+static void expect_same(const List& list, const Model& model) {
+  ASSERT_EQ(list.size(), model.size());
+  EXPECT_TRUE(std::equal(list.begin(), list.end(), model.begin()));
+}
+
+TEST(UnrolledListTest, LayoutTest) {
+  // a chunk of small elements fits a cache line
+  EXPECT_EQ(sizeof(UnrolledList<int>::Chunk), 64u);
+  EXPECT_EQ(alignof(UnrolledList<int>::Chunk), 64u);
+  EXPECT_EQ(UnrolledList<int>::CAPACITY, 10u);
+  EXPECT_EQ(UnrolledList<double>::CAPACITY, 5u);
+}
+
+TEST(UnrolledListTest, DequeOpsTest) {
+  /**
+   * @brief
+   *
+   * pushes and pops at both ends shall behave exactly like std::deque.
+   */
+  std::mt19937 rnd(42);
+  UnrolledList<int> list;
+  std::deque<int> model;
+
+  for (int i = 0; i < 20000; ++i) {
+    switch (rnd() % 5) {
+      case 0:
+      case 1:
+        list.push_back(i), model.push_back(i);
+        break;
+      case 2:
+        list.push_front(i), model.push_front(i);
+        break;
+      case 3:
+        if (!model.empty()) list.pop_back(), model.pop_back();
+        break;
+      case 4:
+        if (!model.empty()) list.pop_front(), model.pop_front();
+        break;
+    }
+  }
+  expect_same(list, model);
+  EXPECT_EQ(list.front(), model.front());
+  EXPECT_EQ(list.back(), model.back());
+  EXPECT_EQ(*std::prev(list.end()), model.back());
+}
+
+template <class Ty>
+static void random_insert_erase(unsigned seed) {
+  std::mt19937 rnd(seed);
+  UnrolledList<Ty> list;
+  std::list<Ty> model;
+
+  for (int i = 0; i < 4000; ++i) {
+    size_t idx = model.empty() ? 0 : rnd() % (model.size() + 1);
+    auto it = list.begin();
+    auto mit = model.begin();
+    std::advance(it, idx), std::advance(mit, idx);
+
+    if (rnd() % 3 == 0 && mit != model.end()) {
+      auto next = list.erase(it);
+      auto mnext = model.erase(mit);
+      if (mnext != model.end()) {
+        ASSERT_EQ(*next, *mnext);
+      }
+    } else {
+      Ty val;
+      if constexpr (std::is_same_v<Ty, std::string>)
+        val = std::to_string(i);
+      else
+        val = (Ty)i;
+      auto ins = list.insert(it, val);
+      model.insert(mit, val);
+      ASSERT_EQ(*ins, val);
+    }
+  }
+  expect_same(list, model);
+  EXPECT_LE(list.chunks(), list.size() / (UnrolledList<Ty>::CAPACITY / 4) + 1);
+
+  UnrolledList<Ty> copy(list);
+  expect_same(copy, model);
+}
+
+TEST(UnrolledListTest, InsertEraseTest) {
+  /**
+   * @brief
+   *
+   * random insertion and erasure in the middle shall match std::list, and
+   * chunks shall stay reasonably dense.
+   */
+  random_insert_erase<std::string>(7);
+  random_insert_erase<int>(11);
+}
+
+TEST(UnrolledListTest, SpliceTest) {
+  UnrolledList<int> a, b;
+  std::vector<int> model;
+  for (int i = 0; i < 100; ++i) a.push_back(i);
+  for (int i = 0; i < 35; ++i) b.push_back(1000 + i);
+
+  auto pos = a.begin();
+  std::advance(pos, 43);
+  a.splice(pos, b);
+
+  for (int i = 0; i < 43; ++i) model.push_back(i);
+  for (int i = 0; i < 35; ++i) model.push_back(1000 + i);
+  for (int i = 43; i < 100; ++i) model.push_back(i);
+
+  expect_same(a, model);
+  EXPECT_TRUE(b.empty());
+  EXPECT_EQ(b.begin(), b.end());
+
+  // splice at both ends
+  UnrolledList<int> c, d;
+  c.push_back(-1), d.push_back(-2);
+  a.splice(a.begin(), c);
+  a.splice(a.end(), d);
+  EXPECT_EQ(a.front(), -1);
+  EXPECT_EQ(a.back(), -2);
+  EXPECT_EQ(a.size(), 137u);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
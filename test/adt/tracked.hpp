@@ -0,0 +1,30 @@
+/**
+ * @file tracked.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file defines Tracked, a test payload that counts its live objects
+ * and the copies made of them, so container tests can check that elements
+ * are constructed, moved and destroyed exactly once.
+ */
+
+#ifndef TRACKED_HPP_
+#define TRACKED_HPP_
+
+struct Tracked {
+  static inline int alive = 0, copies = 0;
+
+  int val;
+  explicit Tracked(int v = 0) : val(v) { alive++; }
+  Tracked(const Tracked& oth) : val(oth.val) { alive++, copies++; }
+  Tracked(Tracked&& oth) noexcept : val(oth.val) { alive++; }
+  Tracked& operator=(const Tracked&) = default;
+  Tracked& operator=(Tracked&&) = default;
+  ~Tracked() { alive--; }
+};
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * @file test_adaptive_lock.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrency/adaptive_lock.hpp"
+#include "gtest/gtest.h"
+
+TEST(AdaptiveMutexTest, TryLock) {
+  AdaptiveMutex mtx;
+  EXPECT_TRUE(mtx.try_lock());
+  std::thread([&]() { EXPECT_FALSE(mtx.try_lock()); }).join();
+  mtx.unlock();
+  std::thread([&]() {
+    EXPECT_TRUE(mtx.try_lock());
+    mtx.unlock();
+  }).join();
+}
+
+TEST(AdaptiveMutexTest, TinyCriticalSections) {
+  // the appends of CxxstdMutexTest.LockTest, many times over
+  AdaptiveMutex mtx;
+  std::string shared_res;
+  const int threads = 8, rounds = 20000;
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t)
+    workers.emplace_back([&, t]() {
+      for (int i = 0; i < rounds; ++i) {
+        std::lock_guard<AdaptiveMutex> lock(mtx);
+        shared_res += (char)('a' + t);
+      }
+    });
+  for (auto& w : workers) w.join();
+
+  ASSERT_EQ(shared_res.size(), (size_t)threads * rounds);
+  for (int t = 0; t < threads; ++t)
+    EXPECT_EQ(std::count(shared_res.begin(), shared_res.end(), 'a' + t),
+              rounds);
+}
+
+TEST(AdaptiveMutexTest, ParkAndWake) {
+  // the holder keeps the lock long enough for the waiters to park
+  AdaptiveMutex mtx;
+  std::atomic<int> done{0};
+  mtx.lock();
+  std::vector<std::thread> waiters;
+  for (int t = 0; t < 4; ++t)
+    waiters.emplace_back([&]() {
+      mtx.lock();
+      done++;
+      mtx.unlock();
+    });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(done.load(), 0);
+  mtx.unlock();
+  for (auto& w : waiters) w.join();
+  EXPECT_EQ(done.load(), 4);
+}
+
+TEST(AdaptiveSharedMutexTest, SharedAndExclusive) {
+  AdaptiveSharedMutex mtx;
+  mtx.lock_shared();
+  EXPECT_TRUE(mtx.try_lock_shared());
+  EXPECT_FALSE(mtx.try_lock());
+  std::thread([&]() {
+    EXPECT_TRUE(mtx.try_lock_shared());
+    mtx.unlock_shared();
+    EXPECT_FALSE(mtx.try_lock());
+  }).join();
+  mtx.unlock_shared();
+  mtx.unlock_shared();
+
+  EXPECT_TRUE(mtx.try_lock());
+  std::thread([&]() {
+    EXPECT_FALSE(mtx.try_lock_shared());
+    EXPECT_FALSE(mtx.try_lock());
+  }).join();
+  mtx.unlock();
+}
+
+TEST(AdaptiveSharedMutexTest, ReadMostly) {
+  // writers keep two fields equal; readers must never see them differ
+  AdaptiveSharedMutex mtx;
+  uint64_t a = 0, b = 0;
+  std::atomic<bool> torn{false};
+  std::atomic<uint64_t> reads{0};
+  const int readers = 6, writers = 2, rounds = 5000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < writers; ++t)
+    threads.emplace_back([&]() {
+      for (int i = 0; i < rounds; ++i) {
+        std::lock_guard<AdaptiveSharedMutex> lock(mtx);
+        a++;
+        b++;
+      }
+    });
+  for (int t = 0; t < readers; ++t)
+    threads.emplace_back([&]() {
+      for (int i = 0; i < rounds * 4; ++i) {
+        std::shared_lock<AdaptiveSharedMutex> lock(mtx);
+        if (a != b) torn = true;
+        reads++;
+      }
+    });
+  for (auto& t : threads) t.join();
+
+  EXPECT_FALSE(torn.load());
+  EXPECT_EQ(a, (uint64_t)writers * rounds);
+  EXPECT_EQ(reads.load(), (uint64_t)readers * rounds * 4);
+}
+
+TEST(AdaptiveSharedMutexTest, WriterWaitsForReaders) {
+  AdaptiveSharedMutex mtx;
+  std::atomic<bool> written{false};
+  mtx.lock_shared();
+  std::thread writer([&]() {
+    std::lock_guard<AdaptiveSharedMutex> lock(mtx);
+    written = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(written.load());
+  mtx.unlock_shared();
+  writer.join();
+  EXPECT_TRUE(written.load());
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,232 @@
+/**
+ * @file test_async.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-01
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "concurrency/async.hpp"
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+static Async::Task<int> add(int a, int b) { co_return a + b; }
+
+static Async::Task<int> sum_to(int n) {
+  int ret = 0;
+  for (int i = 1; i <= n; ++i) ret = co_await add(ret, i);
+  co_return ret;
+}
+
+static Async::Task<std::unique_ptr<std::string>> make_string() {
+  co_return std::make_unique<std::string>("move-only");
+}
+
+static Async::Task<> fail() {
+  throw std::runtime_error("failed");
+  co_return;
+}
+
+static Async::Task<int> catch_failure() {
+  try {
+    co_await fail();
+  } catch (const std::runtime_error&) {
+    co_return 1;
+  }
+  co_return 0;
+}
+
+TEST(AsyncTaskTest, ChainsAndResults) {
+  EXPECT_EQ(Async::sync_wait(add(1, 2)), 3);
+  // a long chain of awaits runs without growing the stack
+  EXPECT_EQ(Async::sync_wait(sum_to(1000)), 500500);
+  EXPECT_EQ(*Async::sync_wait(make_string()), "move-only");
+
+  EXPECT_THROW(Async::sync_wait(fail()), std::runtime_error);
+  EXPECT_EQ(Async::sync_wait(catch_failure()), 1);
+
+  // tasks are lazy: nothing runs until it is awaited
+  bool ran = false;
+  auto lazy = [](bool& ran) -> Async::Task<> {
+    ran = true;
+    co_return;
+  };
+  Async::Task<> task = lazy(ran);
+  EXPECT_FALSE(ran);
+  Async::sync_wait(std::move(task));
+  EXPECT_TRUE(ran);
+}
+
+TEST(AsyncTaskTest, ScheduleAndSpawn) {
+  ThreadPool pool(2);
+  auto where = [](ThreadPool& pool) -> Async::Task<ThreadPool*> {
+    EXPECT_EQ(ThreadPool::current(), nullptr);
+    co_await Async::schedule(pool);
+    ThreadPool* first = ThreadPool::current();
+    co_await Async::yield();
+    EXPECT_EQ(ThreadPool::current(), first);
+    co_return first;
+  };
+  EXPECT_EQ(Async::sync_wait(where(pool)), &pool);
+
+  std::atomic<int> done{0};
+  auto job = [](std::atomic<int>& done) -> Async::Task<> {
+    done++;
+    co_return;
+  };
+  for (int i = 0; i < 100; ++i) Async::spawn(pool, job(done));
+  while (done.load() < 100) std::this_thread::yield();
+}
+
+TEST(AsyncTimerTest, SleepFor) {
+  ThreadPool pool(2);
+  auto nap =
+      [](ThreadPool& pool) -> Async::Task<Async::Timer::Clock::duration> {
+    co_await Async::schedule(pool);
+    const auto begin = std::chrono::steady_clock::now();
+    co_await Async::sleep_for(30ms);
+    // resumed on the pool it slept on
+    EXPECT_EQ(ThreadPool::current(), &pool);
+    co_return std::chrono::steady_clock::now() - begin;
+  };
+  const auto slept = Async::sync_wait(nap(pool));
+  EXPECT_GE(slept, 30ms);
+  EXPECT_LT(slept, 500ms);
+
+  // a deadline in the past does not suspend at all
+  auto late = []() -> Async::Task<int> {
+    co_await Async::sleep_until(std::chrono::steady_clock::now() - 1s);
+    co_return 7;
+  };
+  EXPECT_EQ(Async::sync_wait(late()), 7);
+}
+
+TEST(AsyncTimerTest, ThousandsOfSleepers) {
+  // 10000 concurrent sleeps on two workers and one timer thread
+  const int sleepers = 10000;
+  ThreadPool pool(2);
+  Async::Timer timer;
+  Async::Semaphore finished;
+
+  auto sleeper = [](Async::Timer& timer, Async::Semaphore& finished,
+                    int i) -> Async::Task<> {
+    const auto deadline = Async::Timer::Clock::now() + 1ms * (i % 50 + 10);
+    co_await timer.sleep_until(deadline);
+    EXPECT_GE(Async::Timer::Clock::now(), deadline);
+    finished.release();
+  };
+  auto all = [&]() -> Async::Task<> {
+    for (int i = 0; i < sleepers; ++i)
+      Async::spawn(pool, sleeper(timer, finished, i));
+    for (int i = 0; i < sleepers; ++i) co_await finished.acquire();
+  };
+  const auto begin = std::chrono::steady_clock::now();
+  Async::sync_wait(all());
+  EXPECT_LT(std::chrono::steady_clock::now() - begin, 5s);
+  EXPECT_EQ(timer.pending(), 0u);
+}
+
+TEST(AsyncTimerTest, WakesInDeadlineOrder) {
+  // one worker resumes the sleepers in the order the timer wakes them
+  ThreadPool pool(1);
+  Async::Timer timer;
+  std::string order;
+  std::mutex mtx;
+  Async::Semaphore finished;
+  auto sleeper = [&](char c, int ms) -> Async::Task<> {
+    co_await timer.sleep_for(std::chrono::milliseconds(ms));
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      order += c;
+    }
+    finished.release();
+  };
+  auto all = [&]() -> Async::Task<> {
+    Async::spawn(pool, sleeper('c', 60));
+    Async::spawn(pool, sleeper('a', 20));
+    Async::spawn(pool, sleeper('b', 40));
+    for (int i = 0; i < 3; ++i) co_await finished.acquire();
+  };
+  Async::sync_wait(all());
+  EXPECT_EQ(order, "abc");
+}
+
+TEST(AsyncMutexTest, MutualExclusion) {
+  ThreadPool pool(4);
+  Async::Mutex mtx;
+  Async::Semaphore finished;
+  const int tasks = 16, rounds = 500;
+  int counter = 0;
+  int inside = 0, max_inside = 0;
+
+  auto worker = [&]() -> Async::Task<> {
+    for (int r = 0; r < rounds; ++r) {
+      auto guard = co_await mtx.scoped_lock();
+      max_inside = std::max(max_inside, ++inside);
+      const int seen = counter;
+      // hold the lock across a suspension now and then
+      if (r % 50 == 0) co_await Async::yield();
+      counter = seen + 1;
+      --inside;
+    }
+    finished.release();
+  };
+  auto all = [&]() -> Async::Task<> {
+    for (int t = 0; t < tasks; ++t) Async::spawn(pool, worker());
+    for (int t = 0; t < tasks; ++t) co_await finished.acquire();
+  };
+  Async::sync_wait(all());
+  EXPECT_EQ(counter, tasks * rounds);
+  EXPECT_EQ(max_inside, 1);
+
+  EXPECT_TRUE(mtx.try_lock());
+  EXPECT_FALSE(mtx.try_lock());
+  mtx.unlock();
+}
+
+TEST(AsyncSemaphoreTest, LimitsConcurrency) {
+  ThreadPool pool(4);
+  Async::Semaphore slots(3), finished;
+  std::atomic<int> inside{0}, max_inside{0};
+  const int tasks = 30;
+
+  auto worker = [&]() -> Async::Task<> {
+    co_await slots.acquire();
+    const int now = ++inside;
+    int seen = max_inside.load();
+    while (now > seen && !max_inside.compare_exchange_weak(seen, now)) {
+    }
+    co_await Async::sleep_for(2ms);
+    --inside;
+    slots.release();
+    finished.release();
+  };
+  auto all = [&]() -> Async::Task<> {
+    for (int t = 0; t < tasks; ++t) Async::spawn(pool, worker());
+    for (int t = 0; t < tasks; ++t) co_await finished.acquire();
+  };
+  Async::sync_wait(all());
+  EXPECT_EQ(max_inside.load(), 3);
+  EXPECT_EQ(slots.available(), 3u);
+
+  EXPECT_TRUE(slots.try_acquire());
+  slots.release(2);
+  EXPECT_EQ(slots.available(), 4u);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
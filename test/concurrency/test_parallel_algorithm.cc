@@ -0,0 +1,180 @@
+/**
+ * @file test_parallel_algorithm.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-23
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#include "adt/linear_list.hpp"
+#include "concurrency/parallel_algorithm.hpp"
+#include "concurrency/thread_pool.hpp"
+#include "gtest/gtest.h"
+#include "math/carmack_batch.hpp"
+#include "math/carmack_magic.hpp"
+
+namespace PA = ParallelAlgorithm;
+
+// large enough to be cut into many chunks
+const static size_t N = 300007;
+
+static LinearList<uint64_t> iota_list(size_t n) {
+  LinearList<uint64_t> ret;
+  ret.reserve(n);
+  for (size_t i = 0; i < n; ++i) ret.push_back(i);
+  return ret;
+}
+
+TEST(ParallelAlgorithmTest, ChunkSize) {
+  // whole cache lines, and never below MIN_CHUNK_BYTES
+  EXPECT_EQ(PA::chunk_size<float>(10, 8) % 16, 0u);
+  EXPECT_GE(PA::chunk_size<float>(10, 8) * sizeof(float), PA::MIN_CHUNK_BYTES);
+  size_t chunk = PA::chunk_size<double>(1u << 24, 4);
+  EXPECT_EQ(chunk % 8, 0u);
+  EXPECT_EQ((((1u << 24) + chunk - 1) / chunk), 4 * PA::CHUNKS_PER_WORKER);
+}
+
+TEST(ParallelAlgorithmTest, ForEach) {
+  ThreadPool pool(4);
+  LinearList<uint64_t> list = iota_list(N);
+  PA::for_each(pool, list, [](uint64_t& x) { x = x * 3 + 1; });
+  for (size_t i = 0; i < N; ++i) ASSERT_EQ(list[i], i * 3 + 1);
+
+  // chunks tile the range in order
+  size_t covered = 0;
+  std::atomic<size_t> calls{0};
+  PA::for_each_chunk(pool, list, [&](std::span<uint64_t> chunk) {
+    calls++;
+    for (uint64_t& x : chunk) x = 0;
+  });
+  for (size_t i = 0; i < N; ++i) covered += (list[i] == 0);
+  EXPECT_EQ(covered, N);
+  EXPECT_GT(calls.load(), 1u);
+
+  LinearList<uint64_t> empty;
+  PA::for_each(pool, empty, [](uint64_t&) { FAIL(); });
+}
+
+TEST(ParallelAlgorithmTest, Transform) {
+  ThreadPool pool(3);
+  const LinearList<uint64_t> in = iota_list(N);
+  LinearList<uint64_t> out = iota_list(N);
+  PA::transform(pool, in, out, [](uint64_t x) { return x * x; });
+  for (size_t i = 0; i < N; ++i) ASSERT_EQ(out[i], (uint64_t)i * i);
+}
+
+TEST(ParallelAlgorithmTest, Reduce) {
+  ThreadPool pool(4);
+  LinearList<uint64_t> list = iota_list(N);
+  EXPECT_EQ(PA::reduce(pool, list, uint64_t(5)),
+            5 + (uint64_t)N * (N - 1) / 2);
+  EXPECT_EQ(PA::reduce(pool, list, uint64_t(0),
+                       [](uint64_t a, uint64_t b) { return std::max(a, b); }),
+            N - 1);
+
+  // the operands are folded in order: a non-commutative op still works
+  LinearList<std::string> words;
+  for (size_t i = 0; i < 20000; ++i)
+    words.push_back(std::string(1, 'a' + i % 26));
+  std::string serial = "^";
+  for (size_t i = 0; i < words.size(); ++i) serial += words[i];
+  EXPECT_EQ(PA::reduce(pool, words, std::string("^")), serial);
+
+  LinearList<uint64_t> empty;
+  EXPECT_EQ(PA::reduce(pool, empty, uint64_t(7)), 7u);
+}
+
+TEST(ParallelAlgorithmTest, Scan) {
+  ThreadPool pool(4);
+  LinearList<uint64_t> list = iota_list(N);
+  PA::scan(pool, list);
+  for (size_t i = 0; i < N; ++i) ASSERT_EQ(list[i], (uint64_t)i * (i + 1) / 2);
+
+  LinearList<uint64_t> ones;
+  for (size_t i = 0; i < N; ++i) ones.push_back(i % 7 == 3 ? 9 : 1);
+  LinearList<uint64_t> expect = ones;
+  for (size_t i = 1; i < N; ++i) expect[i] = std::max(expect[i - 1], expect[i]);
+  PA::scan(pool, ones, [](uint64_t a, uint64_t b) { return std::max(a, b); });
+  for (size_t i = 0; i < N; ++i) ASSERT_EQ(ones[i], expect[i]);
+}
+
+TEST(ParallelAlgorithmTest, Sort) {
+  std::mt19937_64 rng(42);
+  for (size_t threads : {1u, 4u}) {
+    ThreadPool pool(threads);
+    for (size_t n : {(size_t)0, (size_t)1, (size_t)1000, N}) {
+      LinearList<uint64_t> list;
+      for (size_t i = 0; i < n; ++i) list.push_back(rng() % 1000);
+      LinearList<uint64_t> expect = list;
+      std::sort(expect.first(), expect.first() + n);
+      PA::sort(pool, list);
+      for (size_t i = 0; i < n; ++i) ASSERT_EQ(list[i], expect[i]);
+    }
+  }
+
+  ThreadPool pool(4);
+  LinearList<std::string> strs;
+  for (size_t i = 0; i < 50000; ++i) strs.push_back(std::to_string(rng()));
+  LinearList<std::string> expect = strs;
+  std::sort(expect.first(), expect.first() + expect.size(),
+            std::greater<>());
+  PA::sort(pool, strs, std::greater<>());
+  for (size_t i = 0; i < strs.size(); ++i) ASSERT_EQ(strs[i], expect[i]);
+}
+
+TEST(ParallelAlgorithmTest, NestedInPool) {
+  // an algorithm called from a task forks onto the same pool
+  ThreadPool pool(2);
+  auto fut = pool.submit([&pool]() {
+    LinearList<uint64_t> list = iota_list(N);
+    PA::scan(pool, list);
+    return list[N - 1];
+  });
+  EXPECT_EQ(pool.wait(fut), (uint64_t)N * (N - 1) / 2);
+}
+
+TEST(ParallelAlgorithmTest, Exception) {
+  ThreadPool pool(4);
+  LinearList<uint64_t> list = iota_list(N);
+  EXPECT_THROW(PA::for_each(pool, list,
+                            [](uint64_t& x) {
+                              if (x == N - 1) throw std::runtime_error("x");
+                            }),
+               std::runtime_error);
+}
+
+TEST(ParallelAlgorithmTest, Rsqrt) {
+  ThreadPool pool(4);
+  LinearList<float> list;
+  for (size_t i = 0; i < N; ++i) list.push_back(1.0f + (float)i);
+  LinearList<float> batch = list;
+
+  // element-wise with the scalar kernel
+  PA::for_each(pool, list, [](float& x) { x = CarmackMagic::Q_rsqrt(x); });
+  // chunk-wise with the batch kernel
+  PA::for_each_chunk(pool, batch, [](std::span<float> chunk) {
+    CarmackBatch::rsqrt_inplace(chunk);
+  });
+  for (size_t i = 0; i < N; ++i) {
+    float exact = 1.0f / std::sqrt(1.0f + (float)i);
+    ASSERT_NEAR(list[i], exact, exact * 2e-3f);
+    ASSERT_NEAR(batch[i], exact, exact * 2e-3f);
+  }
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
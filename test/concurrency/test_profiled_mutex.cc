@@ -0,0 +1,127 @@
+/**
+ * @file test_profiled_mutex.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-24
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Built twice: with profiling, and with HYPERION_LOCK_PROFILING=0.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "concurrency/profiled_mutex.hpp"
+#include "gtest/gtest.h"
+
+TEST(ProfiledMutexTest, MutualExclusion) {
+  ProfiledMutex mtx;
+  uint64_t counter = 0;
+  const int threads = 4, rounds = 20000;
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t)
+    workers.emplace_back([&]() {
+      for (int i = 0; i < rounds; ++i) {
+        std::lock_guard<ProfiledMutex> lock(mtx);
+        counter++;
+      }
+    });
+  for (auto& w : workers) w.join();
+  EXPECT_EQ(counter, (uint64_t)threads * rounds);
+
+  ProfiledMutexStats stats = mtx.stats();
+#if HYPERION_LOCK_PROFILING
+  EXPECT_EQ(stats.acquisitions, (uint64_t)threads * rounds);
+  EXPECT_LE(stats.contended, stats.acquisitions);
+  uint64_t waits = 0, holds = 0;
+  for (size_t b = 0; b < ProfiledMutexDetail::BUCKETS; ++b)
+    waits += stats.wait_hist[b], holds += stats.hold_hist[b];
+  EXPECT_EQ(waits, stats.acquisitions);
+  EXPECT_EQ(holds, stats.acquisitions);
+#else
+  EXPECT_EQ(stats.acquisitions, 0u);
+#endif
+}
+
+TEST(ProfiledMutexTest, TryLock) {
+  ProfiledMutex mtx;
+  EXPECT_TRUE(mtx.try_lock());
+  std::thread([&]() { EXPECT_FALSE(mtx.try_lock()); }).join();
+  mtx.unlock();
+
+#if HYPERION_LOCK_PROFILING
+  ProfiledMutexStats stats = mtx.stats();
+  EXPECT_EQ(stats.acquisitions, 1u);
+  EXPECT_EQ(stats.contended, 0u);
+  EXPECT_EQ(stats.failed_try_locks, 1u);
+  EXPECT_EQ(stats.wait_hist[0], 1u);
+
+  mtx.reset();
+  EXPECT_EQ(mtx.stats().acquisitions, 0u);
+  EXPECT_EQ(mtx.stats().failed_try_locks, 0u);
+#endif
+}
+
+TEST(ProfiledMutexTest, WaitAndHold) {
+  // what CxxstdMutexTest.TryLockTest shows with "w" characters, as numbers
+  ProfiledMutex mtx;
+  std::mutex gate_mtx;
+  std::condition_variable gate;
+  bool held = false;
+
+  std::thread holder([&]() {
+    std::lock_guard<ProfiledMutex> lock(mtx);
+    {
+      std::lock_guard<std::mutex> g(gate_mtx);
+      held = true;
+    }
+    gate.notify_one();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  });
+  {
+    std::unique_lock<std::mutex> g(gate_mtx);
+    gate.wait(g, [&]() { return held; });
+  }
+  mtx.lock();
+  mtx.unlock();
+  holder.join();
+
+#if HYPERION_LOCK_PROFILING
+  ProfiledMutexStats stats = mtx.stats();
+  EXPECT_EQ(stats.acquisitions, 2u);
+  EXPECT_EQ(stats.contended, 1u);
+  EXPECT_DOUBLE_EQ(stats.contention_ratio(), 0.5);
+  // the waiter blocked for a good part of the 50ms, the holder held them all
+  EXPECT_GE(stats.wait_ns, 10'000'000u);
+  EXPECT_GE(stats.hold_ns, 50'000'000u);
+  EXPECT_GE(ProfiledMutexStats::quantile(stats.hold_hist, 1.0), 50'000'000u);
+  EXPECT_GE(ProfiledMutexStats::quantile(stats.wait_hist, 1.0), 10'000'000u);
+  EXPECT_EQ(ProfiledMutexStats::quantile(stats.wait_hist, 0.0), 0u);
+#endif
+}
+
+TEST(ProfiledMutexTest, Quantile) {
+  uint64_t hist[ProfiledMutexDetail::BUCKETS] = {};
+  EXPECT_EQ(ProfiledMutexStats::quantile(hist, 0.5), 0u);
+  EXPECT_EQ(ProfiledMutexDetail::bucket(0), 0u);
+  EXPECT_EQ(ProfiledMutexDetail::bucket(1), 1u);
+  EXPECT_EQ(ProfiledMutexDetail::bucket(1000), 10u);
+  EXPECT_EQ(ProfiledMutexDetail::bucket(UINT64_MAX),
+            ProfiledMutexDetail::BUCKETS - 1);
+
+  hist[ProfiledMutexDetail::bucket(100)] = 90;
+  hist[ProfiledMutexDetail::bucket(5000)] = 10;
+  EXPECT_EQ(ProfiledMutexStats::quantile(hist, 0.5), 127u);
+  EXPECT_EQ(ProfiledMutexStats::quantile(hist, 0.99), 8191u);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,159 @@
+/**
+ * @file test_thread_pool.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-22
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "concurrency/chase_lev_deque.hpp"
+#include "concurrency/thread_pool.hpp"
+#include "gtest/gtest.h"
+
+TEST(ChaseLevDequeTest, OwnerOps) {
+  ChaseLevDeque<int> deque(2);
+  EXPECT_TRUE(deque.empty());
+  EXPECT_FALSE(deque.pop().has_value());
+  EXPECT_FALSE(deque.steal().has_value());
+
+  // grows past the initial capacity
+  for (int i = 0; i < 100; ++i) deque.push(i);
+  EXPECT_EQ(deque.size(), 100u);
+
+  // the owner pops LIFO, thieves steal FIFO
+  EXPECT_EQ(*deque.pop(), 99);
+  EXPECT_EQ(*deque.steal(), 0);
+  EXPECT_EQ(*deque.steal(), 1);
+  for (int i = 98; i >= 2; --i) EXPECT_EQ(*deque.pop(), i);
+  EXPECT_TRUE(deque.empty());
+  EXPECT_FALSE(deque.pop().has_value());
+}
+
+TEST(ChaseLevDequeTest, ConcurrentSteal) {
+  ChaseLevDeque<uint64_t> deque;
+  const uint64_t total = 200000;
+  const int thieves = 3;
+  std::atomic<uint64_t> sum{0}, taken{0};
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thieves; ++t)
+    threads.emplace_back([&]() {
+      uint64_t local = 0, cnt = 0;
+      while (!done.load() || !deque.empty()) {
+        if (auto val = deque.steal()) {
+          local += *val;
+          cnt++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+      sum += local;
+      taken += cnt;
+    });
+
+  uint64_t local = 0, cnt = 0;
+  for (uint64_t i = 1; i <= total; ++i) {
+    deque.push(i);
+    // the owner takes some back, racing the thieves for the last ones
+    if (i % 3 == 0) {
+      if (auto val = deque.pop()) {
+        local += *val;
+        cnt++;
+      }
+    }
+  }
+  while (auto val = deque.pop()) {
+    local += *val;
+    cnt++;
+  }
+  done = true;
+  for (auto& t : threads) t.join();
+
+  // every element is taken exactly once
+  EXPECT_EQ(taken.load() + cnt, total);
+  EXPECT_EQ(sum.load() + local, total * (total + 1) / 2);
+}
+
+TEST(ThreadPoolTest, Submit) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.size(), 4u);
+
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 1000; ++i)
+    futures.push_back(pool.submit([](int x) { return x * x; }, i));
+  for (int i = 0; i < 1000; ++i) EXPECT_EQ(futures[i].get(), i * i);
+
+  auto fail = pool.submit([]() -> int { throw std::runtime_error("task"); });
+  EXPECT_THROW(fail.get(), std::runtime_error);
+
+  auto self = pool.submit([&pool]() { return ThreadPool::current() == &pool; });
+  EXPECT_TRUE(self.get());
+  EXPECT_EQ(ThreadPool::current(), nullptr);
+}
+
+TEST(ThreadPoolTest, PostAndDrain) {
+  std::atomic<int> count{0};
+  {
+    ThreadPool pool(3);
+    for (int i = 0; i < 10000; ++i) pool.post([&count]() { count++; });
+  }
+  // the destructor runs every task submitted before it
+  EXPECT_EQ(count.load(), 10000);
+}
+
+static uint64_t fib(ThreadPool& pool, int n) {
+  if (n < 2) return n;
+  if (n < 12) return fib(pool, n - 1) + fib(pool, n - 2);
+  auto left = pool.submit(fib, std::ref(pool), n - 1);
+  uint64_t right = fib(pool, n - 2);
+  return pool.wait(left) + right;
+}
+
+TEST(ThreadPoolTest, NestedForkJoin) {
+  // more joins in flight than workers: wait() must keep the workers busy
+  for (size_t threads : {1u, 2u, 4u}) {
+    ThreadPool pool(threads);
+    auto fut = pool.submit(fib, std::ref(pool), 24);
+    EXPECT_EQ(pool.wait(fut), 46368u);
+  }
+}
+
+TEST(ThreadPoolTest, ExternalHelp) {
+  ThreadPool pool(1);
+  std::promise<void> gate;
+  std::shared_future<void> opened = gate.get_future().share();
+  std::atomic<bool> started{false};
+  pool.post([opened, &started]() {
+    started = true;
+    opened.wait();
+  });
+  while (!started.load()) std::this_thread::yield();
+
+  // the only worker is blocked, so the submitter runs the task itself
+  auto fut = pool.submit([]() { return 7; });
+  EXPECT_EQ(pool.wait(fut), 7);
+  gate.set_value();
+}
+
+TEST(ThreadPoolTest, Pinned) {
+  ThreadPool pool(2, true);
+  auto fut = pool.submit([]() { return 1; });
+  EXPECT_EQ(fut.get(), 1);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
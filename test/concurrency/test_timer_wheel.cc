@@ -0,0 +1,183 @@
+/**
+ * @file test_timer_wheel.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-05-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <thread>
+
+#include "adt/linear_list.hpp"
+#include "concurrency/thread_pool.hpp"
+#include "concurrency/timer_wheel.hpp"
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+TEST(TimerWheelTest, FiresOnItsTick) {
+  // delays on every level, at the level edges and beyond the wheel
+  const uint64_t delays[] = {0,         1,          2,         255,
+                             256,       257,        65535,     65536,
+                             65537,     1000000,    16777215,  16777216,
+                             123456789, 4294967295, 4294967296, 10000000000};
+  for (uint64_t start : {uint64_t(0), uint64_t(200), uint64_t(65530),
+                         uint64_t(4294967290)}) {
+    for (uint64_t delay : delays) {
+      TimerWheel<> wheel(start);
+      uint64_t fired = 0;
+      wheel.schedule_after(delay, [&]() { fired = wheel.now(); });
+      const uint64_t expiry = start + std::max<uint64_t>(delay, 1);
+      EXPECT_EQ(wheel.advance(expiry - 1), 0u) << start << " + " << delay;
+      EXPECT_LE(wheel.next_tick(), expiry);
+      EXPECT_EQ(wheel.advance(expiry), 1u) << start << " + " << delay;
+      EXPECT_EQ(fired, expiry);
+      EXPECT_TRUE(wheel.empty());
+      EXPECT_EQ(wheel.next_tick(), TimerWheelDetail::NEVER);
+    }
+  }
+}
+
+TEST(TimerWheelTest, RandomScheduleCancelAdvance) {
+  // every timer fires in the advance that passes its expiry, never early,
+  // never late and never after it was cancelled
+  std::mt19937_64 rng(7);
+  TimerWheel<> wheel(1000);
+  const size_t timers = 20000;
+  LinearList<uint64_t> expiry, fired_at;
+  LinearList<TimerWheel<>::Handle> handles;
+  size_t fired = 0, cancelled = 0;
+  uint64_t previous = wheel.now();
+  for (size_t i = 0; i < timers; ++i) {
+    // mostly short delays with a tail reaching the upper levels
+    const uint64_t delay = rng() % 4 ? rng() % 5000 : rng() % 50000000;
+    expiry.push_back(wheel.now() + std::max<uint64_t>(delay, 1));
+    fired_at.push_back(0);
+    handles.push_back(wheel.schedule_after(delay, [&, i]() {
+      // not already due when the advance that fired it began
+      EXPECT_GT(expiry[i], previous) << i;
+      fired_at[i] = wheel.now();
+      ++fired;
+    }));
+    if (rng() % 8 == 0 && i > 0) {
+      const size_t victim = rng() % i;
+      const bool live = wheel.active(handles[victim]);
+      EXPECT_EQ(wheel.cancel(handles[victim]), live);
+      EXPECT_FALSE(wheel.cancel(handles[victim]));
+      if (live) {
+        ++cancelled;
+        expiry[victim] = 0;
+      }
+    }
+    if (rng() % 4 == 0) {
+      previous = wheel.now();
+      wheel.advance(wheel.now() + rng() % 300);
+    }
+  }
+  while (!wheel.empty()) {
+    previous = wheel.now();
+    wheel.advance(wheel.now() + 1 + rng() % 1000000);
+  }
+  EXPECT_EQ(fired + cancelled, timers);
+  for (size_t i = 0; i < timers; ++i) {
+    if (expiry[i] == 0) {
+      EXPECT_EQ(fired_at[i], 0u);
+      continue;
+    }
+    // and due when it ended
+    EXPECT_GE(fired_at[i], expiry[i]) << i;
+  }
+}
+
+TEST(TimerWheelTest, BatchesInTickOrder) {
+  TimerWheel<std::function<int()>> wheel;
+  for (int i = 50; i > 0; --i)
+    wheel.schedule_after(i * 10, [i]() { return i; });
+  LinearList<std::function<int()>> due;
+  EXPECT_EQ(wheel.advance(250, due), 25u);
+  EXPECT_EQ(wheel.advance(1000, due), 25u);
+  ASSERT_EQ(due.size(), 50u);
+  for (int i = 0; i < 50; ++i) EXPECT_EQ(due[i](), i + 1);
+}
+
+TEST(TimerWheelTest, HandlesGoStale) {
+  TimerWheel<> wheel;
+  int runs = 0;
+  auto first = wheel.schedule_after(5, [&]() { ++runs; });
+  EXPECT_TRUE(wheel.active(first));
+  EXPECT_TRUE(wheel.cancel(first));
+  EXPECT_FALSE(wheel.active(first));
+  // the slot is reused, but the old handle does not reach the new timer
+  auto second = wheel.schedule_after(5, [&]() { ++runs; });
+  EXPECT_EQ(second.index_, first.index_);
+  EXPECT_FALSE(wheel.cancel(first));
+  EXPECT_TRUE(wheel.active(second));
+  wheel.advance(5);
+  EXPECT_EQ(runs, 1);
+  EXPECT_FALSE(wheel.active(second));
+  EXPECT_FALSE(wheel.cancel(second));
+  EXPECT_FALSE(wheel.active(TimerWheel<>::Handle()));
+}
+
+TEST(TimerWheelTest, CallbacksRescheduleThemselves) {
+  // a periodic timer: every callback schedules the next one
+  TimerWheel<> wheel;
+  LinearList<uint64_t> ticks;
+  std::function<void()> tick = [&]() {
+    ticks.push_back(wheel.now());
+    if (ticks.size() < 10) wheel.schedule_after(300, tick);
+  };
+  wheel.schedule_after(300, tick);
+  for (uint64_t t = 1; t <= 10000; ++t) wheel.advance(t);
+  ASSERT_EQ(ticks.size(), 10u);
+  EXPECT_EQ(ticks[0], 300u);
+  for (size_t i = 1; i < ticks.size(); ++i)
+    EXPECT_EQ(ticks[i] - ticks[i - 1], 300u);
+}
+
+TEST(TimerWheelDriverTest, RunsCallbacksOnThePool) {
+  ThreadPool pool(2);
+  TimerWheelDriver driver(pool, 1ms);
+  const int timers = 10000;
+  std::atomic<int> fired{0}, early{0}, off_pool{0};
+  const auto begin = TimerWheelDriver::Clock::now();
+  LinearList<TimerWheelDriver::Handle> handles;
+  for (int i = 0; i < timers; ++i) {
+    const auto deadline = begin + 1ms * (10 + i % 40);
+    handles.push_back(driver.schedule_at(deadline, [&, deadline]() {
+      if (TimerWheelDriver::Clock::now() < deadline) early++;
+      if (ThreadPool::current() != &pool) off_pool++;
+      fired++;
+    }));
+  }
+  int cancelled = 0;
+  for (int i = 0; i < timers; i += 10) cancelled += driver.cancel(handles[i]);
+  while (fired.load() + cancelled < timers) std::this_thread::yield();
+  EXPECT_LT(TimerWheelDriver::Clock::now() - begin, 5s);
+  EXPECT_EQ(early.load(), 0);
+  EXPECT_EQ(off_pool.load(), 0);
+  EXPECT_EQ(driver.pending(), 0u);
+
+  // a sleeping driver wakes up for a sooner deadline
+  std::atomic<bool> late{false}, soon{false};
+  driver.schedule_after(1h, [&]() { late = true; });
+  const auto again = TimerWheelDriver::Clock::now();
+  driver.schedule_after(5ms, [&]() { soon = true; });
+  while (!soon.load()) std::this_thread::yield();
+  EXPECT_LT(TimerWheelDriver::Clock::now() - again, 1s);
+  EXPECT_FALSE(late.load());
+  EXPECT_EQ(driver.pending(), 1u);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
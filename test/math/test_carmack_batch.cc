@@ -0,0 +1,132 @@
+/**
+ * @file test_carmack_batch.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file tests the batch reciprocal square root kernels.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "math/carmack_batch.hpp"
+#include "math/carmack_magic.hpp"
+
+using CarmackBatch::Kernel;
+using CarmackBatch::Seed;
+
+template <typename Fp>
+static std::vector<Fp> make_input(size_t n) {
+  std::vector<Fp> ret(n);
+  for (size_t i = 0; i < n; ++i) ret[i] = (Fp)(0.01 + 3.7 * i);
+  return ret;
+}
+
+template <typename Fp>
+static double max_rel_error(const std::vector<Fp>& in,
+                            const std::vector<Fp>& out) {
+  double ret = 0;
+  for (size_t i = 0; i < in.size(); ++i)
+    ret = std::max(ret, std::fabs(out[i] * std::sqrt((double)in[i]) - 1.0));
+  return ret;
+}
+
+TEST(CarmackBatchTest, MatchesScalarTest) {
+  /**
+   * @brief
+   *
+   * with the magic seed and one Newton step, every kernel shall agree with
+   * CarmackMagic::Q_rsqrt up to round-off, including the unaligned tail.
+   */
+  CarmackMagic magic;
+  auto in = make_input<float>(37);
+
+  for (Kernel k : {Kernel::Scalar, Kernel::SSE2, Kernel::AVX2,
+                   Kernel::AVX512}) {
+    if (!CarmackBatch::supported(k)) continue;
+    std::vector<float> out(in.size());
+    CarmackBatch::rsqrt(in, out, 1, Seed::Magic, k);
+    for (size_t i = 0; i < in.size(); ++i)
+      EXPECT_NEAR(out[i], magic.Q_rsqrt(in[i]), 1e-6F * out[i])
+          << "kernel " << (int)k << " index " << i;
+  }
+}
+
+TEST(CarmackBatchTest, AccuracyTest) {
+  /**
+   * @brief
+   *
+   * more Newton steps shall never make the result worse, and the hardware
+   * seed shall reach float precision after one step.
+   */
+  auto inf = make_input<float>(1000);
+  auto ind = make_input<double>(1000);
+
+  for (Kernel k : {Kernel::Scalar, Kernel::SSE2, Kernel::AVX2,
+                   Kernel::AVX512}) {
+    if (!CarmackBatch::supported(k)) continue;
+    std::vector<float> outf(inf.size());
+    std::vector<double> outd(ind.size());
+
+    CarmackBatch::rsqrt(inf, outf, 1, Seed::Magic, k);
+    EXPECT_LT(max_rel_error(inf, outf), 2e-3);
+    CarmackBatch::rsqrt(inf, outf, 2, Seed::Magic, k);
+    EXPECT_LT(max_rel_error(inf, outf), 5e-6);
+    CarmackBatch::rsqrt(ind, outd, 4, Seed::Magic, k);
+    EXPECT_LT(max_rel_error(ind, outd), 1e-14);
+
+    if (k == Kernel::Scalar) continue;
+    CarmackBatch::rsqrt(inf, outf, 1, Seed::Hardware, k);
+    EXPECT_LT(max_rel_error(inf, outf), 5e-7);
+    CarmackBatch::rsqrt(ind, outd, 2, Seed::Hardware, k);
+    EXPECT_LT(max_rel_error(ind, outd), 1e-13);
+  }
+}
+
+TEST(CarmackBatchTest, WideDoubleRangeTest) {
+  /**
+   * @brief
+   *
+   * doubles far outside the float range shall be as accurate as the rest
+   * with either seed; the hardware seed must not overflow or flush to zero.
+   */
+  std::vector<double> in;
+  for (double x : {1e-300, 1e-200, 1e-50, 3e-39, 1e-38, 2.0, 1e38, 5e38, 1e50,
+                   1e200, 1e300, 1.7e308})
+    in.push_back(x);
+
+  for (Kernel k : {Kernel::Scalar, Kernel::SSE2, Kernel::AVX2,
+                   Kernel::AVX512}) {
+    if (!CarmackBatch::supported(k)) continue;
+    std::vector<double> out(in.size());
+    for (Seed seed : {Seed::Magic, Seed::Hardware}) {
+      CarmackBatch::rsqrt(in, out, 4, seed, k);
+      EXPECT_LT(max_rel_error(in, out), 1e-13)
+          << "kernel " << (int)k << " seed " << (int)seed;
+    }
+  }
+}
+
+TEST(CarmackBatchTest, DispatchTest) {
+  std::cout << "Best kernel: " << (int)CarmackBatch::best_kernel()
+            << std::endl;
+  EXPECT_TRUE(CarmackBatch::supported(CarmackBatch::best_kernel()));
+
+  // the in-place variant shall give the same answer as the copying one
+  auto in = make_input<double>(19);
+  std::vector<double> out(in.size()), inplace = in;
+  CarmackBatch::rsqrt(in, out, 3);
+  CarmackBatch::rsqrt_inplace<double>(inplace, 3);
+  EXPECT_EQ(out, inplace);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,71 @@
+/**
+ * @file test_carmack_magic.cc
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1
+ * @date 2023-04-03
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * This file tests the compile-time reciprocal square root family.
+ */
+
+#include <array>
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "math/carmack_magic.hpp"
+
+// a lookup table folded entirely at compile time
+template <size_t N>
+constexpr std::array<float, N> make_table() {
+  std::array<float, N> ret{};
+  for (size_t i = 0; i < N; ++i)
+    ret[i] = CarmackMagic::rsqrt<float, 2>(float(i + 1));
+  return ret;
+}
+
+constexpr auto RSQRT_TABLE = make_table<64>();
+
+static_assert(CarmackMagic::Q_rsqrt(4.0F) > 0.49F &&
+              CarmackMagic::Q_rsqrt(4.0F) < 0.51F);
+static_assert(CarmackMagic::rsqrt<double, 4>(0.25) > 1.99999999 &&
+              CarmackMagic::rsqrt<double, 4>(0.25) < 2.00000001);
+
+TEST(CarmackMagicTest, IterationTest) {
+  /**
+   * @brief
+   *
+   * every Newton step shall shrink the error, for both float and double.
+   */
+  for (float x : {0.1F, 2.0F, 77.7F, 12345.0F}) {
+    const double exact = 1.0 / std::sqrt((double)x);
+    const double e0 = std::fabs(CarmackMagic::rsqrt<float, 0>(x) / exact - 1);
+    const double e1 = std::fabs(CarmackMagic::rsqrt<float, 1>(x) / exact - 1);
+    const double e2 = std::fabs(CarmackMagic::rsqrt<float, 2>(x) / exact - 1);
+    EXPECT_LT(e1, e0);
+    EXPECT_LT(e2, 5e-6);
+    EXPECT_EQ(CarmackMagic::Q_rsqrt(x), (CarmackMagic::rsqrt<float, 1>(x)));
+  }
+  for (double x : {0.1, 2.0, 77.7, 12345.0}) {
+    const double exact = 1.0 / std::sqrt(x);
+    EXPECT_NEAR((CarmackMagic::rsqrt<double, 4>(x)), exact, 1e-14 * exact);
+  }
+}
+
+TEST(CarmackMagicTest, MagicConstantTest) {
+  // a custom magic constant shall be honored: Lomont's refined constant
+  // gives a slightly different, but still valid, seed
+  const float x = 10.0F;
+  const float lomont = CarmackMagic::rsqrt<float, 1, 0x5f375a86u>(x);
+  EXPECT_NE(lomont, CarmackMagic::Q_rsqrt(x));
+  EXPECT_NEAR(lomont, 1.0F / std::sqrt(x), 2e-3F);
+
+  EXPECT_NEAR(RSQRT_TABLE[3], 0.5F, 1e-5F);
+  EXPECT_NEAR(RSQRT_TABLE[63], 0.125F, 1e-5F);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}